@@ -0,0 +1,501 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "utils.h"
+#include "sislin.h"
+#include "nucleos.h"
+#include "topologia.h"
+#include "reducao.h"
+#include "amg.h"
+
+#define ITER_POTENCIA 10    // iterações da potência para rho(D^-1 A)
+#define THETA_AMG     0.08  // limiar de conexão forte no nível 0, pela metade a cada nível (Vanek et al.)
+#define MAX_LARGURA_AMG 32  // meia banda máxima de um nível grosso
+
+//Bytes de n inteiros na arena (mesmo arredondamento dos vetores)
+static inline size_t tamanhoInteirosArena(size_t n)
+{
+    return (n * sizeof(int) + ARENA_ALINHAMENTO - 1) & ~(size_t) (ARENA_ALINHAMENTO - 1);
+}
+
+// ========== Produtos dos níveis ==========
+
+//y = A x (subtrai = 0) ou y = b - A x (subtrai = 1). Com k = N_DIAG são os núcleos do PCG;
+//nos demais níveis, o mesmo laço com k em tempo de execução (diagonais no laço externo)
+static void produtoNivel(const nivelAMG_t *L, const real_t *b, const real_t *x, real_t *y, int subtrai)
+{
+    const int n = L->n, k = L->k;
+    if (k == N_DIAG) {
+        if (subtrai) residuoDIA_d(L->A, b, x, y, n);
+        else spmvDIA_d(L->A, x, y, n);
+        return;
+    }
+
+    const real_t *A = L->A;
+    #pragma omp parallel if(n >= MIN_LINHAS_PARALELO)
+    {
+        int i0, i1;
+        faixaThread(n, &i0, &i1);
+        for (int i = i0; i < i1; i++) y[i] = subtrai ? b[i] : 0.0;
+        for (int diag_idx = 0; diag_idx < k; diag_idx++) {
+            const int offset = diag_idx - k / 2;
+            int inicio = (offset < 0) ? -offset : 0;
+            int fim = (offset > 0) ? n - offset : n;
+            if (inicio < i0) inicio = i0;
+            if (fim > i1) fim = i1;
+            const real_t *diagonal = &A[(size_t) diag_idx * n];
+            if (subtrai) {
+                for (int i = inicio; i < fim; i++) y[i] -= diagonal[i] * x[i + offset];
+            } else {
+                for (int i = inicio; i < fim; i++) y[i] += diagonal[i] * x[i + offset];
+            }
+        }
+    }
+}
+
+//y = M x (acumula = 0) ou y += M x; a linha inteira é lida, sem limites por linha
+static void multBandaLinhas(const bandaLinhas_t *M, const real_t *x, real_t *y, int acumula)
+{
+    const int w = M->largura;
+    #pragma omp parallel for schedule(static) if(M->linhas >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < M->linhas; i++) {
+        const real_t *vi = &M->v[(size_t) i * w];
+        const real_t *xi = &x[M->col0[i]];
+        real_t s = 0.0;
+        for (int t = 0; t < w; t++) s += vi[t] * xi[t];
+        y[i] = acumula ? y[i] + s : s;
+    }
+}
+
+// ========== Ciclo V ==========
+
+//'passos' varreduras de Jacobi ou grau 'passos' de Chebyshev (Saad, alg. 12.1, com D^-1
+//como pré-condicionador e o resíduo recalculado a cada grau). zero = 1: x parte de 0
+static void suaviza(const amg_t *H, nivelAMG_t *L, const real_t *b, real_t *x, int zero)
+{
+    const int n = L->n, paralelo = (n >= MIN_LINHAS_PARALELO);
+    const real_t *invD = L->invD;
+    real_t *r = L->r, *d = L->d;
+
+    if (H->suavizador == SUAVIZADOR_JACOBI) {
+        const real_t w = 4.0 / (3.0 * L->rho);
+        for (int s = 0; s < H->passos; s++) {
+            if (zero && s == 0) {
+                #pragma omp parallel for schedule(static) if(paralelo)
+                for (int i = 0; i < n; i++) x[i] = w * invD[i] * b[i];
+                continue;
+            }
+            produtoNivel(L, b, x, r, 1);
+            #pragma omp parallel for schedule(static) if(paralelo)
+            for (int i = 0; i < n; i++) x[i] += w * invD[i] * r[i];
+        }
+        return;
+    }
+
+    const real_t a = L->rho / 30.0, c = L->rho;
+    const real_t theta = 0.5 * (c + a), delta = 0.5 * (c - a), sigma = theta / delta;
+    real_t rhoK = 1.0 / sigma;
+
+    const real_t *res = b;
+    if (!zero) {
+        produtoNivel(L, b, x, r, 1);
+        res = r;
+    }
+    #pragma omp parallel for schedule(static) if(paralelo)
+    for (int i = 0; i < n; i++) {
+        d[i] = invD[i] * res[i] / theta;
+        x[i] = zero ? d[i] : x[i] + d[i];
+    }
+
+    for (int s = 1; s < H->passos; s++) {
+        produtoNivel(L, b, x, r, 1);
+        const real_t rhoN = 1.0 / (2.0 * sigma - rhoK);
+        const real_t c1 = rhoN * rhoK, c2 = 2.0 * rhoN / delta;
+        #pragma omp parallel for schedule(static) if(paralelo)
+        for (int i = 0; i < n; i++) {
+            d[i] = c1 * d[i] + c2 * invD[i] * r[i];
+            x[i] += d[i];
+        }
+        rhoK = rhoN;
+    }
+}
+
+//Pré-suavização, correção grossa (R r, ciclo no próximo nível, x += P e) e pós-suavização
+static void cicloV(amg_t *H, int l, const real_t *b, real_t *x)
+{
+    nivelAMG_t *L = &H->nivel[l];
+    if (l == H->nNiveis - 1) {
+        resolveBanda(H->grosso, b, x);
+        return;
+    }
+
+    nivelAMG_t *G = &H->nivel[l + 1];
+    suaviza(H, L, b, x, 1);
+    produtoNivel(L, b, x, L->r, 1);
+    multBandaLinhas(&L->R, L->r, G->b, 0);
+    cicloV(H, l + 1, G->b, G->x);
+    multBandaLinhas(&L->P, G->x, x, 1);
+    suaviza(H, L, b, x, 0);
+}
+
+void aplicaAMG(amg_t *H, const real_t *r, real_t *z)
+{
+    cicloV(H, 0, r, z);
+}
+
+// ========== Montagem da hierarquia ==========
+
+//rho(D^-1 A): potência a partir de um vetor pseudoaleatório (com componente em todos os
+//modos), com 10% de folga e limitada pelo círculo de Gershgorin, que é um limite superior.
+//v e w se alternam sem normalização (||D^-1 A|| <= k): rho = ||w|| / ||v||, uma passada por SpMV.
+//As normas são somas reprodutíveis: rho, e com ele os suavizadores, não muda com as threads
+static real_t raioEspectral(const nivelAMG_t *L, real_t *v, real_t *w)
+{
+    const int n = L->n, b = L->k / 2, paralelo = (n >= MIN_LINHAS_PARALELO);
+    const real_t *A = L->A, *invD = L->invD;
+
+    real_t gershgorin = 0.0;
+    #pragma omp parallel for schedule(static) reduction(max:gershgorin) if(paralelo)
+    for (int i = 0; i < n; i++) {
+        real_t s = 0.0;
+        for (int o = -b; o <= b; o++)
+            if (i + o >= 0 && i + o < n) s += fabs(A[(size_t) (o + b) * n + i]);
+        gershgorin = fmax(gershgorin, s * fabs(invD[i]));
+        v[i] = 0.5 + (real_t) (((unsigned) i * 2654435761u) >> 22) / 1024.0;
+    }
+
+    //sem memória para as parciais, o limite de Gershgorin
+    real_t *parciais = malloc(blocosReducao(n) * sizeof(real_t));
+    if (!parciais) return gershgorin;
+    real_t normaV = produtoReprodutivel(v, v, n, parciais);
+
+    real_t rho = 0.0;
+    for (int it = 0; it < ITER_POTENCIA; it++) {
+        produtoNivel(L, NULL, v, w, 0);
+        real_t normaW;
+        SOMA_REPRODUTIVEL(normaW, parciais, n, paralelo,
+                          w[i] *= invD[i];
+                          s += w[i] * w[i];);
+        if (!(normaW > 0.0)) break;
+        rho = sqrt(normaW / normaV);
+        normaV = normaW;
+        real_t *t = v;
+        v = w;
+        w = t;
+    }
+    free(parciais);
+    return fmin(1.1 * rho, gershgorin);
+}
+
+//Agregados contíguos: a partir da primeira linha livre, a faixa cresce enquanto a próxima
+//linha tiver conexão forte com alguma linha do agregado, até k linhas (o agregado de um nó
+//com todos os vizinhos da banda). agg[i]: agregado da linha i; inicio[J]: primeira linha de J
+static int agrega(const nivelAMG_t *L, real_t theta, int *agg, int *inicio)
+{
+    const int n = L->n, b = L->k / 2;
+    const real_t *A = L->A, *diag = &L->A[(size_t) b * n];
+    int nc = 0;
+
+    for (int s = 0; s < n; ) {
+        int fim = s;
+        while (fim + 1 < n && fim + 1 - s < L->k) {
+            const int j = fim + 1;
+            int forte = 0;
+            //A(j, j - o) está na diagonal b - o
+            for (int o = 1; o <= b && j - o >= s && !forte; o++)
+                forte = fabs(A[(size_t) (b - o) * n + j]) >= theta * sqrt(fabs(diag[j] * diag[j - o]));
+            if (!forte) break;
+            fim = j;
+        }
+        for (int i = s; i <= fim; i++) agg[i] = nc;
+        inicio[nc++] = s;
+        s = fim + 1;
+    }
+    inicio[nc] = n;
+    return nc;
+}
+
+//Agregado da linha i, com i limitado a [0, n)
+static inline int aggLinha(const int *agg, int n, int i)
+{
+    return agg[(i < 0) ? 0 : (i >= n) ? n - 1 : i];
+}
+
+//Valor de P(i, J) (0 fora da faixa da linha)
+static inline real_t elementoP(const bandaLinhas_t *P, int i, int J)
+{
+    const int c = J - P->col0[i];
+    return (c >= 0 && c < P->largura) ? P->v[(size_t) i * P->largura + c] : 0.0;
+}
+
+/**
+ * Nível l -> l + 1: P = (I - omega D^-1 A) P0 com P0 constante por agregado (normalizado),
+ * R = P^T e A_grosso = R (A P) no formato de diagonais, simetrizada. A P só existe durante
+ * a montagem. Retorna 0, 1 se a banda do nível grosso passar de MAX_LARGURA_AMG ou -1 em
+ * falta de memória.
+ */
+static int montaNivelGrosso(nivelAMG_t *L, nivelAMG_t *G, const int *agg, const int *inicio, int nc)
+{
+    const int n = L->n, b = L->k / 2;
+    const real_t *A = L->A, *invD = L->invD;
+    const real_t omega = 4.0 / (3.0 * L->rho);
+
+    //larguras: P(i, .) em agg(i - b)..agg(i + b), A P(i, .) em agg(i - 2b)..agg(i + 2b)
+    int wP = 1, wR = 1, wAP = 1, bc = 0;
+    for (int i = 0; i < n; i++) {
+        int largP = aggLinha(agg, n, i + b) - aggLinha(agg, n, i - b) + 1;
+        int largAP = aggLinha(agg, n, i + 2 * b) - aggLinha(agg, n, i - 2 * b) + 1;
+        if (largP > wP) wP = largP;
+        if (largAP > wAP) wAP = largAP;
+    }
+    for (int J = 0; J < nc; J++) {
+        int i0 = (inicio[J] - b < 0) ? 0 : inicio[J] - b;
+        int i1 = (inicio[J + 1] - 1 + b >= n) ? n - 1 : inicio[J + 1] - 1 + b;
+        if (i1 - i0 + 1 > wR) wR = i1 - i0 + 1;
+        //meia banda do nível grosso: colunas de A P alcançadas pelas linhas de R(J, .)
+        for (int i = i0; i <= i1; i++) {
+            int lo = J - aggLinha(agg, n, i - 2 * b), hi = aggLinha(agg, n, i + 2 * b) - J;
+            if (lo > bc) bc = lo;
+            if (hi > bc) bc = hi;
+        }
+    }
+    if (bc > MAX_LARGURA_AMG) return 1;
+    const int kc = 2 * bc + 1;
+
+    L->arenaTransf = criaArena(tamanhoVetorArena((size_t) n * wP) + tamanhoVetorArena((size_t) nc * wR) +
+                               tamanhoInteirosArena(n) + tamanhoInteirosArena(nc), ARENA_PAGINAS_ENORMES);
+    G->arena = criaArena(tamanhoVetorArena((size_t) nc * kc) + 5 * tamanhoVetorArena(nc),
+                         ARENA_PAGINAS_ENORMES | ARENA_PRIMEIRO_TOQUE);
+    arena_t *temp = criaArena(tamanhoVetorArena((size_t) n * wAP) + tamanhoInteirosArena(n) + tamanhoVetorArena(nc),
+                              ARENA_PAGINAS_ENORMES);
+    if (!L->arenaTransf || !G->arena || !temp) {
+        liberaArena(temp);
+        return -1;
+    }
+
+    bandaLinhas_t *P = &L->P, *R = &L->R;
+    P->linhas = n;  P->colunas = nc; P->largura = wP;
+    R->linhas = nc; R->colunas = n;  R->largura = wR;
+    P->v = arenaVetor(L->arenaTransf, (size_t) n * wP);
+    R->v = arenaVetor(L->arenaTransf, (size_t) nc * wR);
+    P->col0 = arenaAloca(L->arenaTransf, tamanhoInteirosArena(n));
+    R->col0 = arenaAloca(L->arenaTransf, tamanhoInteirosArena(nc));
+
+    bandaLinhas_t AP = { n, nc, wAP, arenaAloca(temp, tamanhoInteirosArena(n)),
+                         arenaVetor(temp, (size_t) n * wAP) };
+
+    //P0(i, J) = 1 / sqrt(linhas de J)
+    real_t *p0 = arenaVetor(temp, nc);
+    for (int J = 0; J < nc; J++) p0[J] = 1.0 / sqrt((real_t) (inicio[J + 1] - inicio[J]));
+
+    //P: col0 deslocado para a linha não passar da última coluna (as posições a mais são zeros)
+    #pragma omp parallel for schedule(static) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) {
+        const int c0 = aggLinha(agg, n, i - b);
+        P->col0[i] = (c0 > nc - wP) ? nc - wP : c0;
+        real_t *vi = &P->v[(size_t) i * wP];
+        for (int o = -b; o <= b; o++) {
+            const int j = i + o;
+            if (j < 0 || j >= n) continue;
+            real_t termo = -omega * invD[i] * A[(size_t) (o + b) * n + i];
+            if (o == 0) termo += 1.0;
+            vi[agg[j] - P->col0[i]] += termo * p0[agg[j]];
+        }
+    }
+
+    #pragma omp parallel for schedule(static) if(nc >= MIN_LINHAS_PARALELO)
+    for (int J = 0; J < nc; J++) {
+        const int i0 = (inicio[J] - b < 0) ? 0 : inicio[J] - b;
+        R->col0[J] = (i0 > n - wR) ? n - wR : i0;
+        for (int t = 0; t < wR; t++) R->v[(size_t) J * wR + t] = elementoP(P, R->col0[J] + t, J);
+    }
+
+    //A P por linha: A(i, i + o) P(i + o, .); as colunas de P fora da janela de A P são zeros
+    #pragma omp parallel for schedule(static) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) {
+        const int c0 = aggLinha(agg, n, i - 2 * b);
+        AP.col0[i] = (c0 > nc - wAP) ? nc - wAP : c0;
+        real_t *vi = &AP.v[(size_t) i * wAP];
+        for (int o = -b; o <= b; o++) {
+            const int j = i + o;
+            if (j < 0 || j >= n) continue;
+            const real_t a = A[(size_t) (o + b) * n + i];
+            const int desloc = P->col0[j] - AP.col0[i];
+            const int cIni = (desloc < 0) ? -desloc : 0;
+            const int cFim = (wAP - desloc < wP) ? wAP - desloc : wP;
+            const real_t *pj = &P->v[(size_t) j * wP];
+            for (int c = cIni; c < cFim; c++) vi[desloc + c] += a * pj[c];
+        }
+    }
+
+    //A_grosso(I, J) = sum_i R(I, i) (A P)(i, J): cada thread monta as suas linhas grossas
+    G->n = nc;
+    G->k = kc;
+    real_t *Ac = arenaDiagonais(G->arena, nc, kc);
+    #pragma omp parallel if(nc >= MIN_LINHAS_PARALELO)
+    {
+        real_t linha[2 * MAX_LARGURA_AMG + 1];
+        #pragma omp for schedule(static)
+        for (int I = 0; I < nc; I++) {
+            for (int d = 0; d < kc; d++) linha[d] = 0.0;
+            for (int t = 0; t < wR; t++) {
+                const int i = R->col0[I] + t;
+                const real_t rIi = R->v[(size_t) I * wR + t];
+                const int desloc = AP.col0[i] - I + bc;
+                const int cIni = (desloc < 0) ? -desloc : 0;
+                const int cFim = (kc - desloc < wAP) ? kc - desloc : wAP;
+                const real_t *api = &AP.v[(size_t) i * wAP];
+                for (int c = cIni; c < cFim; c++) linha[desloc + c] += rIi * api[c];
+            }
+            for (int d = 0; d < kc; d++) Ac[(size_t) d * nc + I] = linha[d];
+        }
+    }
+
+    //simetria exata (as duas metades diferem só por arredondamento): o Cholesky do último
+    //nível lê só a metade inferior e o ciclo V continua simétrico
+    #pragma omp parallel for schedule(static) if(nc >= MIN_LINHAS_PARALELO)
+    for (int I = 0; I < nc; I++) {
+        for (int o = 1; o <= bc && I + o < nc; o++) {
+            real_t *sup = &Ac[(size_t) (bc + o) * nc + I], *inf = &Ac[(size_t) (bc - o) * nc + I + o];
+            const real_t m = 0.5 * (*sup + *inf);
+            *sup = *inf = m;
+        }
+    }
+    G->A = Ac;
+
+    liberaArena(temp);
+    return 0;
+}
+
+//Ciclos estimados de um ciclo V no nível (sem a correção grossa): os produtos do suavizador
+//e o do resíduo (2 passos no total, 2k flops por linha cada) e as atualizações de x
+static double custoCicloNivel(const amg_t *H, const nivelAMG_t *L)
+{
+    return (double) L->n * (2.0 * H->passos * (2.0 * L->k + 3.0));
+}
+
+//1 / diagonal; retorna a primeira linha com diagonal não positiva (ou -1)
+static int inverteDiagonal(nivelAMG_t *L)
+{
+    const real_t *diag = &L->A[(size_t) (L->k / 2) * L->n];
+    int falha = L->n;
+    #pragma omp parallel for schedule(static) reduction(min:falha) if(L->n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < L->n; i++) {
+        if (!(diag[i] > 0.0) && i < falha) falha = i;
+        L->invD[i] = 1.0 / diag[i];
+    }
+    return (falha < L->n) ? falha : -1;
+}
+
+amg_t *criaAMG(const real_t *A, int n, int k, suavizador_t suavizador, int passos, int *linhaFalha)
+{
+    *linhaFalha = -1;
+    amg_t *H = calloc(1, sizeof(amg_t));
+    if (!H) return NULL;
+    H->suavizador = suavizador;
+    H->passos = passos;
+
+    //nível 0: só os vetores (A é a do PCG; x e b são os do ciclo)
+    nivelAMG_t *L = &H->nivel[0];
+    L->n = n;
+    L->k = k;
+    L->A = A;
+    L->arena = criaArena(3 * tamanhoVetorArena(n), ARENA_PAGINAS_ENORMES | ARENA_PRIMEIRO_TOQUE);
+    if (!L->arena) {
+        free(H);
+        return NULL;
+    }
+    L->invD = arenaVetor(L->arena, n);
+    L->r = arenaVetor(L->arena, n);
+    L->d = arenaVetor(L->arena, n);
+
+    int *agg = malloc((size_t) n * sizeof(int));
+    int *inicio = malloc(((size_t) n + 1) * sizeof(int));
+    int erro = (!agg || !inicio);
+    real_t theta = THETA_AMG;
+
+    int l = 0;
+    for (; !erro; l++) {
+        L = &H->nivel[l];
+        if ((*linhaFalha = inverteDiagonal(L)) >= 0) {
+            erro = 1;
+            break;
+        }
+        //o Cholesky em banda não tem preenchimento: a partir do nível 1, se as substituições
+        //custarem menos que o ciclo, o nível é resolvido direto (e exatamente)
+        if (L->n <= TAM_GROSSO_AMG || l == MAX_NIVEIS_AMG - 1) break;
+        if (l > 0 && custoSubstituicaoBanda(L->n, L->k) <= custoCicloNivel(H, L)) break;
+
+        L->rho = raioEspectral(L, L->r, L->d);
+        int nc = agrega(L, theta, agg, inicio);
+        if (nc > RAZAO_MAX_AMG * L->n) break;
+
+        nivelAMG_t *G = &H->nivel[l + 1];
+        int situacao = montaNivelGrosso(L, G, agg, inicio, nc);
+        if (situacao) {
+            erro = (situacao < 0);
+            break;
+        }
+        G->invD = arenaVetor(G->arena, nc);
+        G->x = arenaVetor(G->arena, nc);
+        G->b = arenaVetor(G->arena, nc);
+        G->r = arenaVetor(G->arena, nc);
+        G->d = arenaVetor(G->arena, nc);
+        theta *= 0.5;
+    }
+    free(agg);
+    free(inicio);
+    H->nNiveis = l + 1;
+
+    if (!erro) {
+        L = &H->nivel[l];
+        H->grosso = fatoraBanda(L->A, L->n, L->k, linhaFalha);
+        erro = !H->grosso;
+    }
+    if (erro) {
+        liberaAMG(H);
+        return NULL;
+    }
+    return H;
+}
+
+void liberaAMG(amg_t *H)
+{
+    if (!H) return;
+    for (int l = 0; l < MAX_NIVEIS_AMG; l++) {
+        liberaArena(H->nivel[l].arena);
+        liberaArena(H->nivel[l].arenaTransf);
+    }
+    liberaFatorBanda(H->grosso);
+    free(H);
+}
+
+int leSuavizador(const char *texto, suavizador_t *suavizador, int *passos)
+{
+    const char *virgula = strchr(texto, ',');
+    size_t tam = virgula ? (size_t) (virgula - texto) : strlen(texto);
+    if (tam == 6 && !strncmp(texto, "jacobi", 6)) {
+        *suavizador = SUAVIZADOR_JACOBI;
+        *passos = 1;
+    } else if (tam == 4 && !strncmp(texto, "cheb", 4)) {
+        *suavizador = SUAVIZADOR_CHEBYSHEV;
+        *passos = 2;
+    } else {
+        return -1;
+    }
+    if (virgula) *passos = atoi(virgula + 1);
+    return (*passos >= 1) ? 0 : -1;
+}
+
+void descreveAMG(const amg_t *H, FILE *saida)
+{
+    double nnz0 = (double) H->nivel[0].n * H->nivel[0].k, nnz = 0.0;
+    fprintf(saida, "# amg: %d níveis, n (k):", H->nNiveis);
+    for (int l = 0; l < H->nNiveis; l++) {
+        fprintf(saida, " %d (%d)", H->nivel[l].n, H->nivel[l].k);
+        nnz += (double) H->nivel[l].n * H->nivel[l].k;
+    }
+    fprintf(saida, "; complexidade de operador %.2f; %s %d\n", nnz / nnz0,
+            H->suavizador == SUAVIZADOR_JACOBI ? "jacobi" : "chebyshev grau", H->passos);
+}
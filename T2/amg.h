@@ -0,0 +1,75 @@
+#ifndef __AMG_H__
+#define __AMG_H__
+
+#include <stdio.h>
+#include "utils.h"
+#include "arena.h"
+#include "banda.h"
+
+#define MAX_NIVEIS_AMG 12
+#define TAM_GROSSO_AMG 2048 // níveis com até tantas linhas são resolvidos pelo Cholesky em banda
+#define RAZAO_MAX_AMG  0.8  // agregação que não reduz n a essa fração encerra a hierarquia
+
+typedef enum {
+    SUAVIZADOR_JACOBI,      // Jacobi amortecido, omega = 4 / (3 rho(D^-1 A))
+    SUAVIZADOR_CHEBYSHEV    // polinômio de Chebyshev em D^-1 A no intervalo [rho/30, rho]
+} suavizador_t;
+
+// Matriz retangular em banda guardada por linhas: linha i com 'largura' colunas a
+// partir de col0[i] (v[i * largura + t] = M(i, col0[i] + t), zeros completam a linha)
+typedef struct {
+    int linhas, colunas, largura;
+    int *col0;
+    real_t *v;
+} bandaLinhas_t;
+
+typedef struct {
+    int n, k;               // linhas e diagonais de A (k ímpar, A[diag_idx * n + i])
+    const real_t *A;        // nível 0: a ASP do PCG (sem cópia); demais: P^T A P na arena
+    real_t *invD;           // 1 / diagonal de A
+    real_t rho;             // rho(D^-1 A): potência com 10% de folga, no máximo o de Gershgorin
+    bandaLinhas_t P, R;     // prolongamento (n x n do próximo nível) e restrição R = P^T
+    real_t *x, *b, *r, *d;  // vetores do ciclo (x e b só nos níveis > 0)
+    arena_t *arena, *arenaTransf;
+} nivelAMG_t;
+
+/**
+ * Pré-condicionador multigrid algébrico por agregação suavizada (ciclo V).
+ *
+ * Os agregados são faixas contíguas de linhas fortemente conectadas
+ * (|a_ij| >= theta sqrt(a_ii a_jj), no máximo k linhas cada), com o vetor
+ * constante como quase-núcleo. P = (I - omega D^-1 A) P0 e o nível seguinte é
+ * P^T A P: com agregados contíguos toda matriz da hierarquia continua em banda
+ * e fica no formato de diagonais, com o mesmo laço do SpMV do PCG. O último
+ * nível é resolvido pelo Cholesky em banda (banda.h).
+ *
+ * Cada aplicação é um ciclo V com 'passos' varreduras de Jacobi (ou grau
+ * 'passos' de Chebyshev) antes e depois da correção grossa, a partir de z = 0:
+ * o pré-condicionador é simétrico e serve ao PCG.
+ */
+typedef struct {
+    int nNiveis;
+    nivelAMG_t nivel[MAX_NIVEIS_AMG];
+    fatorBanda_t *grosso;
+    suavizador_t suavizador;
+    int passos;
+} amg_t;
+
+/**
+ * Monta a hierarquia sobre A (n x n, k diagonais). Retorna NULL se a diagonal
+ * ou o nível grosso não forem positivos definidos (*linhaFalha = linha do nível
+ * em que falhou) ou em falta de memória (*linhaFalha = -1).
+ */
+amg_t *criaAMG(const real_t *A, int n, int k, suavizador_t suavizador, int passos, int *linhaFalha);
+void liberaAMG(amg_t *H);
+
+// z = M^-1 r por um ciclo V (usa os vetores da hierarquia: uma aplicação por vez)
+void aplicaAMG(amg_t *H, const real_t *r, real_t *z);
+
+// Lê "jacobi|cheb[,passos]" (padrão 1 varredura de Jacobi, grau 2 de Chebyshev). Retorna 0 ou -1.
+int leSuavizador(const char *texto, suavizador_t *suavizador, int *passos);
+
+// Níveis (n, k), complexidade de operador (soma de n k sobre a do nível 0) e suavizador
+void descreveAMG(const amg_t *H, FILE *saida);
+
+#endif // __AMG_H__
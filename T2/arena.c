@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include "utils.h"
+#include "arena.h"
+#include "topologia.h"
+
+#define PAGINA_ENORME (2UL << 20) // 2 MiB
+
+static inline size_t arredonda(size_t x, size_t mult)
+{
+    return (x + mult - 1) / mult * mult;
+}
+
+size_t tamanhoVetorArena(size_t n)
+{
+    return arredonda(n * sizeof(real_t), ARENA_ALINHAMENTO);
+}
+
+//Região alinhada em 2 MiB com MADV_HUGEPAGE: mapeia 2 MiB a mais e recorta
+static char *mapeiaTHP(size_t tamanho, int *origem)
+{
+    size_t total = tamanho + PAGINA_ENORME;
+    char *bruto = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (bruto == MAP_FAILED) return NULL;
+
+    char *base = (char *) arredonda((uintptr_t) bruto, PAGINA_ENORME);
+    if (base > bruto) munmap(bruto, base - bruto);
+    char *fim = bruto + total;
+    if (fim > base + tamanho) munmap(base + tamanho, fim - (base + tamanho));
+
+#ifdef MADV_HUGEPAGE
+    *origem = (madvise(base, tamanho, MADV_HUGEPAGE) == 0) ? ARENA_THP : ARENA_NORMAL;
+#else
+    *origem = ARENA_NORMAL;
+#endif
+    return base;
+}
+
+arena_t *criaArena(size_t bytes, int flags)
+{
+    arena_t *arena = calloc(1, sizeof(arena_t));
+    if (!arena) return NULL;
+
+    arena->flags = flags;
+    arena->base = NULL;
+
+    if ((flags & ARENA_PAGINAS_ENORMES) && bytes >= PAGINA_ENORME / 2) {
+        //1) páginas enormes explícitas: falha se não houver páginas reservadas
+        arena->tamanho = arredonda(bytes, PAGINA_ENORME);
+#ifdef MAP_HUGETLB
+        char *base = mmap(NULL, arena->tamanho, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) {
+            arena->base = base;
+            arena->origem = ARENA_HUGETLB;
+        }
+#endif
+        //2) transparent huge pages
+        if (!arena->base) arena->base = mapeiaTHP(arena->tamanho, &arena->origem);
+    }
+
+    //3) páginas normais (vetores pequenos não compensam uma página de 2 MiB)
+    if (!arena->base) {
+        arena->tamanho = arredonda(bytes > 0 ? bytes : 1, 4096);
+        char *base = mmap(NULL, arena->tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            free(arena);
+            return NULL;
+        }
+        arena->base = base;
+        arena->origem = ARENA_NORMAL;
+    }
+
+    return arena;
+}
+
+void liberaArena(arena_t *arena)
+{
+    if (!arena) return;
+    munmap(arena->base, arena->tamanho);
+    free(arena);
+}
+
+void *arenaAloca(arena_t *arena, size_t bytes)
+{
+    size_t tam = arredonda(bytes, ARENA_ALINHAMENTO);
+    if (arena->usado + tam > arena->tamanho) {
+        printf("Erro: arena esgotada (%zu de %zu bytes usados, pedido de %zu)\n", arena->usado, arena->tamanho, tam);
+        return NULL;
+    }
+
+    void *fatia = arena->base + arena->usado;
+    arena->usado += tam;
+    return fatia;
+}
+
+void arenaReinicia(arena_t *arena)
+{
+    if (arena->usado > arena->tocado) arena->tocado = arena->usado;
+    arena->usado = 0;
+}
+
+real_t *arenaVetor(arena_t *arena, size_t n)
+{
+    real_t *v = arenaAloca(arena, n * sizeof(real_t));
+    if (!v) return NULL;
+
+    //fatia já tocada numa rodada anterior: as páginas estão no lugar
+    if ((size_t) ((char *) v - arena->base) + n * sizeof(real_t) <= arena->tocado) return v;
+
+    //a página vai para o nó NUMA da thread que a tocar primeiro; a mesma
+    //divisão estática dos loops do solver garante que cada thread toque as suas linhas
+    if (arena->flags & ARENA_PRIMEIRO_TOQUE) {
+        //(schedule(static) sem chunk do libgomp: a mesma divisão de faixaThread)
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; ++i) v[i] = 0.0;
+    }
+    return v;
+}
+
+real_t *arenaDiagonais(arena_t *arena, int n, int k)
+{
+    real_t *A = arenaAloca(arena, tamanhoVetorArena((size_t) n * k));
+    if (!A) return NULL;
+
+    //linhas [i0, i1) de todas as k diagonais no nó da thread que as processa
+    if (arena->flags & ARENA_PRIMEIRO_TOQUE) {
+        #pragma omp parallel
+        {
+            int i0, i1;
+            faixaThread(n, &i0, &i1);
+            for (int d = 0; d < k; ++d)
+                for (int i = i0; i < i1; ++i) A[(size_t) d * n + i] = 0.0;
+        }
+    }
+    return A;
+}
+
+const char *descreveArena(const arena_t *arena)
+{
+    switch (arena->origem) {
+        case ARENA_HUGETLB: return "páginas enormes (hugetlbfs)";
+        case ARENA_THP:     return "transparent huge pages (madvise)";
+        default:            return "páginas normais";
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+#include "utils.h"
+
+// Alinhamento de cada fatia (linha de cache / AVX-512)
+#define ARENA_ALINHAMENTO 64
+
+// Flags de criaArena
+#define ARENA_PAGINAS_ENORMES 1 // MAP_HUGETLB; sem páginas reservadas, THP via madvise
+#define ARENA_PRIMEIRO_TOQUE  2 // arenaVetor toca a fatia com a divisão estática de linhas das threads
+
+// Origem da memória da arena
+#define ARENA_HUGETLB 0 // páginas enormes explícitas (hugetlbfs)
+#define ARENA_THP     1 // páginas normais com MADV_HUGEPAGE (transparent huge pages)
+#define ARENA_NORMAL  2 // páginas normais
+
+/**
+ * Arena de memória para os buffers do solver.
+ *
+ * Um único mmap fornece todas as fatias, alinhadas em 64 bytes e com tamanho
+ * arredondado para múltiplos de 64 bytes (8 doubles), então loops vetorizados
+ * não precisam de tratamento de resto por alinhamento. A memória vem zerada
+ * do kernel: não há calloc nem passadas de zeragem. Tudo é liberado de uma vez.
+ */
+typedef struct {
+    char *base;       // início da região mapeada
+    size_t tamanho;   // bytes mapeados
+    size_t usado;     // bytes já entregues
+    size_t tocado;    // bytes que já passaram pelo primeiro toque (não se repete após arenaReinicia)
+    int origem;       // ARENA_HUGETLB, ARENA_THP ou ARENA_NORMAL
+    int flags;
+} arena_t;
+
+// Bytes que um vetor de n reais ocupa na arena (com alinhamento e preenchimento)
+size_t tamanhoVetorArena(size_t n);
+
+arena_t *criaArena(size_t bytes, int flags);
+void liberaArena(arena_t *arena);
+
+// Fatia de 'bytes' bytes, alinhada em ARENA_ALINHAMENTO; NULL se a arena acabou
+void *arenaAloca(arena_t *arena, size_t bytes);
+
+// Devolve todas as fatias sem desmapear: a próxima rodada de arenaAloca/arenaVetor
+// reaproveita as mesmas páginas (e a sua colocação NUMA), sem primeiro toque nem
+// zeragem. O conteúdo é o da rodada anterior.
+void arenaReinicia(arena_t *arena);
+
+// Vetor de n reais zerado; com ARENA_PRIMEIRO_TOQUE, cada página é tocada pela
+// thread que processa aquelas linhas nos loops 'schedule(static)'. Depois de
+// arenaReinicia, só a parte ainda não tocada é zerada
+real_t *arenaVetor(arena_t *arena, size_t n);
+
+// Matriz de k diagonais de tamanho n (A[d * n + i]); o primeiro toque divide
+// as linhas, não o bloco n*k, então cada thread fica com as suas linhas em todas as diagonais
+real_t *arenaDiagonais(arena_t *arena, int n, int k);
+
+const char *descreveArena(const arena_t *arena);
+
+#endif // __ARENA_H__
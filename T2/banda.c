@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "utils.h"
+#include "sislin.h"
+#include "topologia.h"
+#include "banda.h"
+
+//Linhas [i0, i1) do fator: L(i, m) para m em [i - b, i); as posições com m < i0 ficam em zero.
+//D (ou a diagonal de A) dá os pivôs. Com b constante (a chamada com OFFSET_CENTER) o
+//compilador desenrola os dois laços.
+static inline int fatoraLinhas(const real_t *A, const real_t *D, real_t *L, int n, int i0, int i1, const int b)
+{
+    const int w = b + 1;
+    for (int i = i0; i < i1; i++) {
+        real_t *Li = &L[(size_t) i * w];
+        for (int t = 0; t < b; t++) {
+            int j = i - b + t;
+            if (j < i0) {
+                Li[t] = 0.0;
+                continue;
+            }
+            //L(i, j) = (A(i, j) - sum_m L(i, m) L(j, m)) / L(j, j), m < j
+            const real_t *Lj = &L[(size_t) j * w];
+            real_t s = A[(size_t) t * n + i];
+            for (int u = 0; u < t; u++) s -= Li[u] * Lj[u + b - t];
+            Li[t] = s * Lj[b];
+        }
+
+        real_t s = D ? D[i] : A[(size_t) b * n + i];
+        for (int u = 0; u < b; u++) s -= Li[u] * Li[u];
+        if (!(s > 0.0) || !isfinite(s)) return i;
+        Li[b] = 1.0 / sqrt(s);
+    }
+    return -1;
+}
+
+static inline int fatoraBloco(const fatorBanda_t *F, const real_t *A, const real_t *D, int m)
+{
+    const int i0 = F->inicioBloco[m], i1 = F->inicioBloco[m + 1];
+    if (F->b == OFFSET_CENTER) return fatoraLinhas(A, D, F->L, F->n, i0, i1, OFFSET_CENTER);
+    return fatoraLinhas(A, D, F->L, F->n, i0, i1, F->b);
+}
+
+fatorBanda_t *fatoraBandaBlocos(const real_t *A, const real_t *D, int n, int k, int tamBloco, int *linhaFalha)
+{
+    if (linhaFalha) *linhaFalha = -1;
+    fatorBanda_t *F = malloc(sizeof(fatorBanda_t));
+    if (!F) return NULL;
+    F->n = n;
+    F->b = (k - 1) / 2;
+
+    //um bloco por thread: as faixas de faixaThread
+    F->nBlocos = (tamBloco > 0) ? (n + tamBloco - 1) / tamBloco : omp_get_max_threads();
+    if (F->nBlocos > n) F->nBlocos = n;
+
+    //o fator com primeiro toque: cada thread fica com as linhas dos blocos que fatora
+    F->arena = criaArena(tamanhoVetorArena((size_t) n * (F->b + 1)) + tamanhoVetorArena(F->nBlocos + 1),
+                         ARENA_PAGINAS_ENORMES | (F->nBlocos > 1 ? ARENA_PRIMEIRO_TOQUE : 0));
+    if (!F->arena) {
+        free(F);
+        return NULL;
+    }
+    F->L = arenaVetor(F->arena, (size_t) n * (F->b + 1));
+    F->inicioBloco = arenaAloca(F->arena, (F->nBlocos + 1) * sizeof(int));
+    for (int m = 0; m <= F->nBlocos; m++) {
+        if (tamBloco > 0) {
+            F->inicioBloco[m] = (m * (size_t) tamBloco < (size_t) n) ? m * tamBloco : n;
+        } else {
+            //início da faixa da thread m (a divisão de faixaThread)
+            int q = n / F->nBlocos, resto = n % F->nBlocos;
+            F->inicioBloco[m] = m * q + (m < resto ? m : resto);
+        }
+    }
+
+    int falha = n;
+    #pragma omp parallel for schedule(static) reduction(min:falha) if(F->nBlocos > 1)
+    for (int m = 0; m < F->nBlocos; m++) {
+        int linha = fatoraBloco(F, A, D, m);
+        if (linha >= 0 && linha < falha) falha = linha;
+    }
+    if (falha < n) {
+        if (linhaFalha) *linhaFalha = falha;
+        liberaFatorBanda(F);
+        return NULL;
+    }
+    return F;
+}
+
+fatorBanda_t *fatoraBanda(const real_t *A, int n, int k, int *linhaFalha)
+{
+    return fatoraBandaBlocos(A, NULL, n, k, n, linhaFalha);
+}
+
+void liberaFatorBanda(fatorBanda_t *F)
+{
+    if (!F) return;
+    liberaArena(F->arena);
+    free(F);
+}
+
+//L y = b e L^T x = y nas linhas [i0, i1); nas b primeiras/últimas os termos fora do bloco são pulados
+static inline void substituiLinhas(const real_t *L, const real_t *bv, real_t *x, int i0, int i1, const int b)
+{
+    const int w = b + 1;
+    for (int i = i0; i < i1; i++) {
+        const real_t *Li = &L[(size_t) i * w];
+        real_t s = bv[i];
+        if (i - i0 >= b) {
+            for (int t = 0; t < b; t++) s -= Li[t] * x[i - b + t];
+        } else {
+            for (int t = b - (i - i0); t < b; t++) s -= Li[t] * x[i - b + t];
+        }
+        x[i] = s * Li[b];
+    }
+
+    //L^T: x_i = (y_i - sum_t L(i + t, i) x_{i + t}) / L(i, i)
+    for (int i = i1 - 1; i >= i0; i--) {
+        real_t s = x[i];
+        const int tMax = (i + b < i1) ? b : i1 - 1 - i;
+        for (int t = 1; t <= tMax; t++) s -= L[(size_t) (i + t) * w + b - t] * x[i + t];
+        x[i] = s * L[(size_t) i * w + b];
+    }
+}
+
+void resolveBanda(const fatorBanda_t *F, const real_t *b, real_t *x)
+{
+    #pragma omp parallel for schedule(static) if(F->nBlocos > 1)
+    for (int m = 0; m < F->nBlocos; m++) {
+        const int i0 = F->inicioBloco[m], i1 = F->inicioBloco[m + 1];
+        if (F->b == OFFSET_CENTER) substituiLinhas(F->L, b, x, i0, i1, OFFSET_CENTER);
+        else substituiLinhas(F->L, b, x, i0, i1, F->b);
+    }
+}
+
+//Um bloco de BLOCO_RHS colunas intercaladas (Y[i * BLOCO_RHS + c]), no lugar, nas linhas [i0, i1)
+static void substituiBloco(const real_t *L, real_t *Y, int i0, int i1, int b)
+{
+    const int w = b + 1;
+    for (int i = i0; i < i1; i++) {
+        const real_t *Li = &L[(size_t) i * w];
+        real_t *yi = &Y[(size_t) i * BLOCO_RHS];
+        for (int t = (i - i0 >= b) ? 0 : b - (i - i0); t < b; t++) {
+            const real_t l = Li[t];
+            const real_t *yj = &Y[(size_t) (i - b + t) * BLOCO_RHS];
+            #pragma omp simd
+            for (int c = 0; c < BLOCO_RHS; c++) yi[c] -= l * yj[c];
+        }
+        #pragma omp simd
+        for (int c = 0; c < BLOCO_RHS; c++) yi[c] *= Li[b];
+    }
+
+    for (int i = i1 - 1; i >= i0; i--) {
+        real_t *yi = &Y[(size_t) i * BLOCO_RHS];
+        const int tMax = (i + b < i1) ? b : i1 - 1 - i;
+        for (int t = 1; t <= tMax; t++) {
+            const real_t l = L[(size_t) (i + t) * w + b - t];
+            const real_t *yj = &Y[(size_t) (i + t) * BLOCO_RHS];
+            #pragma omp simd
+            for (int c = 0; c < BLOCO_RHS; c++) yi[c] -= l * yj[c];
+        }
+        const real_t d = L[(size_t) i * w + b];
+        #pragma omp simd
+        for (int c = 0; c < BLOCO_RHS; c++) yi[c] *= d;
+    }
+}
+
+int resolveBandaVarios(const fatorBanda_t *F, const real_t *B, real_t *X, int nrhs)
+{
+    const int n = F->n;
+    const int nBlocos = (nrhs + BLOCO_RHS - 1) / BLOCO_RHS;
+    int erro = 0;
+
+    #pragma omp parallel reduction(+:erro) if(nBlocos > 1)
+    {
+        real_t *Y = aligned_alloc(64, tamanhoVetorArena((size_t) n * BLOCO_RHS));
+        if (!Y) erro = 1;
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int blk = 0; blk < nBlocos; blk++) {
+            if (!Y) continue;
+            const int c0 = blk * BLOCO_RHS;
+            const int nc = (nrhs - c0 < BLOCO_RHS) ? nrhs - c0 : BLOCO_RHS;
+
+            //intercala o bloco (colunas que faltam no último bloco ficam em zero)
+            for (int i = 0; i < n; i++)
+                for (int c = 0; c < BLOCO_RHS; c++)
+                    Y[(size_t) i * BLOCO_RHS + c] = (c < nc) ? B[(size_t) (c0 + c) * n + i] : 0.0;
+
+            for (int m = 0; m < F->nBlocos; m++)
+                substituiBloco(F->L, Y, F->inicioBloco[m], F->inicioBloco[m + 1], F->b);
+
+            for (int i = 0; i < n; i++)
+                for (int c = 0; c < nc; c++)
+                    X[(size_t) (c0 + c) * n + i] = Y[(size_t) i * BLOCO_RHS + c];
+        }
+        free(Y);
+    }
+    return erro ? -1 : 0;
+}
+
+//Ciclos por linha: as contas (cerca de 1 flop/ciclo, como o PCG) mais a latência da
+//cadeia de dependência entre linhas, que domina com b pequeno
+#define LATENCIA_PIVO  30.0 // sqrt + inversão do pivô, no caminho crítico da fatoração
+#define LATENCIA_LINHA 6.0  // x[i] depende de x[i - 1] em cada substituição
+
+//linha i: sum_t (2t + 1) para L(i, j) e 2b + 2 para o pivô
+double custoFatoracaoBanda(int n, int k)
+{
+    double b = (k - 1) / 2;
+    return (double) n * (b * b + 2.0 * b + 2.0 + LATENCIA_PIVO);
+}
+
+//ida e volta: 2b + 1 flops por linha em cada
+double custoSubstituicaoBanda(int n, int k)
+{
+    double b = (k - 1) / 2;
+    return (double) n * 2.0 * (2.0 * b + 1.0 + LATENCIA_LINHA);
+}
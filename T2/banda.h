@@ -0,0 +1,69 @@
+#ifndef __BANDA_H__
+#define __BANDA_H__
+
+#include "utils.h"
+#include "arena.h"
+
+// Colunas do bloco de lados direitos na substituição com vários b (uma linha do bloco = 8 doubles)
+#define BLOCO_RHS 8
+
+/**
+ * Cholesky em banda (A = L L^T) sobre A no formato de diagonais
+ * (A[diag_idx * n + i], k diagonais, semibanda b = (k - 1) / 2).
+ *
+ * O fator é guardado por linhas, b + 1 valores por linha:
+ *   L[i * (b + 1) + t] = L(i, i - b + t), t = 0..b-1, e L[i * (b + 1) + b] = 1 / L(i, i)
+ * com zeros antes da coluna 0: as linhas do início usam o mesmo laço das demais.
+ * Com k = 7, cada linha do fator são 4 doubles (um registrador AVX) e a
+ * diagonal invertida tira as divisões das substituições.
+ *
+ * Custo: fatoração O(n b^2), cada substituição (ida e volta) O(n b).
+ *
+ * Em blocos (fatoraBandaBlocos) o fator é o de cada bloco diagonal de linhas
+ * [inicioBloco[m], inicioBloco[m + 1]), sem os termos entre blocos: o mesmo
+ * laço com a linha inicial do bloco no lugar de 0, e blocos independentes.
+ */
+typedef struct {
+    int n, b;
+    real_t *L;
+    int nBlocos;            // 1: fator de A inteira
+    int *inicioBloco;       // nBlocos + 1 posições
+    arena_t *arena;
+} fatorBanda_t;
+
+/**
+ * Fatora A. Retorna NULL se A não for SPD (pivô <= 0 ou não finito; *linhaFalha
+ * recebe a linha, se não for NULL) ou em falta de memória (*linhaFalha = -1).
+ */
+fatorBanda_t *fatoraBanda(const real_t *A, int n, int k, int *linhaFalha);
+
+/**
+ * Jacobi em blocos: fatora os blocos diagonais de A, cada um por uma thread.
+ * tamBloco = 0: um bloco por thread, com as linhas de faixaThread (as que a
+ * thread tocou primeiro); senão blocos de tamBloco linhas. D (NULL = diagonal
+ * de A) substitui a diagonal, como a de geraDLU. Falhas como em fatoraBanda.
+ */
+fatorBanda_t *fatoraBandaBlocos(const real_t *A, const real_t *D, int n, int k, int tamBloco, int *linhaFalha);
+void liberaFatorBanda(fatorBanda_t *F);
+
+// x = A^-1 b (x pode ser o próprio b); em blocos, cada thread resolve os seus
+void resolveBanda(const fatorBanda_t *F, const real_t *b, real_t *x);
+
+/**
+ * nrhs lados direitos (B e X com um vetor de n após o outro; X pode ser B).
+ * Os vetores vão em blocos de BLOCO_RHS colunas intercaladas: o laço interno
+ * das substituições é sobre as colunas do bloco (vetorizado) e cada thread
+ * resolve blocos inteiros.
+ */
+int resolveBandaVarios(const fatorBanda_t *F, const real_t *B, real_t *X, int nrhs);
+
+/**
+ * Ciclos estimados da fatoração e de uma substituição (ida e volta), para a
+ * escolha direto x PCG: flops a 1 por ciclo mais a latência da dependência
+ * entre linhas (n = 10^6, k = 7, 1 thread: 47 e 26 ciclos/linha estimados,
+ * 48 e 27 medidos; uma iteração do PCG com Jacobi, 27 flops/linha, mede 29)
+ */
+double custoFatoracaoBanda(int n, int k);
+double custoSubstituicaoBanda(int n, int k);
+
+#endif // __BANDA_H__
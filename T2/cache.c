@@ -0,0 +1,310 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "utils.h"
+#include "cache.h"
+
+#define CACHE_MAGICO "PCGSOL2"
+
+//Cabeçalho dos arquivos do cache em disco (seguido de b[n] e x[n])
+typedef struct {
+    char magico[8];
+    int32_t n;
+    int32_t criterio;
+    uint64_t hashA, hashB;
+    real_t normaFinal;
+    double eps;
+} cabecalhoCache_t;
+
+static const uint64_t PRIMO1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIMO2 = 0xC2B2AE3D27D4EB4FULL;
+
+static inline uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t misturaHash(uint64_t h, uint64_t w)
+{
+    h ^= w * PRIMO2;
+    return rotl64(h, 31) * PRIMO1;
+}
+
+//Hash de 64 bits no estilo xxHash: 4 fluxos independentes escondem a latência
+//da multiplicação, então o custo fica próximo da leitura da memória
+uint64_t hashDados(const void *dados, size_t bytes, uint64_t semente)
+{
+    const unsigned char *p = dados;
+    uint64_t h[4] = { semente + PRIMO1, semente + PRIMO2, semente, semente - PRIMO1 };
+    size_t i = 0;
+
+    for (; i + 32 <= bytes; i += 32) {
+        uint64_t w[4];
+        memcpy(w, p + i, 32);
+        h[0] = misturaHash(h[0], w[0]);
+        h[1] = misturaHash(h[1], w[1]);
+        h[2] = misturaHash(h[2], w[2]);
+        h[3] = misturaHash(h[3], w[3]);
+    }
+
+    uint64_t resultado = rotl64(h[0], 1) + rotl64(h[1], 7) + rotl64(h[2], 12) + rotl64(h[3], 18);
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        resultado = misturaHash(resultado, w);
+    }
+    for (; i < bytes; i++)
+        resultado = misturaHash(resultado, p[i]);
+
+    //avalanche final
+    resultado ^= bytes;
+    resultado ^= resultado >> 33;
+    resultado *= PRIMO2;
+    resultado ^= resultado >> 29;
+    return resultado;
+}
+
+//Impressão digital de (estrutura de A, valores de A) e de b
+void hashSistema(const real_t *A, const real_t *b, int n, int nDiag, uint64_t *hashA, uint64_t *hashB)
+{
+    uint64_t estrutura = ((uint64_t) n << 16) | (uint64_t) nDiag;
+    *hashA = hashDados(A, (size_t) n * nDiag * sizeof(real_t), estrutura);
+    *hashB = hashDados(b, (size_t) n * sizeof(real_t), *hashA);
+}
+
+cacheSolucao_t *criaCache(const char *diretorio)
+{
+    cacheSolucao_t *cache = calloc(1, sizeof(cacheSolucao_t));
+    if (!cache) return NULL;
+
+    if (diretorio) {
+        mkdir(diretorio, 0755); //já existir não é erro
+        cache->diretorio = strdup(diretorio);
+    }
+    return cache;
+}
+
+void liberaCache(cacheSolucao_t *cache)
+{
+    if (!cache) return;
+    for (int i = 0; i < cache->nEntradas; i++) {
+        free(cache->entradas[i].b);
+        free(cache->entradas[i].x);
+    }
+    free(cache->diretorio);
+    free(cache);
+}
+
+static real_t distancia2(const real_t *u, const real_t *v, int n)
+{
+    real_t soma = 0.0;
+    for (int i = 0; i < n; i++) soma += (u[i] - v[i]) * (u[i] - v[i]);
+    return soma;
+}
+
+//x de uma entrada com o mesmo b resolve o SL no critério pedido
+static inline int serveExato(int criterioEntrada, double epsEntrada, int criterio, double eps)
+{
+    if (criterioEntrada == CACHE_NAO_CONVERGIU) return 0;
+    return epsEntrada == 0.0 || (criterioEntrada == criterio && epsEntrada <= eps);
+}
+
+static void nomeArquivo(const cacheSolucao_t *cache, uint64_t hashA, uint64_t hashB, char *nome, size_t tam)
+{
+    snprintf(nome, tam, "%s/%016llx-%016llx.sol", cache->diretorio,
+             (unsigned long long) hashA, (unsigned long long) hashB);
+}
+
+//Lê cabeçalho e b de um arquivo do cache; mantém o arquivo aberto em *f para ler x
+static int leEntradaDisco(const char *nome, int n, cabecalhoCache_t *cab, real_t *b, FILE **f)
+{
+    *f = fopen(nome, "rb");
+    if (!*f) return 0;
+
+    if (fread(cab, sizeof(*cab), 1, *f) != 1 || memcmp(cab->magico, CACHE_MAGICO, 8) != 0 || cab->n != n
+        || fread(b, sizeof(real_t), n, *f) != (size_t) n) {
+        fclose(*f);
+        *f = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+//Procura no diretório a entrada com a mesma A e o b mais próximo (ou idêntico)
+static int buscaDisco(cacheSolucao_t *cache, uint64_t hashA, uint64_t hashB, const real_t *b, int n, int criterio, double eps,
+                      real_t *x, real_t *normaFinal, real_t melhorDist)
+{
+    char prefixo[20], nome[4096], melhorNome[4096] = "";
+    snprintf(prefixo, sizeof(prefixo), "%016llx-", (unsigned long long) hashA);
+
+    DIR *dir = opendir(cache->diretorio);
+    if (!dir) return CACHE_AUSENTE;
+
+    real_t *bDisco = malloc(n * sizeof(real_t));
+    cabecalhoCache_t cab;
+    FILE *f;
+    int resultado = CACHE_AUSENTE;
+
+    //acerto exato: o nome do arquivo identifica a entrada, b e o critério confirmam
+    //(o mesmo b sem convergência no critério pedido é o palpite mais próximo possível)
+    nomeArquivo(cache, hashA, hashB, nome, sizeof(nome));
+    if (bDisco && leEntradaDisco(nome, n, &cab, bDisco, &f)) {
+        if (!memcmp(bDisco, b, n * sizeof(real_t)) && fread(x, sizeof(real_t), n, f) == (size_t) n) {
+            if (serveExato(cab.criterio, cab.eps, criterio, eps)) {
+                *normaFinal = cab.normaFinal;
+                resultado = CACHE_EXATO;
+            } else {
+                resultado = CACHE_PROXIMO;
+            }
+        }
+        fclose(f);
+    }
+
+    struct dirent *ent;
+    while (bDisco && resultado == CACHE_AUSENTE && (ent = readdir(dir)) != NULL) {
+        size_t tam = strlen(ent->d_name);
+        if (strncmp(ent->d_name, prefixo, strlen(prefixo)) != 0
+            || tam < 4 || strcmp(ent->d_name + tam - 4, ".sol") != 0) continue;
+
+        snprintf(nome, sizeof(nome), "%s/%s", cache->diretorio, ent->d_name);
+        if (!leEntradaDisco(nome, n, &cab, bDisco, &f)) continue;
+        fclose(f);
+
+        real_t dist = distancia2(bDisco, b, n);
+        if (dist < melhorDist) {
+            melhorDist = dist;
+            strcpy(melhorNome, nome);
+        }
+    }
+
+    if (resultado == CACHE_AUSENTE && melhorNome[0] && leEntradaDisco(melhorNome, n, &cab, bDisco, &f)) {
+        if (fread(x, sizeof(real_t), n, f) == (size_t) n) resultado = CACHE_PROXIMO;
+        fclose(f);
+    }
+
+    closedir(dir);
+    free(bDisco);
+    return resultado;
+}
+
+int buscaCache(cacheSolucao_t *cache, uint64_t hashA, uint64_t hashB, const real_t *b, int n, int criterio, double eps,
+               real_t *x, real_t *normaFinal)
+{
+    if (!cache) return CACHE_AUSENTE;
+
+    //memória: exato ou mais próximo com a mesma A
+    int melhor = -1;
+    real_t melhorDist = INFINITY;
+    for (int i = 0; i < cache->nEntradas; i++) {
+        entradaCache_t *e = &cache->entradas[i];
+        if (e->hashA != hashA || e->n != n) continue;
+
+        if (e->hashB == hashB && serveExato(e->criterio, e->eps, criterio, eps) &&
+            !memcmp(e->b, b, n * sizeof(real_t))) {
+            memcpy(x, e->x, n * sizeof(real_t));
+            *normaFinal = e->normaFinal;
+            return CACHE_EXATO;
+        }
+
+        real_t dist = distancia2(e->b, b, n);
+        if (dist < melhorDist) {
+            melhorDist = dist;
+            melhor = i;
+        }
+    }
+
+    //disco: só entradas melhores do que a encontrada em memória substituem x
+    if (cache->diretorio) {
+        int resultado = buscaDisco(cache, hashA, hashB, b, n, criterio, eps, x, normaFinal, melhorDist);
+        if (resultado != CACHE_AUSENTE) return resultado;
+    }
+
+    if (melhor >= 0) {
+        memcpy(x, cache->entradas[melhor].x, n * sizeof(real_t));
+        return CACHE_PROXIMO;
+    }
+    return CACHE_AUSENTE;
+}
+
+void insereCache(cacheSolucao_t *cache, uint64_t hashA, uint64_t hashB, const real_t *b, const real_t *x, int n,
+                 real_t normaFinal, int criterio, double eps)
+{
+    if (!cache) return;
+
+    entradaCache_t *e = &cache->entradas[cache->proxima];
+    if (cache->nEntradas < CACHE_MAX_ENTRADAS) {
+        cache->nEntradas++;
+    } else {
+        free(e->b);
+        free(e->x);
+    }
+    cache->proxima = (cache->proxima + 1) % CACHE_MAX_ENTRADAS;
+
+    e->hashA = hashA;
+    e->hashB = hashB;
+    e->n = n;
+    e->normaFinal = normaFinal;
+    e->criterio = criterio;
+    e->eps = eps;
+    e->b = malloc(n * sizeof(real_t));
+    e->x = malloc(n * sizeof(real_t));
+    if (!e->b || !e->x) {
+        free(e->b); free(e->x);
+        e->b = e->x = NULL;
+        e->hashA = e->hashB = 0;
+        e->n = -1;
+        return;
+    }
+    memcpy(e->b, b, n * sizeof(real_t));
+    memcpy(e->x, x, n * sizeof(real_t));
+
+    if (!cache->diretorio) return;
+
+    //grava em arquivo temporário e renomeia: leitores nunca veem entrada pela metade
+    char nome[4096], tmp[4200];
+    nomeArquivo(cache, hashA, hashB, nome, sizeof(nome));
+    snprintf(tmp, sizeof(tmp), "%s.tmp", nome);
+
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return;
+
+    cabecalhoCache_t cab = { CACHE_MAGICO, n, criterio, hashA, hashB, normaFinal, eps };
+    int ok = fwrite(&cab, sizeof(cab), 1, f) == 1
+          && fwrite(b, sizeof(real_t), n, f) == (size_t) n
+          && fwrite(x, sizeof(real_t), n, f) == (size_t) n;
+    ok = (fclose(f) == 0) && ok;
+
+    if (ok) rename(tmp, nome);
+    else remove(tmp);
+}
+
+//Lê x0 de um arquivo com n seguido de n valores (a saída do cgSolver serve)
+int leVetorInicial(const char *arquivo, real_t *x, int n)
+{
+    FILE *f = fopen(arquivo, "r");
+    if (!f) {
+        printf("Erro: não foi possível abrir %s\n", arquivo);
+        return -1;
+    }
+
+    int nArquivo;
+    if (fscanf(f, "%d", &nArquivo) != 1 || nArquivo != n) {
+        printf("Erro: %s não contém um vetor de dimensão %d\n", arquivo, n);
+        fclose(f);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (fscanf(f, "%lf", &x[i]) != 1) {
+            printf("Erro: %s tem menos de %d valores\n", arquivo, n);
+            fclose(f);
+            return -1;
+        }
+    }
+
+    fclose(f);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef __CACHE_H__
+#define __CACHE_H__
+
+#include <stdint.h>
+#include "utils.h"
+
+// Entradas mantidas em memória (as mais antigas são substituídas)
+#define CACHE_MAX_ENTRADAS 16
+
+// Resultado da busca no cache
+#define CACHE_AUSENTE 0 // nenhuma solução aproveitável
+#define CACHE_PROXIMO 1 // mesma A, b diferente: x serve de palpite inicial
+#define CACHE_EXATO   2 // mesmo (A, b) e x convergiu no critério pedido: x já é a solução
+
+// Critério de uma entrada que não passou no teste de parada (só serve de palpite)
+#define CACHE_NAO_CONVERGIU -1
+
+/**
+ * Cache de soluções indexado pela impressão digital do SL.
+ *
+ * hashA cobre a estrutura (n, número de diagonais) e os valores de A;
+ * hashB cobre o vetor b. Entradas ficam em memória e, se 'diretorio' não for
+ * NULL, também em disco (arquivo <hashA>-<hashB>.sol), para reaproveitamento
+ * entre execuções.
+ *
+ * Uma entrada só é acerto exato se b for igual ao guardado (não só o hash) e
+ * x tiver convergido no mesmo critério com eps menor ou igual ao pedido (eps 0:
+ * solução direta, serve a qualquer critério). Do contrário, x é palpite inicial.
+ */
+typedef struct {
+    uint64_t hashA, hashB;
+    int n;
+    real_t normaFinal;  // norma do resíduo ao fim da resolução original
+    int criterio;       // critério em que x convergiu (criterio_t) ou CACHE_NAO_CONVERGIU
+    double eps;         // limiar desse critério
+    real_t *b;          // guardado para achar a solução mais próxima
+    real_t *x;
+} entradaCache_t;
+
+typedef struct {
+    entradaCache_t entradas[CACHE_MAX_ENTRADAS];
+    int nEntradas;
+    int proxima;        // próxima posição a ser substituída
+    char *diretorio;    // NULL: apenas em memória
+} cacheSolucao_t;
+
+cacheSolucao_t *criaCache(const char *diretorio);
+void liberaCache(cacheSolucao_t *cache);
+
+// Hash rápido de 'bytes' bytes (palavras de 64 bits em 4 fluxos independentes)
+uint64_t hashDados(const void *dados, size_t bytes, uint64_t semente);
+
+// Impressão digital do SL A*x = b, A com nDiag diagonais de tamanho n
+void hashSistema(const real_t *A, const real_t *b, int n, int nDiag, uint64_t *hashA, uint64_t *hashB);
+
+/**
+ * Procura a solução de (hashA, hashB) para o critério 'criterio' com limiar
+ * 'eps'. Em acerto exato, copia a solução para x e a norma final para
+ * *normaFinal; caso contrário, copia para x a solução do sistema com a mesma A
+ * cujo b é o mais próximo de 'b' (norma L2; o mesmo b sem convergência conta
+ * como distância 0). Retorna CACHE_EXATO, CACHE_PROXIMO ou CACHE_AUSENTE (x não
+ * é alterado).
+ */
+int buscaCache(cacheSolucao_t *cache, uint64_t hashA, uint64_t hashB, const real_t *b, int n, int criterio, double eps,
+               real_t *x, real_t *normaFinal);
+
+// Guarda a solução x de (hashA, hashB) em memória e, se configurado, em disco. criterio e
+// eps: o teste de parada em que x convergiu (CACHE_NAO_CONVERGIU se não passou nele)
+void insereCache(cacheSolucao_t *cache, uint64_t hashA, uint64_t hashB, const real_t *b, const real_t *x, int n,
+                 real_t normaFinal, int criterio, double eps);
+
+// Lê um palpite inicial no formato de saída do cgSolver (n seguido de n valores)
+int leVetorInicial(const char *arquivo, real_t *x, int n);
+
+#endif // __CACHE_H__
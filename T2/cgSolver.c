@@ -1,28 +1,195 @@
 #include "sislin.h"
-#include "pcgc.h"
+#include "execucao.h"
+#include "topologia.h"
 #include "utils.h"
 #include <stdio.h>
 #include <stdlib.h>
-
-int main() {
+#include <string.h>
+#include <unistd.h>
+
+static void uso(const char *prog) {
+    printf("uso: %s [-s nsis] [-r nvet] [-x arquivo] [-c dir] [-p criterio[,m]] [-e janela[,fator]] [-a afinidade] [-P cap] [-f formato] [-t precisao] [-w sabedoria] [-d] [-C arquivo[,seg]] [-m metodo[,...]] [-g suavizador[,passos]] [-j blocos] [-R] [-M dir[,MiB]] < entrada\n", prog);
+    printf("  -s nsis  resolve uma sequência de nsis sistemas (mesma ASP, b diferentes)\n");
+    printf("  -r nvet  recicla até nvet vetores de Ritz entre as resoluções (CG deflacionado)\n");
+    printf("  -x arq   palpite inicial x0 (n seguido de n valores, como na saída)\n");
+    printf("  -c dir   cache de soluções em dir ('-' = só em memória)\n");
+    printf("  -p crit  critério de parada: abs (||r||), rel (||r||/||r0||), inf (||x-x_ant||_inf)\n");
+    printf("           ou pre (sqrt(r.z)), testado a cada m iterações (padrão abs,1); com -p ou -e,\n");
+    printf("           informa lambda_min, lambda_max e kappa de M^-1 A estimados pelo PCG\n");
+    printf("  -e jan   para se o critério não cair por um fator (padrão 0.99) em jan iterações\n");
+    printf("  -a afin  fixa as threads OpenMP: compact, scatter ou lista de CPUs (\"0,2,8-11\");\n");
+    printf("           informa a topologia e, por nó NUMA, a localidade e a banda de leitura de ASP\n");
+    printf("  -P cap   pipeline: geração, pré-condicionador, PCG e saída de SLs diferentes em paralelo,\n");
+    printf("           com filas de cap posições entre os estágios (cap + %d conjuntos de buffers)\n", N_ESTAGIOS);
+    printf("  -f fmt   formato de A no PCG: dia (padrão; dia-fluxo acima da última cache), dia-fluxo (por\n");
+    printf("           linhas, stores não temporais e prefetch), dia-fantasma (diagonais alinhadas com\n");
+    printf("           margens de zeros, laço igual para todas) ou densa (cópia n x n, blocos nulos pulados)\n");
+    printf("  -t prec  precisão do PCG: double (padrão), float ou long (long double); fora de double,\n");
+    printf("           usa os núcleos genéricos de diagonais com o critério ||r|| < eps (sem -r nem -f)\n");
+    printf("  -d       Jacobi por escala simétrica: ASP <- D^-1/2 ASP D^-1/2 e bsp <- D^-1/2 bsp uma vez,\n");
+    printf("           CG sem pré-condicionador (sem M nem z) e x <- D^-1/2 x no fim (omega = 0)\n");
+    printf("  -w arq   SpMV sintonizado: variante/threads/bloco lidos da sabedoria em arq ou, na\n");
+    printf("           primeira vez para esta CPU e faixa de n, medidos e gravados (ver ./sintoniza)\n");
+    printf("  -C arq   checkpoint do PCG em arq (mmap) a cada seg segundos (padrão 60); se arq tiver o\n");
+    printf("           estado do mesmo SL, a resolução continua da última iteração gravada\n");
+    printf("  -m met   pcg (padrão), direto (Cholesky em banda de ASP; ASP precisa ser SPD), auto\n");
+    printf("           (direto se o custo estimado for menor que o do PCG; PCG se ASP não for SPD) ou\n");
+    printf("           cheb[,it] | cheb,lmin,lmax: iteração de Chebyshev, sem produtos escalares, no\n");
+    printf("           intervalo estimado pelos alpha/beta de it iterações do PCG (padrão %d; os SLs\n", ITER_ESPECTRO);
+    printf("           seguintes já começam no Chebyshev) ou em [lmin, lmax]; o critério é testado a\n");
+    printf("           cada m iterações de -p (padrão %d) e lambda_max dobra se o método divergir\n", INTERVALO_CHEBYSHEV);
+    printf("  -g suav  pré-condicionador AMG (agregação suavizada, ciclo V) no lugar do Jacobi (omega = 0),\n");
+    printf("           com suavizador jacobi (padrão 1 varredura) ou cheb (Chebyshev, padrão grau 2)\n");
+    printf("  -j blc   Jacobi em blocos no lugar do Jacobi (omega = 0): blocos diagonais de ASP fatorados\n");
+    printf("           (Cholesky em banda) e resolvidos em paralelo; blc = thread (um bloco por thread),\n");
+    printf("           cache (blocos do tamanho de meia L2) ou o número de linhas por bloco\n");
+    printf("  -R       reduções reprodutíveis no PCG: iterações e resíduo iguais bit a bit com qualquer\n");
+    printf("           número de threads (blocos fixos somados aos pares; -j thread muda com as threads)\n");
+    printf("  -M dir   cache em disco do preparo (ASP, D, M, D^1/2 e o fator de -m/-j) com até MiB (padrão\n");
+    printf("           %d): indexado pelo hash de A e dos parâmetros; num acerto o arquivo é mapeado (mmap)\n", LIMITE_PREPARO_MIB);
+}
+
+int main(int argc, char **argv) {
     //inicializa LIKIWD se definido
     LIKWID_MARKER_INIT;
 
-    int n;          // dimensão do SL >10
-    int k = 7;      // número de diagonais da matriz >1 e ímpar
-    double omega;   // pré-condicionador
-    int maxit;      // número máx. de iterações
-    double epsilon; // erro aprox. absoluto máximo
+    execucao_t exec;
+    execucaoPadrao(&exec);
+    int intervaloDado = 0; // critério testado a cada m iterações pedido em -p
+    char *afinidade = NULL; // política de afinidade das threads (NULL = a do runtime OpenMP)
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:r:x:c:p:e:a:P:f:t:w:dC:m:g:j:RM:")) != -1) {
+        switch (opt) {
+            case 's': exec.nSistemas = atoi(optarg); break;
+            case 'r': exec.nReciclados = atoi(optarg); break;
+            case 'x': exec.arqX0 = optarg; break;
+            case 'c': exec.dirCache = optarg; break;
+            case 'p':
+                if (leCriterio(optarg, &exec.controle)) { uso(argv[0]); return 1; }
+                intervaloDado = (strchr(optarg, ',') != NULL);
+                exec.controle.detectaQuebra = exec.relataParada = 1;
+                break;
+            case 'e':
+                exec.controle.janelaEstagnacao = atoi(optarg);
+                exec.controle.fatorEstagnacao = strchr(optarg, ',') ? atof(strchr(optarg, ',') + 1) : 0.99;
+                exec.controle.detectaQuebra = exec.relataParada = 1;
+                break;
+            case 'a': afinidade = optarg; break;
+            case 'P':
+                exec.capacidade = atoi(optarg);
+                if (exec.capacidade < 1) { uso(argv[0]); return 1; }
+                break;
+            case 'f': exec.formato = optarg; break;
+            case 'w': exec.arqSabedoria = optarg; break;
+            case 'd': exec.escala = 1; break;
+            case 'R': exec.controle.reprodutivel = 1; break;
+            case 'C':
+                exec.arqCheckpoint = optarg;
+                exec.intervaloCheckpoint = strchr(optarg, ',') ? atof(strchr(optarg, ',') + 1) : 60.0;
+                if (strchr(optarg, ',')) *strchr(optarg, ',') = '\0';
+                break;
+            case 'M':
+                exec.dirPreparo = optarg;
+                if (strchr(optarg, ',')) {
+                    if (atof(strchr(optarg, ',') + 1) <= 0.0) { uso(argv[0]); return 1; }
+                    exec.limitePreparo = (size_t) (atof(strchr(optarg, ',') + 1) * (1 << 20));
+                    *strchr(optarg, ',') = '\0';
+                }
+                break;
+            case 'm':
+                if (!strcmp(optarg, "pcg")) exec.metodo = 'p';
+                else if (!strcmp(optarg, "direto")) exec.metodo = 'd';
+                else if (!strcmp(optarg, "auto")) exec.metodo = 'a';
+                else if (!strncmp(optarg, "cheb", 4) && (optarg[4] == '\0' || optarg[4] == ',')) {
+                    //cheb[,it] ou cheb,lmin,lmax
+                    char *v1 = strchr(optarg, ','), *v2 = v1 ? strchr(v1 + 1, ',') : NULL;
+                    exec.metodo = 'c';
+                    if (v2) {
+                        exec.lambdaMin = atof(v1 + 1);
+                        exec.lambdaMax = atof(v2 + 1);
+                        if (!(exec.lambdaMin > 0.0 && exec.lambdaMax > exec.lambdaMin)) { uso(argv[0]); return 1; }
+                    } else if (v1) {
+                        exec.iterEspectro = atoi(v1 + 1);
+                        if (exec.iterEspectro < 2) { uso(argv[0]); return 1; }
+                    }
+                }
+                else { uso(argv[0]); return 1; }
+                break;
+            case 'g':
+                if (leSuavizador(optarg, &exec.suavizador, &exec.passosAMG)) { uso(argv[0]); return 1; }
+                exec.amg = 1;
+                break;
+            case 'j':
+                if (!strcmp(optarg, "thread")) {
+                    exec.tamBloco = 0;
+                } else if (!strcmp(optarg, "cache")) {
+                    //fator (semibanda + 1 reais por linha), r e z de um bloco em meia L2
+                    size_t l2 = tamanhoCache(2) ? tamanhoCache(2) : 1 << 20;
+                    exec.tamBloco = l2 / 2 / ((OFFSET_CENTER + 3) * sizeof(real_t));
+                } else {
+                    exec.tamBloco = atoi(optarg);
+                    if (exec.tamBloco < 1) { uso(argv[0]); return 1; }
+                }
+                break;
+            case 't':
+                if (!strcmp(optarg, "double")) exec.precisao = 'd';
+                else if (!strcmp(optarg, "float")) exec.precisao = 'f';
+                else if (!strcmp(optarg, "long")) exec.precisao = 'l';
+                else { uso(argv[0]); return 1; }
+                break;
+            default: uso(argv[0]); return 1;
+        }
+    }
+    if (exec.nSistemas < 1 || exec.nReciclados < 0) {
+        uso(argv[0]);
+        return 1;
+    }
+
+    //o checkpoint é do loop de gradienteConjugadoControle (double, sem reciclagem)
+    if (exec.arqCheckpoint && (exec.nReciclados > 0 || exec.precisao != 'd')) {
+        printf("Erro: -C não se combina com -r nem com -t float|long\n");
+        return 1;
+    }
+
+    //-t float|long resolve com cgDIA sobre as diagonais do tipo pedido: sem subespaço reciclado
+    //e sem outro formato de A (os operadores de -f são de real_t)
+    if (exec.precisao != 'd' && (exec.nReciclados > 0 || strcmp(exec.formato, "dia"))) {
+        printf("Erro: -t float|long não se combina com -r nem com -f\n");
+        return 1;
+    }
 
-    //variáveis para armazenar tempos de execução
-    rtime_t tDLU = 0.0, tPrecond = 0.0, tempoIter = 0.0, tResiduo = 0.0;
-    //variáveis para armazenar normas
-    real_t normaFinal = 0.0, norma_residuo = 0.0;
+    //as reduções reprodutíveis são as de gradienteConjugadoControle (a reciclagem já soma em ordem)
+    if (exec.controle.reprodutivel && exec.precisao != 'd') {
+        printf("Erro: -R não se combina com -t float|long\n");
+        return 1;
+    }
+
+    //o Chebyshev usa o controle e o pré-condicionador de gradienteConjugadoControle, sem produtos
+    //escalares (nem o critério pre) e sem checkpoint
+    if (exec.metodo == 'c') {
+        if (exec.nReciclados > 0 || exec.precisao != 'd' || exec.arqCheckpoint || exec.controle.criterio == CRITERIO_PRECOND) {
+            printf("Erro: -m cheb não se combina com -r, -C, -p pre nem -t float|long\n");
+            return 1;
+        }
+        if (!intervaloDado) exec.controle.intervalo = INTERVALO_CHEBYSHEV;
+    }
+
+    //AMG e Jacobi em blocos são o z do loop de gradienteConjugadoControle (double, sem
+    //reciclagem nem escala)
+    int precondGeral = exec.amg + (exec.tamBloco >= 0);
+    if (precondGeral > 1 || (precondGeral && (exec.nReciclados > 0 || exec.precisao != 'd' || exec.escala ||
+                                              exec.metodo == 'd' || exec.metodo == 'a'))) {
+        printf("Erro: -g e -j não se combinam entre si nem com -d, -r, -m ou -t float|long\n");
+        return 1;
+    }
 
     // ========== Leitura da entrada ============
 
     //lê n, k, omega, maxit, epsilon da entrada padrão (STDIN)
-    int items_read = scanf("%d %lf %d %lf", &n, &omega, &maxit, &epsilon);
+    //(n: dimensão do SL >10; omega: pré-condicionador; maxit: número máx. de iterações;
+    // epsilon: erro aprox. absoluto máximo)
+    int items_read = scanf("%d %lf %d %lf", &exec.n, &exec.omega, &exec.maxit, &exec.epsilon);
 
     //verifica se a leitura foi bem-sucedida
     if (items_read < 4) {
@@ -31,107 +198,56 @@ int main() {
     }
 
     //validação dos parâmetros
-    if (n <= 10) {
+    if (exec.n <= 10) {
         printf("Erro: dimensão deve ser > 10\n");
         return 1;
     }
 
-    // =========== Geração do sistema ==========
-    
-    // Aloca matriz A inicializando com 0 (Layout V2: n*k)
-    real_t *A = calloc(n * k, sizeof(real_t)); 
-    real_t *b = calloc(n, sizeof(real_t)); //aloca vetor B inicializando com 0
-    real_t *x = calloc(n, sizeof(real_t)); //aloca o vetor de solução x inicializando com 0 
-    
-    //verifica a alocação de memória 
-    if (!b || !x || !A) {
-        printf("Erro de alocação de memória em b ou x ou a\n");
+    //a escala simétrica substitui o Jacobi (usa a diagonal de M)
+    if (exec.escala && exec.omega != 0.0) {
+        printf("Erro: -d exige o pré-condicionador de Jacobi (omega = 0)\n");
+        return 1;
+    }
+    if (exec.metodo == 'c' && exec.maxit < 1) {
+        printf("Erro: -m cheb exige maxit >= 1\n");
         return 1;
     }
 
-    //marca tempo de geração da matriz A e vetor b 
-    rtime_t tGen = timestamp();
-
-    //chama função que cria a matriz e o vetor B 
-    criaKDiagonal(n, k, A, b);
-
-    // Aloca ASP e bsp para o sistema simétrico positivo
-    real_t *ASP = calloc(n * k, sizeof(real_t));
-    real_t *bsp = calloc(n, sizeof(real_t));
-
-    genSimetricaPositiva(A, b, n, k, ASP, bsp, &tGen);
-
-    //calcula o tempo gasto 
-    tGen = timestamp() - tGen;
-
-    // ========== Decomposição DLU ===========
-
-    real_t *D = malloc(n * sizeof(real_t));
-    real_t *L = malloc(n * sizeof(real_t));
-    real_t *U = malloc(n * sizeof(real_t));
-
-    //função que gera o DLU 
-    //calcula a decomposição DLU de A
-    //armazena o tempo em tDLU
-    geraDLU(ASP, n, k, D, L, U, &tDLU, epsilon);
+    if (precondGeral && exec.omega != 0.0) {
+        printf("Erro: -g e -j substituem o pré-condicionador de Jacobi (omega = 0)\n");
+        return 1;
+    }
 
-    // ========== Geração do pré condicionador ===========
-    
-    //aloca vetor M que armazena o pré-condicionados
-    real_t *M;
-    //gera o pré-condicionador M usando D, L, U
-    //o parâmetro omega e armazena o tempo em tPrecond
-    if (omega != -1.0) {
-        M = malloc(n * sizeof(real_t));
-        if (!M) {
-            printf("Erro de alocacao M\n");
-            free(A); free(b); free(x); free(D); free(L); free(U); free(ASP); free(bsp);
+    //threads fixadas antes da arena: o primeiro toque já acontece na CPU definitiva
+    topologia_t topo;
+    int cpuDaThread[TOPO_MAX_CPUS];
+    if (afinidade) {
+        leTopologia(&topo);
+        int nThreads = fixaThreads(&topo, afinidade, cpuDaThread);
+        if (nThreads < 0) {
+            uso(argv[0]);
             return 1;
         }
-        geraPreCond(D, L, U, omega, n, k, M, &tPrecond, epsilon);
-    } else {
-        M = NULL;
+        imprimeTopologia(&topo, stderr);
+        fprintf(stderr, "# afinidade %s:", afinidade);
+        for (int t = 0; t < nThreads; t++) fprintf(stderr, " t%d->%d", t, cpuDaThread[t]);
+        fprintf(stderr, "\n");
     }
 
-    // ========== Execução do método PCG ===========
-    
-    //iterações 
-    int iter = 0;
-
-    //mede o tempo de execução do GCG
-    //executa o pcg 
-    iter = gradienteConjugado(ASP, bsp, x, n, maxit, epsilon, M, &normaFinal, &tempoIter);
-    
-    // =========== Clculo do resíduo ==========
-
-    //calcula a norma resíduo com os valores de A e x obtidos 
-    norma_residuo = calcResiduoSL(A, b, x, n, k, &tResiduo);
-    
-    // ========== Impressão dos resultados ===========
-    printf("%d\n", n);
-    for (int i = 0; i < n; ++i)
-        printf("%.16g ", x[i]);
-    printf("\n");
-
-    printf("%.8g\n", normaFinal);
-    printf("%.16g\n", norma_residuo);
-    tPrecond == 0.0 ? printf("Nao calculado\n") : printf("%.8g\n", tPrecond);
-    printf("%.8g\n", tempoIter);
-    printf("%.8g\n", tResiduo);
-    // printf("Iterações: %d\n", iter);
+    //buffers dos SLs, subespaço, sintonia, caches e escritora; depois, a sequência
+    if (abreExecucao(&exec) || executaSequencia(&exec)) {
+        fechaExecucao(&exec);
+        return 1;
+    }
+
+    //posicionamento das páginas de ASP (lida a cada iteração) por nó
+    if (afinidade) relatorioNos(&topo, cpuDaThread, exec.sistemas[0].ASP, exec.n, N_DIAG, stderr);
 
     // ============Libera memória ==========
-    free(A);
-    free(b);
-    free(x);
-    free(ASP);
-    free(bsp);
-    free(D);
-    free(L);
-    free(U);
-    if (M) free(M); 
+    fechaExecucao(&exec);
 
     LIKWID_MARKER_CLOSE;
 
     return 0;
-}
\ No newline at end of file
+}
+
@@ -0,0 +1,141 @@
+#include "sislin.h"
+#include "pcgcMPI.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+
+//Versão distribuída do cgSolver: mesma entrada (STDIN do rank 0) e mesma saída
+int main(int argc, char **argv) {
+    //MPI + threads: apenas a thread principal faz chamadas MPI
+    int suporte;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &suporte);
+
+    LIKWID_MARKER_INIT;
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    int n = 0;          // dimensão do SL >10
+    int k = 7;          // número de diagonais da matriz >1 e ímpar
+    double omega = 0.0; // pré-condicionador
+    int maxit = 0;      // número máx. de iterações
+    double epsilon = 0.0; // erro aprox. absoluto máximo
+    int ok = 1;
+
+    rtime_t tDLU = 0.0, tPrecond = 0.0, tempoIter = 0.0, tResiduo = 0.0;
+    real_t normaFinal = 0.0, norma_residuo = 0.0;
+
+    // ========== Leitura da entrada (rank 0) ============
+    if (rank == 0) {
+        if (scanf("%d %lf %d %lf", &n, &omega, &maxit, &epsilon) < 4) {
+            printf("Erro: Não foi possível ler todos os 4 valores de entrada.\n");
+            ok = 0;
+        } else if (n <= 10) {
+            printf("Erro: dimensão deve ser > 10\n");
+            ok = 0;
+        }
+    }
+
+    MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (!ok) {
+        MPI_Finalize();
+        return 1;
+    }
+    MPI_Bcast(&n, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&omega, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&maxit, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&epsilon, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    blocoMPI_t bloco;
+    particionaLinhas(n, MPI_COMM_WORLD, &bloco);
+    int nL = bloco.nLocal;
+
+    //cada bloco precisa cobrir o halo dos vizinhos
+    int halo = ((k - 1) / 2 > OFFSET_CENTER) ? (k - 1) / 2 : OFFSET_CENTER;
+    int minLocal;
+    MPI_Allreduce(&nL, &minLocal, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (minLocal < halo) {
+        if (rank == 0) printf("Erro: n=%d muito pequeno para %d processos\n", n, bloco.nprocs);
+        MPI_Finalize();
+        return 1;
+    }
+
+    // =========== Geração do bloco local ==========
+    real_t *A = malloc(nL * k * sizeof(real_t));
+    real_t *b = malloc(nL * sizeof(real_t));
+    real_t *x = calloc(nL, sizeof(real_t));
+    real_t *ASP = malloc(nL * N_DIAG * sizeof(real_t));
+
+    if (!A || !b || !x || !ASP) {
+        printf("Erro de alocação de memória no rank %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    criaKDiagonalBloco(n, k, bloco.inicio, nL, A, b);
+    genSimetricaPositivaBloco(n, bloco.inicio, nL, ASP);
+
+    // ========== Decomposição DLU e pré-condicionador (locais) ===========
+    real_t *D = malloc(nL * sizeof(real_t));
+    real_t *L = malloc(nL * sizeof(real_t));
+    real_t *U = malloc(nL * sizeof(real_t));
+    geraDLU(ASP, nL, N_DIAG, D, L, U, &tDLU, epsilon);
+
+    real_t *M = NULL;
+    if (omega != -1.0) {
+        M = malloc(nL * sizeof(real_t));
+        if (!M) {
+            printf("Erro de alocacao M\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        geraPreCond(D, L, U, omega, nL, N_DIAG, M, &tPrecond, epsilon);
+    }
+
+    // ========== Execução do método PCG ===========
+    int iter = gradienteConjugadoMPI(&bloco, ASP, b, x, maxit, epsilon, M, &normaFinal, &tempoIter);
+    if (iter < 0) MPI_Abort(MPI_COMM_WORLD, 1);
+
+    norma_residuo = calcResiduoSLMPI(&bloco, A, b, x, k, &tResiduo);
+
+    //tempos reportados são os do processo mais lento
+    rtime_t tempos[3] = { tPrecond, tempoIter, tResiduo }, tMax[3];
+    MPI_Reduce(tempos, tMax, 3, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    // ========== Junta x no rank 0 ===========
+    int *contagens = NULL, *deslocs = NULL;
+    real_t *xGlobal = NULL;
+    if (rank == 0) {
+        contagens = malloc(bloco.nprocs * sizeof(int));
+        deslocs = malloc(bloco.nprocs * sizeof(int));
+        xGlobal = malloc(n * sizeof(real_t));
+    }
+    MPI_Gather(&nL, 1, MPI_INT, contagens, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Gather(&bloco.inicio, 1, MPI_INT, deslocs, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Gatherv(x, nL, MPI_DOUBLE, xGlobal, contagens, deslocs, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    // ========== Impressão dos resultados ===========
+    if (rank == 0) {
+        printf("%d\n", n);
+        for (int i = 0; i < n; ++i)
+            printf("%.16g ", xGlobal[i]);
+        printf("\n");
+
+        printf("%.8g\n", normaFinal);
+        printf("%.16g\n", norma_residuo);
+        tMax[0] == 0.0 ? printf("Nao calculado\n") : printf("%.8g\n", tMax[0]);
+        printf("%.8g\n", tMax[1]);
+        printf("%.8g\n", tMax[2]);
+
+        free(contagens); free(deslocs); free(xGlobal);
+    }
+
+    // ============Libera memória ==========
+    free(A); free(b); free(x); free(ASP);
+    free(D); free(L); free(U);
+    if (M) free(M);
+
+    LIKWID_MARKER_CLOSE;
+    MPI_Finalize();
+
+    return 0;
+}
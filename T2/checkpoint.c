@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "checkpoint.h"
+#include "topologia.h"
+#include "arena.h"
+
+#define MAGICA_CHECKPOINT "PCGCKPT1"
+#define PAGINA_CHECKPOINT 4096
+
+//Primeira página do arquivo; as posições começam na segunda
+typedef struct {
+    char magica[8];
+    int32_t n, reservado;
+    uint64_t identidade;
+    uint64_t seq[2];        // ordem das gravações de cada posição (0 = inválida)
+    estadoCG_t estado[2];
+} cabecalhoCheckpoint_t;
+
+struct checkpoint_t {
+    int fd, n;
+    size_t bytesPosicao, bytesArquivo;
+    char *mapa;
+    cabecalhoCheckpoint_t *cab;
+
+    //buffer do último ponto (x, r, p): escrito pelo loop, lido pela gravadora.
+    //Numa arena já tocada pelas threads do loop: a cópia não paga faltas de página
+    arena_t *arena;
+    real_t *copia[3];
+    estadoCG_t estadoCopia;
+
+    double intervalo;       // ms entre pontos
+    rtime_t ultimo;         // instante do último ponto aceito
+
+    pthread_t gravadora;
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;
+    int pendente, encerra, ativa;
+
+    //estatísticas
+    int iterRetomada, pontos, adiados, gravacoes;
+    double tempoRetomado;   // ms de iterações antes da retomada
+    double tempoLoop;       // ms gastos em pontoCheckpoint
+    double tempoGravacao;   // ms da gravadora (fora do loop)
+};
+
+static inline real_t *posicao(const checkpoint_t *c, int s)
+{
+    return (real_t *) (c->mapa + PAGINA_CHECKPOINT + s * c->bytesPosicao);
+}
+
+//Posição com o estado mais recente (-1 se nenhuma é válida)
+static int posicaoValida(const cabecalhoCheckpoint_t *cab)
+{
+    if (!cab->seq[0] && !cab->seq[1]) return -1;
+    return (cab->seq[0] > cab->seq[1]) ? 0 : 1;
+}
+
+//Grava o buffer na posição que não tem o último estado. A posição é
+//invalidada antes da escrita e só volta a valer depois do msync dos dados.
+static void gravaPosicao(checkpoint_t *c)
+{
+    cabecalhoCheckpoint_t *cab = c->cab;
+    int s = (cab->seq[0] <= cab->seq[1]) ? 0 : 1;
+    uint64_t seq = ((cab->seq[0] > cab->seq[1]) ? cab->seq[0] : cab->seq[1]) + 1;
+
+    cab->seq[s] = 0;
+    msync(cab, PAGINA_CHECKPOINT, MS_SYNC);
+
+    for (int v = 0; v < 3; v++)
+        memcpy(posicao(c, s) + v * (size_t) c->n, c->copia[v], (size_t) c->n * sizeof(real_t));
+    msync(posicao(c, s), c->bytesPosicao, MS_SYNC);
+
+    cab->estado[s] = c->estadoCopia;
+    cab->seq[s] = seq;
+    msync(cab, PAGINA_CHECKPOINT, MS_SYNC);
+}
+
+static void *rotinaGravadora(void *arg)
+{
+    checkpoint_t *c = arg;
+    pthread_mutex_lock(&c->trava);
+    for (;;) {
+        while (!c->pendente && !c->encerra) pthread_cond_wait(&c->sinal, &c->trava);
+        if (!c->pendente) break;
+        pthread_mutex_unlock(&c->trava);
+
+        rtime_t t0 = timestamp();
+        gravaPosicao(c);
+        t0 = timestamp() - t0;
+
+        pthread_mutex_lock(&c->trava);
+        c->tempoGravacao += t0;
+        c->gravacoes++;
+        c->pendente = 0;
+    }
+    pthread_mutex_unlock(&c->trava);
+    return NULL;
+}
+
+checkpoint_t *abreCheckpoint(const char *arquivo, int n, uint64_t identidade, double intervalo)
+{
+    checkpoint_t *c = calloc(1, sizeof(checkpoint_t));
+    if (!c) return NULL;
+    c->n = n;
+    c->intervalo = intervalo * 1000.0;
+    c->bytesPosicao = (3 * (size_t) n * sizeof(real_t) + PAGINA_CHECKPOINT - 1) & ~(size_t) (PAGINA_CHECKPOINT - 1);
+    c->bytesArquivo = PAGINA_CHECKPOINT + 2 * c->bytesPosicao;
+
+    c->fd = open(arquivo, O_RDWR | O_CREAT, 0644);
+    struct stat st;
+    if (c->fd < 0 || fstat(c->fd, &st)) {
+        printf("Erro: não foi possível abrir o checkpoint %s\n", arquivo);
+        if (c->fd >= 0) close(c->fd);
+        free(c);
+        return NULL;
+    }
+
+    //tamanho diferente: outro n (ou arquivo novo), nada a retomar
+    int reinicia = ((size_t) st.st_size != c->bytesArquivo);
+    if (reinicia && ftruncate(c->fd, c->bytesArquivo)) {
+        printf("Erro: não foi possível reservar %zu bytes para o checkpoint %s\n", c->bytesArquivo, arquivo);
+        close(c->fd);
+        free(c);
+        return NULL;
+    }
+
+    c->mapa = mmap(NULL, c->bytesArquivo, PROT_READ | PROT_WRITE, MAP_SHARED, c->fd, 0);
+    c->arena = criaArena(3 * tamanhoVetorArena(n), ARENA_PAGINAS_ENORMES | ARENA_PRIMEIRO_TOQUE);
+    if (c->mapa == MAP_FAILED || !c->arena) {
+        printf("Erro: não foi possível mapear o checkpoint %s\n", arquivo);
+        if (c->mapa != MAP_FAILED) munmap(c->mapa, c->bytesArquivo);
+        liberaArena(c->arena);
+        close(c->fd);
+        free(c);
+        return NULL;
+    }
+    c->cab = (cabecalhoCheckpoint_t *) c->mapa;
+    for (int v = 0; v < 3; v++) c->copia[v] = arenaVetor(c->arena, n);
+
+    cabecalhoCheckpoint_t *cab = c->cab;
+    if (reinicia || memcmp(cab->magica, MAGICA_CHECKPOINT, 8) || cab->n != n || cab->identidade != identidade) {
+        memset(cab, 0, sizeof(*cab));
+        memcpy(cab->magica, MAGICA_CHECKPOINT, 8);
+        cab->n = n;
+        cab->identidade = identidade;
+        msync(cab, PAGINA_CHECKPOINT, MS_SYNC);
+    }
+
+    pthread_mutex_init(&c->trava, NULL);
+    pthread_cond_init(&c->sinal, NULL);
+    c->ativa = (pthread_create(&c->gravadora, NULL, rotinaGravadora, c) == 0);
+    c->ultimo = timestamp();
+    return c;
+}
+
+int leCheckpoint(checkpoint_t *c, real_t *x, real_t *r, real_t *p, estadoCG_t *estado)
+{
+    int s = posicaoValida(c->cab);
+    if (s < 0) return 0;
+
+    const size_t bytes = (size_t) c->n * sizeof(real_t);
+    const real_t *dados = posicao(c, s);
+    memcpy(x, dados, bytes);
+    memcpy(r, dados + c->n, bytes);
+    memcpy(p, dados + 2 * (size_t) c->n, bytes);
+    *estado = c->cab->estado[s];
+
+    c->iterRetomada = estado->iter;
+    c->tempoRetomado = estado->tempoIter;
+    c->ultimo = timestamp();
+    return 1;
+}
+
+void pontoCheckpoint(checkpoint_t *c, const real_t *x, const real_t *r, const real_t *p, const estadoCG_t *estado)
+{
+    rtime_t t0 = timestamp();
+    if (t0 - c->ultimo < c->intervalo) {
+        c->tempoLoop += timestamp() - t0;
+        return;
+    }
+
+    //sem trava: só a gravadora zera 'pendente', e ela não toca no buffer depois disso
+    if (__atomic_load_n(&c->pendente, __ATOMIC_ACQUIRE) || !c->ativa) {
+        c->adiados++;
+        c->tempoLoop += timestamp() - t0;
+        return;
+    }
+
+    const int n = c->n;
+    real_t *cx = c->copia[0], *cr = c->copia[1], *cp = c->copia[2];
+    #pragma omp parallel for schedule(static) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) {
+        cx[i] = x[i];
+        cr[i] = r[i];
+        cp[i] = p[i];
+    }
+    c->estadoCopia = *estado;
+
+    pthread_mutex_lock(&c->trava);
+    c->pendente = 1;
+    pthread_cond_signal(&c->sinal);
+    pthread_mutex_unlock(&c->trava);
+
+    c->pontos++;
+    c->ultimo = timestamp();
+    c->tempoLoop += c->ultimo - t0;
+}
+
+void encerraCheckpoint(checkpoint_t *c, int concluido)
+{
+    if (c->ativa) {
+        pthread_mutex_lock(&c->trava);
+        c->encerra = 1;
+        pthread_cond_signal(&c->sinal);
+        pthread_mutex_unlock(&c->trava);
+        pthread_join(c->gravadora, NULL);
+        c->ativa = 0;
+    }
+
+    if (concluido) {
+        c->cab->seq[0] = c->cab->seq[1] = 0;
+        msync(c->cab, PAGINA_CHECKPOINT, MS_SYNC);
+    }
+}
+
+void relatorioCheckpoint(const checkpoint_t *c, double tempoIteracoes, FILE *saida)
+{
+    double tempoExecucao = tempoIteracoes - c->tempoRetomado;
+    if (c->iterRetomada > 0)
+        fprintf(saida, "# checkpoint: retomado da iteração %d (%.3f ms de iterações anteriores)\n",
+                c->iterRetomada, c->tempoRetomado);
+    fprintf(saida, "# checkpoint: %d pontos (%d adiados), %.3f ms no loop (%.3f%% das iterações), "
+            "%.3f ms de gravação em segundo plano\n", c->pontos, c->adiados, c->tempoLoop,
+            tempoExecucao > 0.0 ? 100.0 * c->tempoLoop / tempoExecucao : 0.0, c->tempoGravacao);
+}
+
+void liberaCheckpoint(checkpoint_t *c)
+{
+    if (!c) return;
+    encerraCheckpoint(c, 0);
+    pthread_mutex_destroy(&c->trava);
+    pthread_cond_destroy(&c->sinal);
+    munmap(c->mapa, c->bytesArquivo);
+    close(c->fd);
+    liberaArena(c->arena);
+    free(c);
+}
@@ -0,0 +1,60 @@
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include "utils.h"
+
+/**
+ * Estado escalar do PCG ao fim de uma iteração. Com x, r e p é tudo o que o
+ * loop precisa para continuar exatamente dali (z é recalculado a partir de r).
+ */
+typedef struct {
+    int iter;           // iterações concluídas
+    int iterMelhor;     // última melhora do critério (estagnação)
+    real_t rz_old, pMax, limiar, melhor, normaFinal;
+    double tempoIter;   // ms gastos nas iterações até aqui
+} estadoCG_t;
+
+/**
+ * Checkpoint do PCG num arquivo mapeado (mmap): um cabeçalho e duas posições
+ * com x, r e p. Cada gravação vai para a posição que não tem o último estado
+ * válido, então uma queda no meio da escrita deixa o anterior intacto.
+ *
+ * O loop só copia x, r e p para um buffer em memória (uma passada paralela),
+ * e no máximo uma vez a cada 'intervalo' segundos. Uma thread gravadora
+ * copia o buffer para o arquivo e faz o msync enquanto o PCG continua. Se a
+ * gravação anterior ainda não acabou, o ponto é adiado: o loop nunca espera
+ * o disco.
+ */
+typedef struct checkpoint_t checkpoint_t;
+
+/**
+ * Abre (ou cria) o arquivo para um SL de dimensão n. 'identidade' é o hash de
+ * A, b e dos parâmetros do PCG: um arquivo de outro SL é reiniciado, sem
+ * retomada. Retorna NULL em erro.
+ */
+checkpoint_t *abreCheckpoint(const char *arquivo, int n, uint64_t identidade, double intervalo);
+
+// Copia o último estado gravado para x, r, p e *estado. Retorna 1 se havia um, 0 se não.
+int leCheckpoint(checkpoint_t *c, real_t *x, real_t *r, real_t *p, estadoCG_t *estado);
+
+// Chamado ao fim de cada iteração: só copia se o intervalo passou e a gravadora está livre
+void pontoCheckpoint(checkpoint_t *c, const real_t *x, const real_t *r, const real_t *p, const estadoCG_t *estado);
+
+/**
+ * Espera a gravação pendente e encerra a gravadora. Com 'concluido', invalida
+ * as duas posições: o SL foi resolvido e a próxima execução começa do zero.
+ */
+void encerraCheckpoint(checkpoint_t *c, int concluido);
+
+/**
+ * Retomada, pontos gravados/adiados, tempo no loop (as cópias), tempo da
+ * gravadora e a fração do tempo das iterações desta execução gasta no loop.
+ * tempoIteracoes: ms de todas as iterações do SL (inclusive as anteriores à retomada)
+ */
+void relatorioCheckpoint(const checkpoint_t *c, double tempoIteracoes, FILE *saida);
+
+void liberaCheckpoint(checkpoint_t *c);
+
+#endif // __CHECKPOINT_H__
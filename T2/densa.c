@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+#include "densa.h"
+
+mapaBlocos_t *criaMapaBlocos(const real_t *A, int n)
+{
+    mapaBlocos_t *mapa = malloc(sizeof(mapaBlocos_t));
+    if (!mapa) return NULL;
+
+    int nb = (n + TAM_BLOCO - 1) / TAM_BLOCO;
+    mapa->n = n;
+    mapa->nb = nb;
+    mapa->naoNulo = calloc((size_t) nb * nb, 1);
+    mapa->colIni = malloc(nb * sizeof(int));
+    mapa->colFim = malloc(nb * sizeof(int));
+    if (!mapa->naoNulo || !mapa->colIni || !mapa->colFim) {
+        liberaMapaBlocos(mapa);
+        return NULL;
+    }
+
+    //cada thread varre linhas inteiras de blocos (acesso contíguo, sem conflito de escrita)
+    #pragma omp parallel for schedule(static)
+    for (int I = 0; I < nb; ++I) {
+        unsigned char *linhaMapa = &mapa->naoNulo[(size_t) I * nb];
+        int iFim = (I + 1) * TAM_BLOCO < n ? (I + 1) * TAM_BLOCO : n;
+
+        for (int i = I * TAM_BLOCO; i < iFim; ++i) {
+            const real_t *linha = &A[(size_t) i * n];
+            for (int J = 0; J < nb; ++J) {
+                if (linhaMapa[J]) continue;
+                int jFim = (J + 1) * TAM_BLOCO < n ? (J + 1) * TAM_BLOCO : n;
+                for (int j = J * TAM_BLOCO; j < jFim; ++j) {
+                    if (linha[j] != 0.0) {
+                        linhaMapa[J] = 1;
+                        break;
+                    }
+                }
+            }
+        }
+
+        //faixa de colunas que cobre todos os blocos não nulos da linha de blocos
+        int primeiro = nb, ultimo = -1;
+        for (int J = 0; J < nb; ++J) {
+            if (!linhaMapa[J]) continue;
+            if (J < primeiro) primeiro = J;
+            ultimo = J;
+        }
+        mapa->colIni[I] = (ultimo < 0) ? 0 : primeiro * TAM_BLOCO;
+        mapa->colFim[I] = (ultimo < 0) ? 0 : ((ultimo + 1) * TAM_BLOCO < n ? (ultimo + 1) * TAM_BLOCO : n);
+    }
+
+    return mapa;
+}
+
+void liberaMapaBlocos(mapaBlocos_t *mapa)
+{
+    if (!mapa) return;
+    free(mapa->naoNulo);
+    free(mapa->colIni);
+    free(mapa->colFim);
+    free(mapa);
+}
+
+//início e tamanho do bloco B (o último pode ser menor que TAM_BLOCO)
+static inline int tamBloco(int B, int n, int *inicio)
+{
+    *inicio = B * TAM_BLOCO;
+    return (*inicio + TAM_BLOCO <= n) ? TAM_BLOCO : n - *inicio;
+}
+
+void syrkDensa(const real_t *A, int n, const mapaBlocos_t *mapa, real_t *C)
+{
+    const int nb = mapa->nb;
+    const unsigned char *nz = mapa->naoNulo;
+    const int nPares = nb * (nb + 1) / 2;
+
+    #pragma omp parallel
+    {
+        //acumulador do bloco C(I, J), privado da thread
+        real_t bloco[TAM_BLOCO * TAM_BLOCO] __attribute__((aligned(64)));
+
+        //pares perto da diagonal custam mais que os distantes (quase sempre nulos): dynamic
+        #pragma omp for schedule(dynamic, 16)
+        for (int par = 0; par < nPares; ++par) {
+            //par -> (I, J), J >= I, triângulo superior por linhas
+            int I = 0, resto = par;
+            while (resto >= nb - I) {
+                resto -= nb - I;
+                I++;
+            }
+            int J = I + resto;
+
+            int i0, j0;
+            int ni = tamBloco(I, n, &i0);
+            int nj = tamBloco(J, n, &j0);
+            int contribuiu = 0;
+
+            //C(I, J) = sum_K A(K, I)^T A(K, J), K crescente
+            for (int K = 0; K < nb; ++K) {
+                if (!nz[(size_t) K * nb + I] || !nz[(size_t) K * nb + J]) continue;
+                if (!contribuiu) {
+                    memset(bloco, 0, sizeof(bloco));
+                    contribuiu = 1;
+                }
+
+                int k0;
+                int nk = tamBloco(K, n, &k0);
+                for (int kk = k0; kk < k0 + nk; ++kk) {
+                    const real_t *linha = &A[(size_t) kk * n];
+                    const real_t *linhaJ = &linha[j0];
+                    for (int ii = 0; ii < ni; ++ii) {
+                        real_t a = linha[i0 + ii];
+                        if (a == 0.0) continue; // a * x = 0 não muda a soma
+                        real_t *c = &bloco[ii * TAM_BLOCO];
+                        #pragma omp simd
+                        for (int jj = 0; jj < nj; ++jj) c[jj] += a * linhaJ[jj];
+                    }
+                }
+            }
+
+            //bloco nulo (a maioria, numa matriz em banda): só zera C(I, J) e C(J, I)
+            if (!contribuiu) {
+                for (int ii = 0; ii < ni; ++ii) memset(&C[(size_t) (i0 + ii) * n + j0], 0, nj * sizeof(real_t));
+                if (I != J)
+                    for (int jj = 0; jj < nj; ++jj) memset(&C[(size_t) (j0 + jj) * n + i0], 0, ni * sizeof(real_t));
+                continue;
+            }
+
+            //grava C(I, J) e o espelho C(J, I), este linha a linha (escrita contígua)
+            for (int ii = 0; ii < ni; ++ii)
+                memcpy(&C[(size_t) (i0 + ii) * n + j0], &bloco[ii * TAM_BLOCO], nj * sizeof(real_t));
+            if (I != J) {
+                for (int jj = 0; jj < nj; ++jj) {
+                    real_t *destino = &C[(size_t) (j0 + jj) * n + i0];
+                    for (int ii = 0; ii < ni; ++ii) destino[ii] = bloco[ii * TAM_BLOCO + jj];
+                }
+            }
+        }
+    }
+}
+
+void gemvTDensa(const real_t *A, const real_t *x, int n, const mapaBlocos_t *mapa, real_t *y)
+{
+    const int nb = mapa->nb;
+
+    //cada thread é dona de um bloco de y: percorre as linhas de A dentro dele
+    #pragma omp parallel for schedule(static)
+    for (int I = 0; I < nb; ++I) {
+        int i0;
+        int ni = tamBloco(I, n, &i0);
+        real_t *yI = &y[i0];
+        for (int ii = 0; ii < ni; ++ii) yI[ii] = 0.0;
+
+        for (int K = 0; K < nb; ++K) {
+            if (!mapa->naoNulo[(size_t) K * nb + I]) continue;
+
+            int k0;
+            int nk = tamBloco(K, n, &k0);
+            for (int kk = k0; kk < k0 + nk; ++kk) {
+                real_t xk = x[kk];
+                const real_t *linha = &A[(size_t) kk * n + i0];
+                #pragma omp simd
+                for (int ii = 0; ii < ni; ++ii) yI[ii] += xk * linha[ii];
+            }
+        }
+    }
+}
+
+void gemvDensa(const real_t *A, const real_t *x, int n, const mapaBlocos_t *mapa, real_t *y)
+{
+    const int nb = (n + TAM_BLOCO - 1) / TAM_BLOCO;
+
+    #pragma omp parallel for schedule(static)
+    for (int I = 0; I < nb; ++I) {
+        int i0;
+        int ni = tamBloco(I, n, &i0);
+
+        //só a faixa de colunas com blocos não nulos (a banda, no caso k-diagonal)
+        int jIni = mapa ? mapa->colIni[I] : 0;
+        int jFim = mapa ? mapa->colFim[I] : n;
+
+        for (int i = i0; i < i0 + ni; ++i) {
+            const real_t *linha = &A[(size_t) i * n];
+            real_t soma = 0.0;
+            #pragma omp simd reduction(+:soma)
+            for (int j = jIni; j < jFim; ++j) soma += linha[j] * x[j];
+            y[i] = soma;
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef __DENSA_H__
+#define __DENSA_H__
+
+#include "utils.h"
+
+// Lado dos blocos (tiles) das operações densas: um bloco de C (64x64 doubles,
+// 32 KiB) cabe na L1/L2 enquanto as linhas de A passam por ele
+#define TAM_BLOCO 64
+
+/**
+ * Mapa de blocos não nulos de uma matriz densa n x n (A[i*n + j]).
+ *
+ * naoNulo[I*nb + J] = 1 se o bloco (I, J) tem algum elemento diferente de zero.
+ * Para a matriz k-diagonal e para A^T A só os blocos perto da diagonal são
+ * não nulos: as operações abaixo pulam os demais e o custo cai de O(n^2) por
+ * produto (O(n^3) em A^T A) para O(n * banda).
+ */
+typedef struct {
+    int n, nb;                 // dimensão e número de blocos por lado
+    unsigned char *naoNulo;    // nb * nb
+    int *colIni, *colFim;      // por linha de blocos: colunas [colIni, colFim) cobrem os blocos não nulos
+} mapaBlocos_t;
+
+// Varre A (em paralelo) e marca os blocos não nulos
+mapaBlocos_t *criaMapaBlocos(const real_t *A, int n);
+void liberaMapaBlocos(mapaBlocos_t *mapa);
+
+/**
+ * C = A^T A (SYRK). Só os blocos C(I, J) com J >= I são calculados (C é
+ * simétrica) e espelhados; cada um acumula apenas os blocos K com A(K, I) e
+ * A(K, J) não nulos. As somas seguem k crescente, como no laço i/j/k original,
+ * então o resultado é o mesmo. Paralelo (OpenMP) sobre os pares de blocos.
+ */
+void syrkDensa(const real_t *A, int n, const mapaBlocos_t *mapa, real_t *C);
+
+// y = A^T x, percorrendo as linhas de A (acesso contíguo) e pulando blocos nulos
+void gemvTDensa(const real_t *A, const real_t *x, int n, const mapaBlocos_t *mapa, real_t *y);
+
+// y = A x por faixas de TAM_BLOCO linhas (uma por thread); mapa NULL = todos os blocos
+void gemvDensa(const real_t *A, const real_t *x, int n, const mapaBlocos_t *mapa, real_t *y);
+
+#endif // __DENSA_H__
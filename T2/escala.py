@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+import csv
+import os
+import statistics
+import subprocess
+import sys
+
+# ==============================================================================
+# CONFIGURAÇÕES
+# ==============================================================================
+# 'make escala': escalabilidade do cgSolver em threads, n e k. Três varreduras:
+#   forte: n fixo (TAMANHOS_FORTE), 1 a N threads
+#   fraca: n = LINHAS_POR_THREAD * threads
+#   k:     número de diagonais (KS), com o cgSolver do T1 (raiz do repositório), o
+#          único que lê k: no T2 k = 7 é fixo (N_DIAG em sislin.h)
+# Cada ponto é a mediana de REPETICOES execuções; tudo vai para um CSV (ARQ_SAIDA)
+# que o plot.py da raiz desenha em 'graficos_escala.png'.
+# Todas as listas podem ser trocadas pelo ambiente (valores separados por espaço),
+# p.ex. ESCALA_THREADS="1 2 4 8 16" ESCALA_FORTE="1000000 10000000" make escala
+EXECUTAVEL_T2 = './cgSolver'
+EXECUTAVEL_T1 = '../cgSolver'
+ARQ_SAIDA = os.environ.get('ESCALA_ARQ', '../resultadosEscala/escala.csv')
+REPETICOES = int(os.environ.get('ESCALA_REPETICOES', '3'))
+
+# Parâmetros do problema (os do exec.sh)
+K_T2 = 7
+OMEGA = 0.0
+MAXIT = 25
+EPSILON = 1.0e-9
+
+
+def lista_env(nome, padrao):
+    valor = os.environ.get(nome)
+    return [int(float(v)) for v in valor.split()] if valor else padrao
+
+
+def threads_padrao():
+    """1, 2, 4, ... até o número de CPUs (que sempre entra)."""
+    cpus = os.cpu_count() or 1
+    lista, t = [], 1
+    while t < cpus:
+        lista.append(t)
+        t *= 2
+    return lista + [cpus]
+
+
+THREADS = lista_env('ESCALA_THREADS', threads_padrao())
+# Em cache (L2/L3) e na DRAM
+TAMANHOS_FORTE = lista_env('ESCALA_FORTE', [65536, 1048576, 8388608])
+LINHAS_POR_THREAD = lista_env('ESCALA_FRACA', [1048576])
+# O T1 guarda A densa (n^2 reais, duas cópias): n pequeno
+KS = lista_env('ESCALA_K', [3, 5, 7, 9, 11])
+N_K = int(os.environ.get('ESCALA_N_K', '4000'))
+
+# Tráfego mínimo por linha e iteração do PCG (bytes): a soma dos núcleos do
+# microbench, cada diagonal/vetor lido ou escrito uma vez por núcleo. SpMV k + 2,
+# p.Ap 2, x/r + ||r|| 6, z = r/M + r.z 3 e p = z + b p 3. Só vale para o T2: o T1
+# percorre A densa (blocos n x n), cujo tráfego não é esse, e fica com banda_GBs vazio.
+def bytes_por_linha(k):
+    return 8 * (k + 16)
+
+
+CAMPOS = ['varredura', 'solver', 'threads', 'n', 'k', 'repeticoes',
+          'iteracao_ms', 'residuo_ms', 'speedup', 'eficiencia', 'banda_GBs']
+
+
+# ==============================================================================
+# MEDIÇÃO
+# ==============================================================================
+def executa(solver, n, k, threads):
+    """Uma execução; devolve (ms por iteração, ms do resíduo)."""
+    if solver == 'T2':
+        cmd, entrada = [EXECUTAVEL_T2], f"{n} {OMEGA} {MAXIT} {EPSILON}\n"
+    else:
+        cmd, entrada = [EXECUTAVEL_T1], f"{n} {k} {OMEGA} {MAXIT} {EPSILON}\n"
+
+    # threads fixas em núcleos, na ordem (o que o likwid-perfctr -C faria)
+    ambiente = dict(os.environ, OMP_NUM_THREADS=str(threads), OMP_PROC_BIND='close', OMP_PLACES='cores')
+    proc = subprocess.run(cmd, input=entrada, capture_output=True, text=True, env=ambiente)
+    linhas = [l for l in proc.stdout.split('\n') if l.strip()]
+    if proc.returncode != 0 or len(linhas) < 5:
+        raise RuntimeError(f"{cmd[0]} falhou (n={n}, k={k}, {threads} threads): {proc.stdout[:200]}")
+    # as duas últimas linhas: tempo por iteração e tempo do resíduo
+    return float(linhas[-2]), float(linhas[-1])
+
+
+def mede(solver, n, k, threads):
+    iteracoes, residuos = [], []
+    for _ in range(REPETICOES):
+        t_iter, t_res = executa(solver, n, k, threads)
+        iteracoes.append(t_iter)
+        residuos.append(t_res)
+    return statistics.median(iteracoes), statistics.median(residuos)
+
+
+def ponto(varredura, solver, n, k, threads, t_iter, t_res, referencia):
+    """Linha do CSV. referencia: ms por iteração com 1 thread (ou None).
+    forte: speedup = t1 / tp e eficiência = speedup / p; fraca: eficiência = t1 / tp
+    (o trabalho cresce com p) e o speedup é o de throughput, p * t1 / tp."""
+    speedup = eficiencia = ''
+    if referencia and t_iter > 0:
+        if varredura == 'fraca':
+            eficiencia = referencia / t_iter
+            speedup = threads * eficiencia
+        else:
+            speedup = referencia / t_iter
+            eficiencia = speedup / threads
+    banda = bytes_por_linha(k) * n / (t_iter * 1e-3) / 1e9 if solver == 'T2' and t_iter > 0 else ''
+    return {'varredura': varredura, 'solver': solver, 'threads': threads, 'n': n, 'k': k,
+            'repeticoes': REPETICOES, 'iteracao_ms': t_iter, 'residuo_ms': t_res,
+            'speedup': speedup, 'eficiencia': eficiencia, 'banda_GBs': banda}
+
+
+def varre(varredura, solver, tamanhos, k, escritor):
+    """tamanhos(threads) -> n; a referência é a execução com 1 thread de cada série."""
+    series = {}
+    for p in THREADS:
+        n = tamanhos(p)
+        t_iter, t_res = mede(solver, n, k, p)
+        chave = n if varredura != 'fraca' else None
+        if p == 1:
+            series[chave] = t_iter
+        linha = ponto(varredura, solver, n, k, p, t_iter, t_res, series.get(chave))
+        escritor.writerow(linha)
+        print(f"{varredura:6s} {solver} k={k:<3d} n={n:<10d} {p:3d} threads: {t_iter:10.4f} ms/iter"
+              + (f"  speedup {linha['speedup']:.2f}  eficiência {linha['eficiencia']:.2f}" if linha['speedup'] != '' else '')
+              + (f"  {linha['banda_GBs']:.2f} GB/s" if linha['banda_GBs'] != '' else ''), flush=True)
+
+
+# ==============================================================================
+# PRINCIPAL
+# ==============================================================================
+def main():
+    if not os.path.exists(EXECUTAVEL_T2):
+        print(f"ERRO: {EXECUTAVEL_T2} não encontrado (rode 'make')")
+        return 1
+    if 1 not in THREADS:
+        print("AVISO: sem 1 thread na lista, speedup e eficiência ficam em branco")
+
+    os.makedirs(os.path.dirname(ARQ_SAIDA) or '.', exist_ok=True)
+    with open(ARQ_SAIDA, 'w', newline='') as f:
+        escritor = csv.DictWriter(f, fieldnames=CAMPOS)
+        escritor.writeheader()
+        try:
+            for n in TAMANHOS_FORTE:
+                varre('forte', 'T2', lambda p: n, K_T2, escritor)
+            for linhas in LINHAS_POR_THREAD:
+                varre('fraca', 'T2', lambda p: linhas * p, K_T2, escritor)
+            if not os.path.exists(EXECUTAVEL_T1):
+                print(f"AVISO: {EXECUTAVEL_T1} não encontrado ('make' na raiz); varredura de k pulada")
+            else:
+                for k in KS:
+                    varre('k', 'T1', lambda p: N_K, k, escritor)
+        except RuntimeError as erro:
+            print(f"ERRO: {erro}")
+            return 1
+
+    print(f"Resultados em '{ARQ_SAIDA}'")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,19 +1,41 @@
 #!/bin/bash
 
 # --- Configurações Básicas ---
-EXECUTABLE="./cgSolverOld"
+EXECUTABLE="./cgSolver"
 RESULT_DIR="resultadosT1"
 LIKWID_CMD="/home/soft/likwid/bin/likwid-perfctr"
 
 # Parâmetros do Problema
-K=7              # Número de diagonais (Definido, mas não usado no input abaixo)
+K=7              # Número de diagonais: fixo no cgSolver do T2 (N_DIAG em sislin.h), fora da entrada
 MAXIT=25         # Limite de iterações
 OMEGA=0.0        # Fator de relaxamento
 EPSILON=1.0e-9   # Tolerância
 
+# CPUs usadas pelo likwid-perfctr (-C). Padrão: só o núcleo 0 (execução serial).
+# Para o solver paralelo use, p.ex., CPUS=S0:0-7 (um soquete) ou CPUS=N:0-15
+# junto com OMP_NUM_THREADS; o likwid fixa cada thread numa CPU da lista.
+CPUS=${CPUS:-0}
+
 # Definição dos Tamanhos (N)
 SIZES=(32 64 128 256 512 1000 2000 4000 8000 9000 10000 20000)
 
+# Tamanhos na DRAM: até n = 20000 as 7 diagonais (~1,1 MB) cabem na cache. Acima da
+# última cache (A, x e Ap: 72 bytes por linha) o formato dia passa a dia-fluxo (stores
+# não temporais e prefetch). Padrão: 2x e 8x a L3 desta máquina; DRAM_SIZES="..." substitui
+# (p.ex. DRAM_SIZES="10000000 100000000" para as execuções de produção)
+tamanhoL3() {
+    local t
+    t=$(cat /sys/devices/system/cpu/cpu0/cache/index3/size 2>/dev/null)
+    case "$t" in
+        *K) echo $(( ${t%K} * 1024 )) ;;
+        *M) echo $(( ${t%M} * 1024 * 1024 )) ;;
+        *)  echo $(( 32 * 1024 * 1024 )) ;;  # sem L3 visível: 32 MiB
+    esac
+}
+LLC=$(tamanhoL3)
+DRAM_SIZES=${DRAM_SIZES:-"$(( 2 * LLC / 72 )) $(( 8 * LLC / 72 ))"}
+SIZES+=($DRAM_SIZES)
+
 # --- Configurações do LIKWID ---
 # Grupos de performance a serem monitorados
 GROUP_FLOPS="FLOPS_DP"
@@ -28,6 +50,14 @@ if ! command -v $LIKWID_CMD &> /dev/null; then
     exit 1
 fi
 
+# O cgSolver do T2 só resolve k = N_DIAG: outro K pediria um binário que não existe.
+# Para variar k (e threads), use 'make escala' (escala.py)
+NDIAG=$(sed -n 's/^#define N_DIAG \([0-9]*\).*/\1/p' sislin.h)
+if [ "$K" != "$NDIAG" ]; then
+    echo "ERRO: K=$K, mas o cgSolver foi compilado com N_DIAG=$NDIAG (sislin.h)."
+    exit 1
+fi
+
 # Preparação de Diretórios
 mkdir -p $RESULT_DIR/{tempo,flops,l2,mem}
 
@@ -56,9 +86,7 @@ for n in "${SIZES[@]}"; do
     echo "========================================"
     echo "Processando N = $n"
     
-    # Formatação da entrada (Stdin)
-    # Nota: A variável K foi definida mas não está sendo passada aqui.
-    # Confirme se o 'cgSolverOld' precisa ou não do K.
+    # Formatação da entrada (Stdin): n ω maxit ε (sem k; ver K acima)
     INPUT_STR="$n $OMEGA $MAXIT $EPSILON"
 
     # A. Tempo de Execução (Wall Clock interno)
@@ -67,15 +95,15 @@ for n in "${SIZES[@]}"; do
 
     # B. Operações Aritméticas (FLOPS_DP)
     echo "  [2/4] Medindo FLOPS ($GROUP_FLOPS)..."
-    echo "$INPUT_STR" | $LIKWID_CMD -C 0 -g $GROUP_FLOPS -m $EXECUTABLE > "$RESULT_DIR/flops/N_${n}.log" 2>&1
+    echo "$INPUT_STR" | $LIKWID_CMD -C $CPUS -g $GROUP_FLOPS -m $EXECUTABLE > "$RESULT_DIR/flops/N_${n}.log" 2>&1
 
     # C. Cache Miss (L2)
     echo "  [3/4] Medindo Cache L2 ($GROUP_L2)..."
-    echo "$INPUT_STR" | $LIKWID_CMD -C 0 -g $GROUP_L2 -m $EXECUTABLE > "$RESULT_DIR/l2/N_${n}.log" 2>&1
+    echo "$INPUT_STR" | $LIKWID_CMD -C $CPUS -g $GROUP_L2 -m $EXECUTABLE > "$RESULT_DIR/l2/N_${n}.log" 2>&1
 
     # D. Banda de Memória (L3/MEM)
     echo "  [4/4] Medindo Memória ($GROUP_MEM)..."
-    echo "$INPUT_STR" | $LIKWID_CMD -C 0 -g $GROUP_MEM -m $EXECUTABLE > "$RESULT_DIR/mem/N_${n}.log" 2>&1
+    echo "$INPUT_STR" | $LIKWID_CMD -C $CPUS -g $GROUP_MEM -m $EXECUTABLE > "$RESULT_DIR/mem/N_${n}.log" 2>&1
 
 done
 
@@ -83,16 +111,16 @@ done
 
 echo ""
 echo "--- 3. Resumo Preliminar (Tempo de Iteração) ---"
-echo "N     | Tempo Iteração (s)"
-echo "------|-------------------"
+echo "N         | Tempo Iteração (s)"
+echo "----------|-------------------"
 
 for n in "${SIZES[@]}"; do
     # Extração baseada na estrutura do log (Penúltima linha)
     if [ -f "$RESULT_DIR/tempo/N_${n}.log" ]; then
         TIME_VAL=$(grep -v "Nao calculado" "$RESULT_DIR/tempo/N_${n}.log" | tail -n 2 | head -n 1)
-        printf "%-5d | %s\n" "$n" "$TIME_VAL"
+        printf "%-9d | %s\n" "$n" "$TIME_VAL"
     else
-        printf "%-5d | Erro/Log ausente\n" "$n"
+        printf "%-9d | Erro/Log ausente\n" "$n"
     fi
 done
 
@@ -0,0 +1,80 @@
+#!/bin/bash
+
+# --- Configurações Básicas ---
+EXECUTABLE="./cgSolverMPI"
+RESULT_DIR="resultadosMPI"
+MPIRUN="${MPIRUN:-mpirun}"
+# Em uma única máquina com poucos núcleos: MPI_FLAGS="--oversubscribe"
+MPI_FLAGS="${MPI_FLAGS:-}"
+
+# Parâmetros do Problema
+MAXIT=25         # Limite de iterações
+OMEGA=0.0        # Fator de relaxamento
+EPSILON=1.0e-9   # Tolerância
+
+# Escalabilidade forte: N fixo, aumenta o número de processos
+N_FORTE=4000000
+# Escalabilidade fraca: N cresce junto com o número de processos
+N_POR_PROC=1000000
+
+PROCS=(1 2 4)
+THREADS=${OMP_NUM_THREADS:-1}   # threads OpenMP por processo (MPI + threads)
+
+# --- Verificação de Ambiente ---
+if ! command -v $MPIRUN &> /dev/null; then
+    echo "ERRO: $MPIRUN não encontrado."
+    exit 1
+fi
+
+mkdir -p $RESULT_DIR/{forte,fraca}
+
+# --- 1. Compilação do Projeto ---
+echo "--- 1. Compilando (MPI + OpenMP) ---"
+rm -f $EXECUTABLE
+make mpi
+if [ $? -ne 0 ]; then
+    echo "ERRO: Falha na compilação via Makefile."
+    exit 1
+fi
+
+# Tempo por iteração (ms): penúltima linha da saída
+tempo_iter() {
+    tail -n 2 "$1" | head -n 1
+}
+
+# --- 2. Execução ---
+for np in "${PROCS[@]}"; do
+    echo "========================================"
+    echo "Processos = $np, threads/processo = $THREADS"
+
+    echo "  [forte] N = $N_FORTE"
+    echo "$N_FORTE $OMEGA $MAXIT $EPSILON" | OMP_NUM_THREADS=$THREADS \
+        $MPIRUN $MPI_FLAGS -np $np $EXECUTABLE > "$RESULT_DIR/forte/P_${np}.log"
+
+    n=$((N_POR_PROC * np))
+    echo "  [fraca] N = $n"
+    echo "$n $OMEGA $MAXIT $EPSILON" | OMP_NUM_THREADS=$THREADS \
+        $MPIRUN $MPI_FLAGS -np $np $EXECUTABLE > "$RESULT_DIR/fraca/P_${np}.log"
+done
+
+# --- 3. Relatório ---
+# Forte: speedup = T1/Tp, eficiência = speedup/p
+# Fraca: eficiência = T1/Tp (o ideal é tempo constante)
+echo ""
+echo "--- 3. Escalabilidade (tempo por iteração em ms) ---"
+printf "%-5s | %-12s %-8s %-8s | %-12s %-8s\n" "P" "Forte (ms)" "Speedup" "Efic." "Fraca (ms)" "Efic."
+echo "------|--------------------------------|---------------------"
+
+T1_FORTE=$(tempo_iter "$RESULT_DIR/forte/P_1.log")
+T1_FRACA=$(tempo_iter "$RESULT_DIR/fraca/P_1.log")
+
+for np in "${PROCS[@]}"; do
+    TF=$(tempo_iter "$RESULT_DIR/forte/P_${np}.log")
+    TW=$(tempo_iter "$RESULT_DIR/fraca/P_${np}.log")
+    awk -v p=$np -v t1=$T1_FORTE -v tp=$TF -v w1=$T1_FRACA -v wp=$TW 'BEGIN {
+        printf "%-5d | %-12.6g %-8.3f %-8.3f | %-12.6g %-8.3f\n", p, tp, t1/tp, t1/tp/p, wp, w1/wp
+    }'
+done
+
+echo ""
+echo "Benchmark finalizado."
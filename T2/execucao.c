@@ -0,0 +1,719 @@
+#include "execucao.h"
+#include "sislin.h"
+#include "topologia.h"
+#include "pipeline.h"
+#include "nucleos.h"
+#include "checkpoint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+//Uma arena (alinhada, com páginas enormes quando possível) para A e ASP
+//(layout V2: n*k), b, x, bsp, D, L, U, M e D^1/2 (-d). A memória já vem zerada.
+//As diagonais são tocadas por linhas: cada thread recebe as suas em todas elas.
+static int criaSistema(const execucao_t *e, sistema_t *s)
+{
+    int n = e->n, k = e->k;
+    memset(s, 0, sizeof(*s));
+
+    size_t bytesArena = 2 * tamanhoVetorArena((size_t) n * k) + (e->escala ? 8 : 7) * tamanhoVetorArena(n);
+    s->arena = criaArena(bytesArena, ARENA_PAGINAS_ENORMES | ARENA_PRIMEIRO_TOQUE);
+    if (!s->arena) {
+        printf("Erro de alocação de memória (arena de %zu bytes)\n", bytesArena);
+        return -1;
+    }
+
+    s->A = arenaDiagonais(s->arena, n, k);
+    s->b = arenaVetor(s->arena, n);
+    s->x = arenaVetor(s->arena, n); //vetor de solução x inicializado com 0
+
+    // ASP e bsp para o sistema simétrico positivo
+    s->ASP = arenaDiagonais(s->arena, n, k);
+    s->bsp = arenaVetor(s->arena, n);
+
+    s->D = arenaVetor(s->arena, n);
+    s->L = arenaVetor(s->arena, n);
+    s->U = arenaVetor(s->arena, n);
+
+    //vetor M que armazena o pré-condicionador
+    s->M = (e->omega != -1.0) ? arenaVetor(s->arena, n) : NULL;
+    s->raizD = e->escala ? arenaVetor(s->arena, n) : NULL;
+    return 0;
+}
+
+//Chave do cache de preparo: A gerada e os parâmetros que mudam ASP, D, M, D^1/2 e o fator
+static uint64_t chavePreparo(const execucao_t *e, const sistema_t *s)
+{
+    uint64_t chave[5] = { hashDados(s->A, (size_t) e->n * e->k * sizeof(real_t), (uint64_t) e->n << 16 | e->k), 0, 0,
+                          (uint64_t) e->escala | (uint64_t) (e->metodo == 'c' ? 'p' : e->metodo) << 8 | (uint64_t) (e->tamBloco + 1) << 16,
+                          (uint64_t) (e->tamBloco == 0 ? omp_get_max_threads() : 0) };
+    memcpy(&chave[1], &e->omega, sizeof(double));
+    memcpy(&chave[2], &e->epsilon, sizeof(double));
+    return hashDados(chave, sizeof(chave), N_DIAG);
+}
+
+//Num acerto ASP, D, M e D^1/2 passam a ser os do mapa; os da arena voltam em fechaPreparoSistema
+static void usaPreparo(sistema_t *s)
+{
+    real_t **campos[4] = { &s->ASP, &s->D, &s->M, &s->raizD };
+    real_t *mapa[4] = { s->preparo->ASP, s->preparo->D, s->preparo->M, s->preparo->raizD };
+    for (int c = 0; c < 4; c++) {
+        s->daArena[c] = *campos[c];
+        if (mapa[c]) *campos[c] = mapa[c];
+    }
+}
+
+static void fechaPreparoSistema(sistema_t *s)
+{
+    if (!s->preparo) return;
+    real_t **campos[4] = { &s->ASP, &s->D, &s->M, &s->raizD };
+    for (int c = 0; c < 4; c++) *campos[c] = s->daArena[c];
+    fechaPreparo(s->preparo);
+    s->preparo = NULL;
+}
+
+// =========== Geração do sistema ==========
+static int geraSistema(void *contexto, void *item)
+{
+    execucao_t *e = contexto;
+    sistema_t *s = item;
+    s->sis = e->proximo++;
+
+    //marca tempo de geração da matriz A e vetor b
+    rtime_t tGen = timestamp();
+
+    //chama função que cria a matriz e o vetor B
+    criaKDiagonal(e->n, e->k, s->A, s->b);
+
+    //preparo em cache (-M): ASP vem do mapa e bsp = b, como em genSimetricaPositiva
+    if (e->preparo) {
+        rtime_t t0 = timestamp();
+        s->chavePreparo = chavePreparo(e, s);
+        s->preparo = abrePreparo(e->preparo, s->chavePreparo, e->n, N_DIAG);
+        if (s->preparo) {
+            usaPreparo(s);
+            memcpy(s->bsp, s->b, e->n * sizeof(real_t));
+            s->tDLU = 0.0;
+            s->tPrecond = timestamp() - t0;
+        }
+    }
+    s->tSimetrica = 0.0;
+    if (!s->preparo) {
+        rtime_t t0 = timestamp();
+        genSimetricaPositiva(s->A, s->b, e->n, e->k, s->ASP, s->bsp, &tGen);
+        s->tSimetrica = timestamp() - t0;
+    }
+
+    //calcula o tempo gasto
+    tGen = timestamp() - tGen;
+    return 0;
+}
+
+//Ciclos estimados do PCG (2k + 13 flops por linha e iteração, como em perfcheck.py)
+//com as iterações esperadas: a média das resoluções anteriores que chegaram até s ou, sem
+//nenhuma, maxit
+static double custoPCG(const execucao_t *e, const sistema_t *s, int *iterEsperadas)
+{
+    *iterEsperadas = s->nPCG ? (s->iterPCG + s->nPCG - 1) / s->nPCG : e->maxit;
+    return (double) *iterEsperadas * e->n * (2.0 * N_DIAG + 13.0);
+}
+
+//Cholesky em banda de ASP (-m direto, ou -m auto quando compensa). Só falha com -m direto
+static int preparaDireto(const execucao_t *e, sistema_t *s)
+{
+    if (e->metodo == 'a') {
+        int iterEsperadas;
+        double pcg = custoPCG(e, s, &iterEsperadas);
+        double direto = custoFatoracaoBanda(e->n, N_DIAG) + custoSubstituicaoBanda(e->n, N_DIAG);
+        fprintf(stderr, "# método: custo estimado %.3g Mciclos direto x %.3g Mciclos PCG (%d iterações)\n",
+                direto * 1e-6, pcg * 1e-6, iterEsperadas);
+        if (direto >= pcg) return 0;
+    }
+
+    rtime_t t0 = timestamp();
+    int linha;
+    s->fator = fatoraBanda(s->ASP, e->n, N_DIAG, &linha);
+    s->tPrecond += timestamp() - t0;
+    if (s->fator) return 0;
+
+    if (linha < 0) {
+        printf("Erro de alocação de memória (fator de Cholesky)\n");
+        return -1;
+    }
+    if (e->metodo == 'd') {
+        printf("Erro: ASP não é SPD (pivô não positivo na linha %d); use -m pcg ou auto\n", linha);
+        return -1;
+    }
+    fprintf(stderr, "# método: ASP não é SPD (pivô da linha %d), PCG\n", linha);
+    return 0;
+}
+
+//z = M^-1 r dos pré-condicionadores gerais (precondicionador_t)
+static void aplicaPrecondAMG(void *dados, const real_t *r, real_t *z)
+{
+    aplicaAMG(dados, r, z);
+}
+
+static void aplicaPrecondBlocos(void *dados, const real_t *r, real_t *z)
+{
+    resolveBanda(dados, r, z);
+}
+
+//Jacobi em blocos: os blocos diagonais de ASP (com a diagonal de geraDLU), um por thread ou
+//do tamanho pedido, fatorados em paralelo. Se algum não for SPD, fica o Jacobi
+static int preparaBlocos(const execucao_t *e, sistema_t *s)
+{
+    rtime_t t0 = timestamp();
+    int linha;
+    s->blocos = fatoraBandaBlocos(s->ASP, s->D, e->n, N_DIAG, e->tamBloco, &linha);
+    s->tPrecond += timestamp() - t0;
+    if (s->blocos) {
+        fprintf(stderr, "# blocos: %d blocos de %d linhas (%.3f ms)\n", s->blocos->nBlocos,
+                s->blocos->inicioBloco[1], timestamp() - t0);
+        return 0;
+    }
+    if (linha < 0) {
+        printf("Erro de alocação de memória (Jacobi em blocos)\n");
+        return -1;
+    }
+    fprintf(stderr, "# blocos: bloco de ASP não é SPD (pivô da linha %d), Jacobi\n", linha);
+    return 0;
+}
+
+//Preparo calculado agora vai para o cache em disco (-M). O tempo evitado num acerto inclui
+//genSimetricaPositiva (ASP e bsp vêm do mapa). A hierarquia do AMG não é guardada
+//(é refeita sobre a ASP do mapa), então o seu tempo fica fora do tempo evitado
+static void gravaPreparoSistema(const execucao_t *e, const sistema_t *s, rtime_t tAMG)
+{
+    preparo_t p = { e->n, N_DIAG, s->ASP, s->D, s->M, s->raizD, FATOR_PREPARO_NENHUM, NULL,
+                    s->tSimetrica + s->tDLU + s->tPrecond - tAMG };
+    if (s->fator) {
+        p.tipoFator = FATOR_PREPARO_DIRETO;
+        p.fator = s->fator;
+    } else if (s->blocos) {
+        p.tipoFator = FATOR_PREPARO_BLOCOS;
+        p.fator = s->blocos;
+    }
+    int situacao = gravaPreparo(e->preparo, s->chavePreparo, &p);
+    if (situacao > 0)
+        fprintf(stderr, "# preparo: maior que o limite do cache, não gravado\n");
+    else if (situacao < 0)
+        fprintf(stderr, "# preparo: não foi possível gravar no cache\n");
+}
+
+// ========== Decomposição DLU e pré-condicionador ===========
+static int preparaSistema(void *contexto, void *item)
+{
+    execucao_t *e = contexto;
+    sistema_t *s = item;
+
+    if (s->preparo) {
+        //acerto: D, M, D^1/2 e ASP (já escalada) são os do mapa; só bsp é escalado
+        rtime_t t0 = timestamp();
+        if (e->escala)
+            for (int i = 0; i < e->n; ++i) s->bsp[i] /= s->raizD[i];
+        s->tPrecond += timestamp() - t0;
+        if (s->sis == 0)
+            fprintf(stderr, "# preparo: acerto (%.1f MiB mapeados; hash de A e mapa em %.3f ms; %.3f ms de preparo evitados)\n",
+                    s->preparo->bytes / (double) (1 << 20), s->tPrecond, s->preparo->tempoPreparo);
+    } else {
+        //função que gera o DLU
+        //calcula a decomposição DLU de A
+        //armazena o tempo em tDLU
+        geraDLU(s->ASP, e->n, e->k, s->D, s->L, s->U, &s->tDLU, e->epsilon);
+
+        //gera o pré-condicionador M usando D, L, U
+        //o parâmetro omega e armazena o tempo em tPrecond
+        if (s->M) geraPreCond(s->D, s->L, s->U, e->omega, e->n, e->k, s->M, &s->tPrecond, e->epsilon);
+
+        //escala simétrica com a diagonal de Jacobi (tempo somado ao do pré-condicionador)
+        if (e->escala && escalaSimetrica(s->ASP, s->bsp, e->n, e->k, s->M, s->raizD, &s->tPrecond)) {
+            printf("Erro: escala simétrica exige diagonal positiva\n");
+            return -1;
+        }
+    }
+
+    //operador usado pelo PCG (no formato dia, só aponta para ASP)
+    if (e->sintonizado)
+        s->op = criaOperadorDIASintonizado(s->ASP, e->n, &e->escolha);
+    else
+        s->op = criaOperador(e->formato, s->ASP, e->n);
+    if (!s->op) return -1;
+    if (s->sis == 0 && strcmp(s->op->formato, e->formato))
+        fprintf(stderr, "# formato: %s (A, x e Ap acima da última cache)\n", s->op->formato);
+
+    //hierarquia do AMG sobre ASP; se ela não for SPD (diagonal ou nível grosso), fica o Jacobi
+    rtime_t tAMG = 0.0;
+    if (e->amg) {
+        rtime_t t0 = timestamp();
+        int linha;
+        s->amg = criaAMG(s->ASP, e->n, N_DIAG, e->suavizador, e->passosAMG, &linha);
+        tAMG = timestamp() - t0;
+        s->tPrecond += tAMG;
+        if (s->amg) {
+            descreveAMG(s->amg, stderr);
+        } else if (linha < 0) {
+            printf("Erro de alocação de memória (AMG)\n");
+            return -1;
+        } else {
+            fprintf(stderr, "# amg: ASP não é SPD (pivô da linha %d de um nível), Jacobi\n", linha);
+        }
+    }
+
+    //fator do mapa: a escolha do -m auto e as quedas para o Jacobi/PCG também vêm do preparo gravado
+    if (s->preparo) {
+        if (s->preparo->tipoFator == FATOR_PREPARO_DIRETO) s->fator = fatorPreparo(s->preparo);
+        if (s->preparo->tipoFator == FATOR_PREPARO_BLOCOS) s->blocos = fatorPreparo(s->preparo);
+        if (s->preparo->tipoFator != FATOR_PREPARO_NENHUM && !s->fator && !s->blocos) {
+            printf("Erro de alocação de memória (fator do preparo)\n");
+            return -1;
+        }
+    } else if (e->tamBloco >= 0 && preparaBlocos(e, s)) {
+        return -1;
+    }
+
+    if (s->amg) s->precond = (precondicionador_t) { aplicaPrecondAMG, s->amg };
+    else if (s->blocos) s->precond = (precondicionador_t) { aplicaPrecondBlocos, s->blocos };
+
+    //fatoração no preparo: no pipeline, sobrepõe-se ao PCG/substituição do SL anterior
+    if (!s->preparo && (e->metodo == 'd' || e->metodo == 'a') && preparaDireto(e, s)) return -1;
+
+    if (e->preparo && !s->preparo) gravaPreparoSistema(e, s, tAMG);
+    return 0;
+}
+
+//M passado ao PCG: com a escala simétrica o sistema já está pré-condicionado e com o AMG
+//ou o Jacobi em blocos z sai de s->precond
+static inline real_t *precondPCG(const execucao_t *e, const sistema_t *s)
+{
+    return (e->escala || s->amg || s->blocos) ? NULL : s->M;
+}
+
+//PCG numa outra precisão (-t): ASP, bsp, M e x convertidos para T e x de volta para real_t.
+//cgDIA escolhe a instância dos núcleos pelo tipo de A
+#define RESOLVE_PRECISAO(SUF, T) \
+static int resolve_##SUF(const execucao_t *e, sistema_t *s) \
+{ \
+    int n = e->n; \
+    T *A = malloc((size_t) N_DIAG * n * sizeof(T)); \
+    T *b = malloc(n * sizeof(T)); \
+    T *x = malloc(n * sizeof(T)); \
+    const real_t *Ms = precondPCG(e, s); \
+    T *M = Ms ? malloc(n * sizeof(T)) : NULL; \
+    if (!A || !b || !x || (Ms && !M)) { \
+        printf("Erro de alocação de memória (PCG em " #T ")\n"); \
+        free(A); free(b); free(x); free(M); \
+        return -1; \
+    } \
+    for (size_t i = 0; i < (size_t) N_DIAG * n; ++i) A[i] = s->ASP[i]; \
+    for (int i = 0; i < n; ++i) { \
+        b[i] = s->bsp[i]; \
+        x[i] = s->x[i]; \
+        if (M) M[i] = Ms[i]; \
+    } \
+\
+    T normaFinal = 0; \
+    s->tempoIter = timestamp(); \
+    s->iter = cgDIA(A, b, x, n, e->maxit, (T) e->epsilon, M, &normaFinal, e->controle.trabalho); \
+    s->tempoIter = (s->iter > 0) ? (timestamp() - s->tempoIter) / s->iter : 0.0; \
+    s->normaFinal = normaFinal; \
+    for (int i = 0; i < n; ++i) s->x[i] = x[i]; \
+\
+    free(A); free(b); free(x); free(M); \
+    return 0; \
+}
+
+RESOLVE_PRECISAO(f, float)
+RESOLVE_PRECISAO(ld, long double)
+
+//lambda_min, lambda_max e kappa de M^-1 A pelos coeficientes do último PCG; com -m cheb, o
+//intervalo do Chebyshev (lambdaMax com folga). Sem estimativa, -m cheb fica no PCG (lambdaMax < 0)
+static void estimaIntervalo(execucao_t *e)
+{
+    real_t lambdaMin, lambdaMax;
+    if (estimaEspectro(&e->espectro, &lambdaMin, &lambdaMax) || !(lambdaMin > 0.0)) {
+        fprintf(stderr, "# espectro: sem estimativa em %d iterações (A ou M não SPD?)%s\n", e->espectro.nCoef,
+                e->metodo == 'c' ? ", PCG" : "");
+        if (e->metodo == 'c') e->lambdaMax = -1.0;
+        return;
+    }
+    fprintf(stderr, "# espectro: lambda_min %.6g, lambda_max %.6g, kappa %.6g (Ritz de %d iterações do PCG)\n",
+            lambdaMin, lambdaMax, lambdaMax / lambdaMin, e->espectro.nCoef);
+    if (e->metodo == 'c') {
+        e->lambdaMin = lambdaMin;
+        e->lambdaMax = FOLGA_LAMBDA_MAX * lambdaMax;
+    }
+}
+
+//Arena dos vetores do PCG (e->controle.trabalho), criada no primeiro SL resolvido e
+//reaproveitada pelos seguintes: sem mmap, primeiro toque nem zeragem por resolução.
+//Do tamanho do maior uso: PCG/Chebyshev em double ou cgDIA na precisão de -t
+static int criaTrabalhoPCG(execucao_t *e, const sistema_t *s)
+{
+    if (e->controle.trabalho) return 0;
+    size_t bytes = bytesTrabalhoPCG(e->n, margemOperador(s->op), e->controle.reprodutivel);
+    size_t bytesNucleo = BYTES_TRABALHO_CG_DIA(e->n, e->precisao == 'l' ? sizeof(long double) : sizeof(float));
+    if (e->precisao != 'd' && bytesNucleo > bytes) bytes = bytesNucleo;
+
+    e->controle.trabalho = criaArena(bytes, ARENA_PAGINAS_ENORMES | ARENA_PRIMEIRO_TOQUE);
+    if (!e->controle.trabalho) {
+        printf("Erro de alocação de memória (vetores do PCG)\n");
+        return -1;
+    }
+    return 0;
+}
+
+// ========== Execução do método PCG ===========
+static int resolveSistema(void *contexto, void *item)
+{
+    execucao_t *e = contexto;
+    sistema_t *s = item;
+    int n = e->n;
+
+    //critério do teste de parada: o de -p só em gradienteConjugadoControle; os outros PCGs usam ||r|| < eps
+    const int criterio = (e->S || e->precisao != 'd') ? CRITERIO_RESIDUO_ABS : (int) e->controle.criterio;
+    int convergiu = 0;
+
+    //palpite inicial: solução em cache > arquivo x0 > solução mais próxima em cache > 0
+    uint64_t hashA = 0, hashB = 0;
+    int situacao = CACHE_AUSENTE;
+    if (e->cache) {
+        rtime_t tHash = timestamp();
+        hashSistema(s->ASP, s->bsp, n, N_DIAG, &hashA, &hashB);
+        situacao = buscaCache(e->cache, hashA, hashB, s->bsp, n, criterio, e->epsilon, s->x, &s->normaFinal);
+        fprintf(stderr, "# cache: %s (%.3f ms)\n", situacao == CACHE_EXATO ? "acerto exato" :
+                situacao == CACHE_PROXIMO ? "partida da solução mais próxima" : "ausente", timestamp() - tHash);
+    }
+    if (situacao != CACHE_EXATO && e->arqX0) {
+        if (leVetorInicial(e->arqX0, s->x, n)) return -1;
+    } else if (situacao == CACHE_AUSENTE) {
+        for (int i = 0; i < n; ++i) s->x[i] = 0.0;
+    }
+
+    //palpite no sistema escalado: y = D^1/2 x
+    const int escalado = e->escala && situacao != CACHE_EXATO;
+    if (escalado)
+        for (int i = 0; i < n; ++i) s->x[i] *= s->raizD[i];
+
+    if (situacao != CACHE_EXATO && !s->fator && !e->S && criaTrabalhoPCG(e, s)) return -1;
+
+    //mede o tempo de execução do GCG
+    //executa o pcg
+    if (situacao == CACHE_EXATO) {
+        //mesmo SL já resolvido: a resolução é pulada
+        s->iter = 0;
+        s->tempoIter = 0.0;
+    } else if (s->fator) {
+        //direto: as duas substituições (tempoIter); a fatoração está em tPrecond
+        rtime_t tNorma;
+        s->iter = 0;
+        s->tempoIter = timestamp();
+        resolveBanda(s->fator, s->bsp, s->x);
+        s->tempoIter = timestamp() - s->tempoIter;
+        s->normaFinal = calcResiduoSL(s->ASP, s->bsp, s->x, n, N_DIAG, &tNorma);
+    } else if (e->precisao != 'd') {
+        if ((e->precisao == 'f' ? resolve_f(e, s) : resolve_ld(e, s))) return -1;
+        convergiu = s->normaFinal < e->epsilon;
+    } else if (e->S) {
+        s->iter = gradienteConjugadoDeflacionado(s->op, s->bsp, s->x, e->maxit, e->epsilon, precondPCG(e, s), e->S,
+                                                 &s->normaFinal, &s->tempoIter);
+        convergiu = s->normaFinal < e->epsilon;
+    } else {
+        //com a escala, ||D^1/2 r_y|| é o resíduo do sistema original: mesmo critério do Jacobi
+        motivoParada_t motivo;
+        controleConvergencia_t controle = e->controle;
+        controle.pesoResiduo = s->raizD;
+        if (s->amg || s->blocos) controle.precond = &s->precond;
+
+        //o arquivo só é retomado pelo mesmo SL com os mesmos parâmetros do PCG
+        if (e->arqCheckpoint) {
+            if (!e->cache) hashSistema(s->ASP, s->bsp, n, N_DIAG, &hashA, &hashB);
+            uint64_t precond = s->amg ? (uint64_t) (1 + e->suavizador) << 8 | (uint64_t) e->passosAMG << 16 :
+                               s->blocos ? (uint64_t) 3 << 8 | (uint64_t) s->blocos->nBlocos << 16 : 0;
+            uint64_t chave[4] = { hashA, hashB, 0, (uint64_t) e->escala | (uint64_t) e->controle.reprodutivel << 1 | precond };
+            memcpy(&chave[2], &e->omega, sizeof(double));
+            controle.checkpoint = abreCheckpoint(e->arqCheckpoint, n,
+                                                 hashDados(chave, sizeof(chave), (uint64_t) e->maxit), e->intervaloCheckpoint);
+            if (!controle.checkpoint) return -1;
+        }
+
+        //-m cheb: o PCG só até estimar o intervalo (no primeiro SL) e o Chebyshev no resto das iterações
+        const int chebyshev = (e->metodo == 'c');
+        if (chebyshev && e->lambdaMax > 0.0) {
+            s->iter = 0;
+            s->tempoIter = 0.0;
+        } else {
+            int maxit = (chebyshev && !e->lambdaMax && e->iterEspectro < e->maxit) ? e->iterEspectro : e->maxit;
+            if (chebyshev || e->relataParada) controle.espectro = &e->espectro;
+            s->iter = gradienteConjugadoControle(s->op, s->bsp, s->x, maxit, e->epsilon, precondPCG(e, s), &controle,
+                                                 &motivo, &s->normaFinal, &s->tempoIter);
+            if (s->iter > 0 && controle.espectro && (!chebyshev || !e->lambdaMax)) estimaIntervalo(e);
+            controle.espectro = NULL;
+
+            //sem intervalo, o PCG continua (recomeçando do x atual)
+            if (chebyshev && e->lambdaMax < 0.0 && motivo == PARADA_MAXIT && s->iter >= 0 && s->iter < e->maxit) {
+                rtime_t tempoIter;
+                int iter = gradienteConjugadoControle(s->op, s->bsp, s->x, e->maxit - s->iter, e->epsilon,
+                                                      precondPCG(e, s), &controle, &motivo, &s->normaFinal, &tempoIter);
+                if (iter > 0) {
+                    s->tempoIter = (s->tempoIter * s->iter + tempoIter * iter) / (s->iter + iter);
+                    s->iter += iter;
+                }
+            }
+        }
+
+        //divergência: lambdaMax de Ritz abaixo do maior autovalor; o intervalo dobra e o Chebyshev
+        //continua do x atual (vale para os SLs seguintes)
+        int faseChebyshev = chebyshev && e->lambdaMax > 0.0 && s->iter >= 0 && (s->iter == 0 || motivo == PARADA_MAXIT);
+        while (faseChebyshev && s->iter < e->maxit) {
+            //tempoIter é a média das fases
+            rtime_t tempoIter;
+            int iter = iteracaoChebyshev(s->op, s->bsp, s->x, e->maxit - s->iter, e->epsilon, precondPCG(e, s),
+                                         e->lambdaMin, e->lambdaMax, &controle, &motivo, &s->normaFinal, &tempoIter);
+            if (iter < 0) {
+                printf("Erro de alocação de memória (Chebyshev)\n");
+                return -1;
+            }
+            if (s->sis == 0 || motivo == PARADA_DIVERGIU)
+                fprintf(stderr, "# chebyshev: intervalo [%.6g, %.6g], %d iterações com %d reduções do critério%s\n",
+                        e->lambdaMin, e->lambdaMax, iter, iter / controle.intervalo + (iter % controle.intervalo != 0),
+                        motivo == PARADA_DIVERGIU ? ", divergiu: lambda_max dobra" : "");
+            if (iter > 0) {
+                s->tempoIter = (s->tempoIter * s->iter + tempoIter * iter) / (s->iter + iter);
+                s->iter += iter;
+            }
+            faseChebyshev = (motivo == PARADA_DIVERGIU);
+            if (faseChebyshev) e->lambdaMax *= 2.0;
+        }
+
+        convergiu = (motivo == PARADA_CONVERGIU);
+        if (e->relataParada)
+            fprintf(stderr, "# parada: %s após %d iterações\n", descreveParada(motivo), s->iter);
+
+        if (controle.checkpoint) {
+            encerraCheckpoint(controle.checkpoint, s->iter >= 0);
+            relatorioCheckpoint(controle.checkpoint, s->tempoIter * s->iter, stderr);
+            liberaCheckpoint(controle.checkpoint);
+        }
+    }
+
+    //de volta ao sistema original: x = D^-1/2 y
+    if (escalado)
+        for (int i = 0; i < n; ++i) s->x[i] /= s->raizD[i];
+
+    //só x que passou no teste de parada pode ser acerto exato depois (o direto, com eps 0, em qualquer critério)
+    if (e->cache && situacao != CACHE_EXATO)
+        insereCache(e->cache, hashA, hashB, s->bsp, s->x, n, s->normaFinal,
+                    s->fator ? criterio : convergiu ? criterio : CACHE_NAO_CONVERGIU, s->fator ? 0.0 : e->epsilon);
+
+    if (s->sis == 0) e->iterPrimeiro = s->iter;
+    e->iterTotal += s->iter;
+    if (situacao != CACHE_EXATO && !s->fator) {
+        e->iterPCG += s->iter;
+        e->nPCG++;
+    }
+    s->iterPCG = e->iterPCG;
+    s->nPCG = e->nPCG;
+    return 0;
+}
+
+// =========== Cálculo do resíduo e impressão dos resultados ==========
+static int escreveSistema(void *contexto, void *item)
+{
+    execucao_t *e = contexto;
+    sistema_t *s = item;
+    int n = e->n;
+
+    //calcula a norma resíduo com os valores de A e x obtidos, antes de a escritora disputar
+    //a banda de memória formatando x (senão o tempo do resíduo mede as duas coisas)
+    s->norma_residuo = calcResiduoSL(s->A, s->b, s->x, n, e->k, &s->tResiduo);
+
+    //x vai para a escritora, que o formata enquanto os buffers são liberados
+    printfSaida(e->saida, "%d\n", n);
+    vetorSaida(e->saida, s->x, n);
+
+    liberaOperador(s->op);
+    s->op = NULL;
+    liberaFatorBanda(s->fator);
+    s->fator = NULL;
+    liberaAMG(s->amg);
+    s->amg = NULL;
+    liberaFatorBanda(s->blocos);
+    s->blocos = NULL;
+    fechaPreparoSistema(s);
+
+    printfSaida(e->saida, "%.8g\n", s->normaFinal);
+    printfSaida(e->saida, "%.16g\n", s->norma_residuo);
+    s->tPrecond == 0.0 ? printfSaida(e->saida, "Nao calculado\n") : printfSaida(e->saida, "%.8g\n", s->tPrecond);
+    printfSaida(e->saida, "%.8g\n", s->tempoIter);
+    printfSaida(e->saida, "%.8g\n", s->tResiduo);
+    fechaRegistroSaida(e->saida);
+    // printf("Iterações: %d\n", iter);
+
+    if (e->nSistemas > 1 && e->S)
+        fprintf(stderr, "# sistema %d: %d iterações (%d a menos que o primeiro)\n", s->sis, s->iter, e->iterPrimeiro - s->iter);
+    else if (e->nSistemas > 1)
+        fprintf(stderr, "# sistema %d: %d iterações\n", s->sis, s->iter);
+    return 0;
+}
+
+void execucaoPadrao(execucao_t *e)
+{
+    memset(e, 0, sizeof(*e));
+    e->nSistemas = 1; // sistemas resolvidos em sequência
+    e->k = 7;         // número de diagonais da matriz >1 e ímpar
+    e->controle = CONTROLE_PADRAO; // critério de parada do PCG
+    e->formato = "dia"; // formato de armazenamento de A no PCG
+    e->precisao = 'd'; // tipo das contas do PCG
+    e->metodo = 'p'; // PCG (-m direto|auto: Cholesky em banda)
+    e->tamBloco = -1; // sem Jacobi em blocos
+    e->iterEspectro = ITER_ESPECTRO; // -m cheb: iterações do PCG que estimam o intervalo
+    e->limitePreparo = (size_t) LIMITE_PREPARO_MIB << 20;
+}
+
+int abreExecucao(execucao_t *e)
+{
+    //alpha/beta de até maxit iterações (dois escalares por iteração)
+    if (e->metodo == 'c' || e->relataParada) {
+        e->espectro.maxCoef = e->maxit;
+        e->espectro.alphas = malloc(e->maxit * sizeof(real_t));
+        e->espectro.betas = malloc(e->maxit * sizeof(real_t));
+        if (!e->espectro.alphas || !e->espectro.betas) {
+            printf("Erro de alocação de memória (coeficientes do PCG)\n");
+            return -1;
+        }
+    }
+
+    //buffers: um conjunto no modo sequencial; no pipeline, os que circulam entre os estágios
+    //(com mais SLs em andamento do que buffers, a geração espera um ser devolvido)
+    e->nBuffers = e->capacidade ? e->capacidade + N_ESTAGIOS : 1;
+    if (e->nBuffers > e->nSistemas) e->nBuffers = e->nSistemas;
+    e->sistemas = calloc(e->nBuffers, sizeof(sistema_t));
+    if (!e->sistemas) {
+        printf("Erro de alocação de memória\n");
+        return -1;
+    }
+    for (int i = 0; i < e->nBuffers; ++i)
+        if (criaSistema(e, &e->sistemas[i])) return -1;
+
+    //subespaço reaproveitado entre os sistemas da sequência
+    if (e->nReciclados > 0) {
+        int janela = FATOR_JANELA_LANCZOS * e->nReciclados;
+        e->S = criaSubespaco(e->n, e->nReciclados, (janela < e->maxit) ? janela : e->maxit);
+        if (!e->S) {
+            printf("Erro de alocação do subespaço de reciclagem\n");
+            return -1;
+        }
+    }
+
+    //sintonia antes do pipeline: a medição não pode disputar a CPU com os estágios
+    if (e->arqSabedoria) {
+        rtime_t tSintonia = timestamp();
+        sabedoria_t *sab = carregaSabedoria(e->arqSabedoria);
+        if (!sab) {
+            printf("Erro de alocação da sabedoria\n");
+            return -1;
+        }
+        int medida;
+        if (sintonizaSpmv(sab, e->n, e->k, e->formato, &e->escolha, &medida) == 0) {
+            char texto[64];
+            e->sintonizado = 1;
+            fprintf(stderr, "# sintonia: %s (%s, %.3f ms)\n", descreveEscolha(&e->escolha, texto, sizeof(texto)),
+                    medida ? "medida agora" : "da sabedoria", timestamp() - tSintonia);
+        } else {
+            fprintf(stderr, "# sintonia: formato %s sem variantes, SpMV padrão\n", e->formato);
+        }
+        int erro = salvaSabedoria(sab);
+        liberaSabedoria(sab);
+        if (erro) return -1;
+    }
+
+    if (e->dirCache) {
+        e->cache = criaCache(strcmp(e->dirCache, "-") ? e->dirCache : NULL);
+        if (!e->cache) {
+            printf("Erro de alocação do cache\n");
+            return -1;
+        }
+    }
+
+    if (e->dirPreparo) {
+        e->preparo = criaCachePreparo(e->dirPreparo, e->limitePreparo);
+        if (!e->preparo) return -1;
+    }
+
+    //resultados: formatados e escritos por uma thread própria, o SL seguinte não espera
+    e->saida = criaSaida(stdout, e->n);
+    if (!e->saida) {
+        printf("Erro de alocação de memória (saída)\n");
+        return -1;
+    }
+    return 0;
+}
+
+int executaSequencia(execucao_t *e)
+{
+    if (e->capacidade) {
+        //o PCG roda na thread principal: usa o pool OpenMP fixado por -a e os marcadores LIKWID
+        estagio_t estagios[N_ESTAGIOS] = {
+            { "geracao",  geraSistema,    0 },
+            { "precond",  preparaSistema, 0 },
+            { "pcg",      resolveSistema, 1 },
+            { "saida",    escreveSistema, 0 },
+        };
+        void **itens = malloc(e->nBuffers * sizeof(void *));
+        if (!itens) {
+            printf("Erro de alocação de memória\n");
+            return -1;
+        }
+        for (int i = 0; i < e->nBuffers; ++i) itens[i] = &e->sistemas[i];
+
+        int erro = executaPipeline(estagios, N_ESTAGIOS, itens, e->nBuffers, e->nSistemas, e->capacidade, e);
+        relatorioPipeline(estagios, N_ESTAGIOS, e->nSistemas, stderr);
+        free(itens);
+        if (erro) return -1;
+    } else {
+        for (int sis = 0; sis < e->nSistemas; ++sis) {
+            sistema_t *s = &e->sistemas[0];
+            geraSistema(e, s);
+            if (preparaSistema(e, s) || resolveSistema(e, s)) return -1;
+            escreveSistema(e, s);
+        }
+    }
+
+    //economia total em relação a resolver todos como o primeiro (sem subespaço)
+    if (e->nSistemas > 1 && e->S)
+        fprintf(stderr, "# total: %d iterações, economia de %d (%.1f%%) com %d vetores reciclados\n",
+                e->iterTotal, e->iterPrimeiro * e->nSistemas - e->iterTotal,
+                e->iterPrimeiro ? 100.0 * (e->iterPrimeiro * e->nSistemas - e->iterTotal) / (e->iterPrimeiro * e->nSistemas) : 0.0,
+                e->S->nVetores);
+    return 0;
+}
+
+void fechaExecucao(execucao_t *e)
+{
+    for (int i = 0; e->sistemas && i < e->nBuffers; ++i) {
+        liberaOperador(e->sistemas[i].op);
+        liberaFatorBanda(e->sistemas[i].fator);
+        liberaAMG(e->sistemas[i].amg);
+        liberaFatorBanda(e->sistemas[i].blocos);
+        fechaPreparoSistema(&e->sistemas[i]);
+        liberaArena(e->sistemas[i].arena);
+    }
+    free(e->sistemas);
+    liberaSubespaco(e->S);
+    liberaArena(e->controle.trabalho);
+    free(e->espectro.alphas);
+    free(e->espectro.betas);
+    liberaCache(e->cache);
+    if (e->preparo) relatorioCachePreparo(e->preparo, stderr);
+    liberaCachePreparo(e->preparo);
+
+    //a escritora termina a saída enquanto o resto é liberado
+    if (e->saida) {
+        encerraSaida(e->saida);
+        if (e->nSistemas > 1) relatorioSaida(e->saida, stderr);
+        liberaSaida(e->saida);
+    }
+    memset(e, 0, sizeof(*e));
+}
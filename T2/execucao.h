@@ -0,0 +1,106 @@
+#ifndef __EXECUCAO_H__
+#define __EXECUCAO_H__
+
+#include <stdint.h>
+#include "utils.h"
+#include "pcgc.h"
+#include "reciclagem.h"
+#include "cache.h"
+#include "arena.h"
+#include "operador.h"
+#include "sintonia.h"
+#include "banda.h"
+#include "amg.h"
+#include "saida.h"
+#include "preparo.h"
+
+// Estágios do modo pipeline (-P): geração, pré-condicionador, PCG, resíduo/saída
+#define N_ESTAGIOS 4
+
+// Iterações entre os testes do critério no Chebyshev sem -p: cada teste é a única redução
+#define INTERVALO_CHEBYSHEV 10
+
+// Buffers e resultados de um SL da sequência (no modo pipeline, um por item em circulação)
+typedef struct {
+    int sis;            // posição na sequência
+    arena_t *arena;
+    real_t *A, *b, *x, *ASP, *bsp, *D, *L, *U, *M;
+    real_t *raizD;      // D^1/2 da escala simétrica (-d)
+    operador_t *op;     // ASP no formato de armazenamento pedido (-f)
+    fatorBanda_t *fator; // Cholesky em banda de ASP (-m direto|auto); NULL = PCG
+    amg_t *amg;         // pré-condicionador AMG (-g); NULL = M
+    fatorBanda_t *blocos; // Jacobi em blocos (-j); NULL = M
+    precondicionador_t precond; // AMG ou Jacobi em blocos, como o PCG os aplica
+    preparo_t *preparo; // preparo mapeado do cache em disco (-M); NULL = calculado
+    uint64_t chavePreparo;
+    real_t *daArena[4]; // ASP, D, M e raizD da arena, enquanto apontam para o mapa
+    rtime_t tDLU, tPrecond, tempoIter, tResiduo;
+    rtime_t tSimetrica; // ms de genSimetricaPositiva (ASP e bsp); 0 num acerto do cache do preparo
+    real_t normaFinal, norma_residuo;
+    int iter;
+    int iterPCG, nPCG;  // totais do PCG quando estes buffers foram resolvidos pela última vez:
+                        // cópia que segue com o item pelas filas até o preparo (-m auto), que
+                        // não lê os de execucao_t, escritos pelo estágio do PCG ao mesmo tempo
+} sistema_t;
+
+// Parâmetros da execução e estado compartilhado entre os SLs
+typedef struct {
+    int n, k, maxit, nSistemas;
+    double omega, epsilon;
+    const char *formato;    // formato do operador do PCG ("dia", "densa")
+    char precisao;          // tipo das contas do PCG: 'd' (real_t), 'f' (float) ou 'l' (long double)
+    int sintonizado;        // 1: SpMV "dia" com a configuração da sabedoria (-w)
+    int escala;             // 1: CG sem M sobre D^-1/2 A D^-1/2 (-d)
+    char metodo;            // 'p' (PCG), 'd' (Cholesky em banda), 'a' (o de menor custo estimado) ou 'c' (Chebyshev)
+    int amg;                // 1: pré-condicionador AMG no lugar do Jacobi (-g)
+    suavizador_t suavizador;
+    int passosAMG;          // varreduras de Jacobi ou grau de Chebyshev do ciclo V
+    int tamBloco;           // Jacobi em blocos (-j): -1 desligado, 0 um bloco por thread, senão linhas por bloco
+    escolhaSpmv_t escolha;
+    controleConvergencia_t controle;
+    int relataParada;
+    espectroCG_t espectro;  // alpha/beta do PCG para estimar lambdaMin/lambdaMax (-m cheb, -p, -e)
+    real_t lambdaMin, lambdaMax; // intervalo do Chebyshev (-m cheb): dado, estimado ou 0 (ainda não)
+    int iterEspectro;       // iterações do PCG que estimam o intervalo
+    char *arqX0;
+    char *arqCheckpoint;        // checkpoint/retomada do PCG (-C); NULL = desligado
+    double intervaloCheckpoint; // segundos entre pontos
+    int nReciclados;            // vetores de deflação (-r); 0 = CG sem reciclagem
+    const char *dirCache;       // cache de soluções (-c; "-" = só em memória); NULL = desligado
+    const char *arqSabedoria;   // sabedoria do SpMV (-w); NULL = sem sintonia
+    const char *dirPreparo;     // cache em disco do preparo (-M); NULL = desligado
+    size_t limitePreparo;       // bytes do cache do preparo
+    int capacidade;             // posições das filas do pipeline (-P); 0 = SLs um após o outro
+    subespaco_t *S;
+    cacheSolucao_t *cache;
+    cachePreparo_t *preparo; // cache em disco de ASP, D, M e fatores (-M); NULL = desligado
+    saida_t *saida;     // escritora assíncrona dos resultados (stdout)
+    sistema_t *sistemas;    // buffers: um no modo sequencial, os que circulam no pipeline
+    int nBuffers;
+    int proximo;        // próximo SL a ser gerado
+    int iterPrimeiro, iterTotal;
+    int iterPCG, nPCG;      // iterações e resoluções do PCG (só o estágio do PCG; ver sistema_t)
+} execucao_t;
+
+/**
+ * Sequência de SLs do cgSolver: geração de A e b, preparo (ASP, pré-condicionador,
+ * fatores de -m/-g/-j, cache do preparo), resolução (PCG, Chebyshev, direto,
+ * reciclagem, cache de soluções) e saída, um SL após o outro ou em pipeline (-P).
+ * O programa só lê as opções e a entrada e preenche execucao_t.
+ */
+
+// Valores padrão das opções (PCG em double, formato "dia", um SL)
+void execucaoPadrao(execucao_t *e);
+
+// Com n, omega, maxit e epsilon lidos: buffers dos SLs, coeficientes do espectro,
+// subespaço de reciclagem, sintonia do SpMV, caches e escritora da saída.
+// Retorna 0 ou -1 (com a mensagem de erro já impressa)
+int abreExecucao(execucao_t *e);
+
+// Resolve os nSistemas SLs e escreve os resultados; retorna 0 ou -1
+int executaSequencia(execucao_t *e);
+
+// Relatórios finais (reciclagem, cache do preparo, saída) e liberação de tudo
+void fechaExecucao(execucao_t *e);
+
+#endif // __EXECUCAO_H__
@@ -0,0 +1,440 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <tgmath.h>
+#include <x86intrin.h>
+#include "utils.h"
+#include "sislin.h"
+#include "arena.h"
+#include "topologia.h"
+#include "operador.h"
+#include "nucleos.h"
+#include "sintonia.h"
+#include "reducao.h"
+
+// Microbenchmarks dos blocos de gradienteConjugado e calcResiduoSL, isolados:
+// SpMV de diagonais (por k e por variante), produtos escalares, atualizações
+// axpy/xpay, aplicação do pré-condicionador, resíduo e norma. Cada núcleo roda
+// com o conjunto de trabalho em L1, L2, L3 e na DRAM, medido com rdtsc.
+
+// SpMV genérico com k = 3, 5, 9 e 11 (o de k = 7 é spmvDIA_d, da libpcg)
+NUCLEOS_DIA(k3, double, int, 3)
+NUCLEOS_DIA(k5, double, int, 5)
+NUCLEOS_DIA(k9, double, int, 9)
+NUCLEOS_DIA(k11, double, int, 11)
+
+// Lotes de chamadas entre leituras do TSC: cada lote dura pelo menos isso
+#define CICLOS_LOTE 2000000ULL
+
+// Vetores de um núcleo (máscara em nucleoBench_t.vetores)
+enum { VET_X, VET_Y, VET_B, VET_R, VET_Z, VET_P, VET_AP, VET_M, VET_PESO, N_VET };
+#define V(nome) (1u << VET_##nome)
+
+typedef struct {
+    int n, k;
+    real_t *A;
+    real_t *v[N_VET];
+    float *Af, *xf, *yf;
+    operador_t *op;         // dia-fantasma (cópia alinhada de A)
+    real_t *xOp;            // x com as margens de op
+    escolhaSpmv_t escolha;  // variante de sintonia
+    real_t *parciais;       // somas parciais das reduções reprodutíveis
+    real_t sumidouro;       // resultado das reduções (impede a eliminação do laço)
+} dados_t;
+
+typedef struct {
+    const char *grupo;
+    const char *variante;
+    int k;                  // diagonais de A (0: só vetores)
+    unsigned vetores;
+    int tipo;               // 0 = double; 'f' = float (A, x e y); 'o' = operador dia-fantasma; 'l'/'b' = sintonia
+    double bytesLinha;      // tráfego mínimo por linha: cada vetor/diagonal lido ou escrito uma vez
+    double flopsLinha;
+    void (*executa)(dados_t *d);
+} nucleoBench_t;
+
+// =========== Núcleos ==========
+#define SPMV_K(K) \
+static void spmvK##K(dados_t *d) { spmvDIA_k##K(d->A, d->v[VET_X], d->v[VET_Y], d->n); }
+SPMV_K(3)
+SPMV_K(5)
+SPMV_K(9)
+SPMV_K(11)
+
+static void spmvK7(dados_t *d)        { spmvDIA_d(d->A, d->v[VET_X], d->v[VET_Y], d->n); }
+static void spmvMult(dados_t *d)      { multDiagonais(d->A, d->v[VET_X], d->v[VET_Y], d->n); }
+static void spmvFantasma(dados_t *d)  { aplicaOperador(d->op, d->xOp, d->v[VET_Y]); }
+static void spmvFloat(dados_t *d)     { spmvDIA_f(d->Af, d->xf, d->yf, d->n); }
+static void spmvIndice64(dados_t *d)  { spmvDIA_d64(d->A, d->v[VET_X], d->v[VET_Y], d->n); }
+static void spmvSintonia(dados_t *d)  { spmvSintonizado(&d->escolha, d->A, d->v[VET_X], d->v[VET_Y], d->n); }
+
+// Formato em fluxo (stores não temporais em y) com a distância de prefetch em linhas
+#define SPMV_FLUXO(DIST) \
+static void spmvFluxo##DIST(dados_t *d) { spmvDIAFluxo(d->A, d->v[VET_X], d->v[VET_Y], d->n, DIST); }
+SPMV_FLUXO(0)
+SPMV_FLUXO(128)
+SPMV_FLUXO(512)
+SPMV_FLUXO(2048)
+
+//p^T A p e r^T z (mesmo laço)
+static void dot(dados_t *d)
+{
+    const int n = d->n;
+    const real_t *p = d->v[VET_P], *Ap = d->v[VET_AP];
+    real_t s = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:s) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) s += p[i] * Ap[i];
+    d->sumidouro += s;
+}
+
+//p^T A p com a soma reprodutível (-R): blocos fixos somados aos pares
+static void dotReprodutivel(dados_t *d)
+{
+    d->sumidouro += produtoReprodutivel(d->v[VET_P], d->v[VET_AP], d->n, d->parciais);
+}
+
+//||r||2 (critério de parada e calcResiduoSL)
+static void norma(dados_t *d)
+{
+    const int n = d->n;
+    const real_t *r = d->v[VET_R];
+    real_t s = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:s) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) s += r[i] * r[i];
+    d->sumidouro += sqrt(s);
+}
+
+//x += alpha p; r -= alpha Ap, nas três formas do loop do PCG
+static void axpy(dados_t *d)
+{
+    const int n = d->n;
+    real_t *x = d->v[VET_X], *r = d->v[VET_R];
+    const real_t *p = d->v[VET_P], *Ap = d->v[VET_AP], alpha = 1e-3;
+    #pragma omp parallel for schedule(static) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) {
+        x[i] += alpha * p[i];
+        r[i] -= alpha * Ap[i];
+    }
+}
+
+static void axpyNorma(dados_t *d)
+{
+    const int n = d->n;
+    real_t *x = d->v[VET_X], *r = d->v[VET_R];
+    const real_t *p = d->v[VET_P], *Ap = d->v[VET_AP], alpha = 1e-3;
+    real_t s = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:s) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) {
+        x[i] += alpha * p[i];
+        r[i] -= alpha * Ap[i];
+        s += r[i] * r[i];
+    }
+    d->sumidouro += s;
+}
+
+static void axpyNormaReprodutivel(dados_t *d)
+{
+    const int n = d->n;
+    real_t *x = d->v[VET_X], *r = d->v[VET_R];
+    const real_t *p = d->v[VET_P], *Ap = d->v[VET_AP], alpha = 1e-3;
+    real_t soma;
+    SOMA_REPRODUTIVEL(soma, d->parciais, n, n >= MIN_LINHAS_PARALELO,
+                      x[i] += alpha * p[i];
+                      r[i] -= alpha * Ap[i];
+                      s += r[i] * r[i];);
+    d->sumidouro += soma;
+}
+
+static void axpyNormaPeso(dados_t *d)
+{
+    const int n = d->n;
+    real_t *x = d->v[VET_X], *r = d->v[VET_R];
+    const real_t *p = d->v[VET_P], *Ap = d->v[VET_AP], *peso = d->v[VET_PESO], alpha = 1e-3;
+    real_t s = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:s) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) {
+        x[i] += alpha * p[i];
+        r[i] -= alpha * Ap[i];
+        s += (peso[i] * r[i]) * (peso[i] * r[i]);
+    }
+    d->sumidouro += s;
+}
+
+//p = z + beta p, com e sem ||p||_inf
+static void xpay(dados_t *d)
+{
+    const int n = d->n;
+    real_t *p = d->v[VET_P];
+    const real_t *z = d->v[VET_Z], beta = 0.5;
+    #pragma omp parallel for schedule(static) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) p[i] = z[i] + beta * p[i];
+}
+
+static void xpayMax(dados_t *d)
+{
+    const int n = d->n;
+    real_t *p = d->v[VET_P];
+    const real_t *z = d->v[VET_Z], beta = 0.5;
+    real_t pMax = 0.0;
+    #pragma omp parallel for schedule(static) reduction(max:pMax) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) {
+        p[i] = z[i] + beta * p[i];
+        pMax = fmax(pMax, fabs(p[i]));
+    }
+    d->sumidouro += pMax;
+}
+
+//z = r / M (pcgc) e z = r / M com r^T z na mesma passada (nucleos)
+static void precond(dados_t *d)
+{
+    const int n = d->n;
+    real_t *z = d->v[VET_Z];
+    const real_t *r = d->v[VET_R], *M = d->v[VET_M];
+    #pragma omp parallel for schedule(static) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) z[i] = r[i] / M[i];
+}
+
+static void precondRz(dados_t *d)
+{
+    const int n = d->n;
+    real_t *z = d->v[VET_Z];
+    const real_t *r = d->v[VET_R], *M = d->v[VET_M];
+    real_t s = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:s) if(n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < n; i++) {
+        z[i] = r[i] / M[i];
+        s += r[i] * z[i];
+    }
+    d->sumidouro += s;
+}
+
+//resíduo: calcResiduoSL (op2, com a norma) e r = b - A x dos operadores
+static void residuoSL(dados_t *d)
+{
+    rtime_t t;
+    d->sumidouro += calcResiduoSL(d->A, d->v[VET_B], d->v[VET_X], d->n, N_DIAG, &t);
+}
+
+static void residuoDia(dados_t *d)       { residuoDIA_d(d->A, d->v[VET_B], d->v[VET_X], d->v[VET_R], d->n); }
+static void residuoFantasma(dados_t *d)  { residuoOperador(d->op, d->v[VET_B], d->xOp, d->v[VET_R]); }
+static void residuoFluxo(dados_t *d)     { residuoDIAFluxo(d->A, d->v[VET_B], d->v[VET_X], d->v[VET_R], d->n, DIST_PREFETCH_FLUXO); }
+
+#define B8 8.0
+static const nucleoBench_t NUCLEOS[] = {
+    { "spmv", "dia k=3",                3, V(X) | V(Y), 0,   (3 + 2) * B8, 2 * 3, spmvK3 },
+    { "spmv", "dia k=5",                5, V(X) | V(Y), 0,   (5 + 2) * B8, 2 * 5, spmvK5 },
+    { "spmv", "dia k=7 (spmvDIA_d)",    7, V(X) | V(Y), 0,   (7 + 2) * B8, 2 * 7, spmvK7 },
+    { "spmv", "dia k=9",                9, V(X) | V(Y), 0,   (9 + 2) * B8, 2 * 9, spmvK9 },
+    { "spmv", "dia k=11",              11, V(X) | V(Y), 0,  (11 + 2) * B8, 2 * 11, spmvK11 },
+    { "spmv", "multDiagonais (dia)",    7, V(X) | V(Y), 0,   (7 + 2) * B8, 2 * 7, spmvMult },
+    { "spmv", "dia-fantasma",           7, V(Y),        'o', (7 + 2) * B8, 2 * 7, spmvFantasma },
+    { "spmv", "sintonia: linhas",       7, V(X) | V(Y), 'l', (7 + 2) * B8, 2 * 7, spmvSintonia },
+    { "spmv", "sintonia: blocos 8192",  7, V(X) | V(Y), 'b', (7 + 2) * B8, 2 * 7, spmvSintonia },
+    { "spmv", "dia-fluxo sem prefetch", 7, V(X) | V(Y), 0,   (7 + 2) * B8, 2 * 7, spmvFluxo0 },
+    { "spmv", "dia-fluxo prefetch 128", 7, V(X) | V(Y), 0,   (7 + 2) * B8, 2 * 7, spmvFluxo128 },
+    { "spmv", "dia-fluxo prefetch 512", 7, V(X) | V(Y), 0,   (7 + 2) * B8, 2 * 7, spmvFluxo512 },
+    { "spmv", "dia-fluxo prefetch 2048", 7, V(X) | V(Y), 0,  (7 + 2) * B8, 2 * 7, spmvFluxo2048 },
+    { "spmv", "float (spmvDIA_f)",      7, 0,           'f', (7 + 2) * 4.0, 2 * 7, spmvFloat },
+    { "spmv", "índice int64 (d64)",     7, V(X) | V(Y), 0,   (7 + 2) * B8, 2 * 7, spmvIndice64 },
+    { "dot", "p.Ap (redução)",          0, V(P) | V(AP), 0,  2 * B8, 2, dot },
+    { "dot", "p.Ap reprodutível (-R)",  0, V(P) | V(AP), 0,  2 * B8, 2, dotReprodutivel },
+    { "norma", "||r||2",                0, V(R), 0,          1 * B8, 2, norma },
+    { "axpy", "x += a p; r -= a Ap",    0, V(X) | V(R) | V(P) | V(AP), 0, 6 * B8, 4, axpy },
+    { "axpy", "+ ||r||2",               0, V(X) | V(R) | V(P) | V(AP), 0, 6 * B8, 6, axpyNorma },
+    { "axpy", "+ ||r||2 reprodutível",  0, V(X) | V(R) | V(P) | V(AP), 0, 6 * B8, 6, axpyNormaReprodutivel },
+    { "axpy", "+ ||w.r||2 (-d)",        0, V(X) | V(R) | V(P) | V(AP) | V(PESO), 0, 7 * B8, 9, axpyNormaPeso },
+    { "xpay", "p = z + b p",            0, V(Z) | V(P), 0,   3 * B8, 2, xpay },
+    { "xpay", "+ ||p||_inf",            0, V(Z) | V(P), 0,   3 * B8, 2, xpayMax },
+    { "precond", "z = r / M",           0, V(R) | V(Z) | V(M), 0, 3 * B8, 1, precond },
+    { "precond", "z = r / M + r.z",     0, V(R) | V(Z) | V(M), 0, 3 * B8, 3, precondRz },
+    { "residuo", "calcResiduoSL (op2)", 7, V(X) | V(B), 0,   (7 + 3) * B8, 2 * 7 + 3, residuoSL },
+    { "residuo", "residuoDIA_d (dia)",  7, V(X) | V(B) | V(R), 0, (7 + 3) * B8, 2 * 7 + 1, residuoDia },
+    { "residuo", "dia-fantasma",        7, V(B) | V(R), 'o', (7 + 3) * B8, 2 * 7 + 1, residuoFantasma },
+    { "residuo", "dia-fluxo",           7, V(X) | V(B) | V(R), 0, (7 + 3) * B8, 2 * 7 + 1, residuoFluxo },
+};
+#define N_NUCLEOS ((int) (sizeof(NUCLEOS) / sizeof(NUCLEOS[0])))
+
+// =========== Medição ==========
+static inline uint64_t leTSC(void)
+{
+    _mm_lfence();
+    uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+
+//Frequência do TSC (ciclos por ms), contra o relógio de timestamp()
+static double calibraTSC(void)
+{
+    rtime_t t0 = timestamp();
+    uint64_t c0 = leTSC();
+    while (timestamp() - t0 < 50.0) {}
+    return (leTSC() - c0) / (timestamp() - t0);
+}
+
+static int comparaDouble(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+//Ciclos por chamada: mediana de 'repeticoes' lotes de chamadas seguidas
+static double mede(const nucleoBench_t *nb, dados_t *d, int repeticoes)
+{
+    nb->executa(d);
+    uint64_t c0 = leTSC();
+    nb->executa(d);
+    uint64_t umaChamada = leTSC() - c0;
+    long lote = umaChamada ? (long) (CICLOS_LOTE / umaChamada) : 1;
+    if (lote < 1) lote = 1;
+
+    double amostras[64];
+    if (repeticoes > 64) repeticoes = 64;
+    for (int r = 0; r < repeticoes; r++) {
+        c0 = leTSC();
+        for (long c = 0; c < lote; c++) nb->executa(d);
+        amostras[r] = (double) (leTSC() - c0) / lote;
+    }
+    qsort(amostras, repeticoes, sizeof(double), comparaDouble);
+    return amostras[repeticoes / 2];
+}
+
+//Aloca e preenche os dados do núcleo para n linhas (valores que não crescem nas repetições)
+static arena_t *preparaDados(const nucleoBench_t *nb, int n, dados_t *d)
+{
+    memset(d, 0, sizeof(*d));
+    d->n = n;
+    d->k = nb->k;
+
+    size_t bytes = (size_t) nb->k * tamanhoVetorArena(n) + N_VET * tamanhoVetorArena(n) +
+                   tamanhoVetorArena(blocosReducao(n));
+    if (nb->tipo == 'f') bytes += ((size_t) (nb->k + 2) * n * sizeof(float) + 64 * 3);
+    arena_t *arena = criaArena(bytes, ARENA_PAGINAS_ENORMES | ARENA_PRIMEIRO_TOQUE);
+    if (!arena) return NULL;
+
+    if (nb->k > 0 && nb->tipo != 'f') {
+        d->A = arenaDiagonais(arena, n, nb->k);
+        for (size_t i = 0; i < (size_t) nb->k * n; i++) d->A[i] = 1.0 / (1 + i % 5);
+    }
+    d->parciais = arenaVetor(arena, blocosReducao(n));
+    for (int v = 0; v < N_VET; v++) {
+        if (!(nb->vetores & (1u << v))) continue;
+        d->v[v] = arenaVetor(arena, n);
+        for (int i = 0; i < n; i++) d->v[v][i] = (v == VET_M) ? 2.0 : 1.0 / (1 + (i + v) % 7);
+    }
+
+    if (nb->tipo == 'f') {
+        d->Af = arenaAloca(arena, (size_t) nb->k * n * sizeof(float));
+        d->xf = arenaAloca(arena, n * sizeof(float));
+        d->yf = arenaAloca(arena, n * sizeof(float));
+        for (size_t i = 0; i < (size_t) nb->k * n; i++) d->Af[i] = 1.0f / (1 + i % 5);
+        for (int i = 0; i < n; i++) d->xf[i] = 1.0f;
+    } else if (nb->tipo == 'o') {
+        d->op = criaOperadorDIAFantasma(d->A, n);
+        d->xOp = d->op ? criaVetorOperador(d->op) : NULL;
+        if (!d->xOp) {
+            liberaOperador(d->op);
+            liberaArena(arena);
+            return NULL;
+        }
+        for (int i = 0; i < n; i++) d->xOp[i] = 1.0 / (1 + i % 7);
+    } else if (nb->tipo == 'l' || nb->tipo == 'b') {
+#ifdef _OPENMP
+        d->escolha.nThreads = omp_get_max_threads();
+#else
+        d->escolha.nThreads = 1;
+#endif
+        d->escolha.variante = (nb->tipo == 'l') ? SPMV_LINHAS : SPMV_BLOCOS;
+        d->escolha.bloco = 8192;
+    }
+    return arena;
+}
+
+static void liberaDados(dados_t *d, arena_t *arena)
+{
+    if (d->op) {
+        liberaVetorOperador(d->op, d->xOp);
+        liberaOperador(d->op);
+    }
+    liberaArena(arena);
+}
+
+static void uso(const char *prog)
+{
+    printf("uso: %s [-g grupo] [-r repetições] [-m MiB]\n", prog);
+    printf("  -g grupo  só os núcleos do grupo (spmv, dot, norma, axpy, xpay, precond, residuo)\n");
+    printf("  -r rep    lotes medidos por caso; a mediana é reportada (padrão 7)\n");
+    printf("  -m MiB    conjunto de trabalho do nível DRAM (padrão: 2x a L3, no mínimo 64 MiB)\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *grupo = NULL;
+    int repeticoes = 7;
+    double mibDRAM = 0.0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "g:r:m:")) != -1) {
+        switch (opt) {
+            case 'g': grupo = optarg; break;
+            case 'r': repeticoes = atoi(optarg); break;
+            case 'm': mibDRAM = atof(optarg); break;
+            default: uso(argv[0]); return 1;
+        }
+    }
+    if (repeticoes < 1) {
+        uso(argv[0]);
+        return 1;
+    }
+
+    //conjunto de trabalho de cada nível: metade da cache (a outra metade fica para o resto)
+    const char *nomesNivel[4] = { "L1", "L2", "L3", "DRAM" };
+    size_t cache[3] = { tamanhoCache(1), tamanhoCache(2), tamanhoCache(3) };
+    size_t alvo[4];
+    for (int l = 0; l < 3; l++) alvo[l] = cache[l] / 2;
+    size_t maiorCache = cache[2] ? cache[2] : cache[1];
+    alvo[3] = mibDRAM > 0.0 ? (size_t) (mibDRAM * (1 << 20)) : 2 * maiorCache;
+    if (alvo[3] < ((size_t) 64 << 20)) alvo[3] = (size_t) 64 << 20;
+
+    double tscMs = calibraTSC();
+#ifdef _OPENMP
+    int nThreads = omp_get_max_threads();
+#else
+    int nThreads = 1;
+#endif
+    printf("# TSC: %.3f GHz; caches: L1 %zu KiB, L2 %zu KiB, L3 %zu KiB; DRAM: %zu MiB; %d thread%s\n",
+           tscMs * 1e-6, cache[0] >> 10, cache[1] >> 10, cache[2] >> 10, alvo[3] >> 20, nThreads, nThreads > 1 ? "s" : "");
+    printf("# ciclos do TSC; bytes = tráfego mínimo (cada diagonal/vetor lido ou escrito uma vez por chamada)\n");
+    printf("%-8s nível %-24s %10s %12s %11s %11s %8s\n", "grupo", "variante", "n", "ciclos/linha",
+           "bytes/ciclo", "flops/ciclo", "GB/s");
+
+    //por grupo e nível, as variantes lado a lado
+    for (int g = 0; g < N_NUCLEOS; g++) {
+        if (g > 0 && !strcmp(NUCLEOS[g].grupo, NUCLEOS[g - 1].grupo)) continue;
+        if (grupo && strcmp(grupo, NUCLEOS[g].grupo)) continue;
+
+        for (int l = 0; l < 4; l++) {
+            if (alvo[l] == 0) continue;
+            for (int v = g; v < N_NUCLEOS && !strcmp(NUCLEOS[v].grupo, NUCLEOS[g].grupo); v++) {
+                const nucleoBench_t *nb = &NUCLEOS[v];
+                int n = (int) (alvo[l] / nb->bytesLinha) & ~7;
+                if (n < 64) n = 64;
+
+                dados_t d;
+                arena_t *arena = preparaDados(nb, n, &d);
+                if (!arena) {
+                    printf("Erro de alocação de memória (%s, n = %d)\n", nb->variante, n);
+                    return 1;
+                }
+                double ciclos = mede(nb, &d, repeticoes) / n;
+                liberaDados(&d, arena);
+
+                printf("%-8s %-5s %-24s %10d %12.3f %11.3f %11.3f %8.2f\n", nb->grupo, nomesNivel[l], nb->variante, n,
+                       ciclos, nb->bytesLinha / ciclos, nb->flopsLinha / ciclos, nb->bytesLinha / ciclos * tscMs * 1e-6);
+            }
+        }
+    }
+    return 0;
+}
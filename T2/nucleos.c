@@ -0,0 +1,15 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <tgmath.h>
+#include "utils.h"
+#include "sislin.h"
+#include "arena.h"
+#include "topologia.h"
+#include "nucleos.h"
+
+//Instâncias dos núcleos genéricos (ver nucleos.h)
+NUCLEOS_DIA(f, float, int, N_DIAG)
+NUCLEOS_DIA(d, double, int, N_DIAG)
+NUCLEOS_DIA(ld, long double, int, N_DIAG)
+NUCLEOS_DIA(d64, double, int64_t, N_DIAG)
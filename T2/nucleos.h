@@ -0,0 +1,169 @@
+#ifndef __NUCLEOS_H__
+#define __NUCLEOS_H__
+
+#include <stdint.h>
+#include "utils.h"
+#include "sislin.h"
+#include "topologia.h"
+#include "arena.h"
+
+/**
+ * Núcleos do formato de diagonais genéricos no tipo escalar (T), no tipo de
+ * índice (I) e no número de diagonais (K, constante de compilação).
+ *
+ * NUCLEOS_DIA(SUF, T, I, K) gera, com o sufixo SUF:
+ *   spmvDIA_SUF(A, x, y, n)          y = A x
+ *   residuoDIA_SUF(A, b, x, r, n)    r = b - A x (numa passada)
+ *   cgDIA_SUF(A, b, x, n, maxit, eps, M, normaFinal, trabalho)
+ *                                    PCG (Jacobi se M != NULL, ||r||2 < eps),
+ *                                    todas as contas em T; r, z, p e Ap vêm de
+ *                                    'trabalho' (reiniciada, se couber) ou, com
+ *                                    NULL, de uma arena própria da chamada
+ * Cada instância é compilada com K e os tipos fixos: o compilador desenrola as
+ * diagonais e vetoriza com a largura do tipo (8 floats, 4 doubles por AVX).
+ *
+ * Instâncias em nucleos.c (K = N_DIAG):
+ *   f (float, int), d (double, int), ld (long double, int), d64 (double, int64_t)
+ * multDiagonais e o operador "dia" usam a instância d; as macros _Generic
+ * abaixo escolhem a instância pelo tipo de A e, em double, pelo de n.
+ */
+#define DECLARA_NUCLEOS_DIA(SUF, T, I) \
+    void spmvDIA_##SUF(const T *A, const T *x, T *y, I n); \
+    void residuoDIA_##SUF(const T *A, const T *b, const T *x, T *r, I n); \
+    int cgDIA_##SUF(const T *A, const T *b, T *x, I n, int maxit, T eps, const T *M, T *normaFinal, \
+                    arena_t *trabalho);
+
+DECLARA_NUCLEOS_DIA(f, float, int)
+DECLARA_NUCLEOS_DIA(d, double, int)
+DECLARA_NUCLEOS_DIA(ld, long double, int)
+DECLARA_NUCLEOS_DIA(d64, double, int64_t)
+
+// Instância escolhida pelo tipo (const ou não) do ponteiro A; com A double, n int64_t
+// escolhe o índice de 64 bits (d64) e qualquer outro inteiro, o int (d)
+#define ESCOLHE_INDICE_DIA(n, nome) _Generic((n), int64_t: nome##_d64, default: nome##_d)
+#define ESCOLHE_NUCLEO_DIA(A, n, nome) _Generic((A), \
+    float *: nome##_f,        const float *: nome##_f, \
+    double *: ESCOLHE_INDICE_DIA(n, nome), const double *: ESCOLHE_INDICE_DIA(n, nome), \
+    long double *: nome##_ld, const long double *: nome##_ld)
+
+#define spmvDIA(A, x, y, n)         ESCOLHE_NUCLEO_DIA(A, n, spmvDIA)(A, x, y, n)
+#define residuoDIA(A, b, x, r, n)   ESCOLHE_NUCLEO_DIA(A, n, residuoDIA)(A, b, x, r, n)
+#define cgDIA(A, b, x, n, maxit, eps, M, normaFinal, trabalho) \
+    ESCOLHE_NUCLEO_DIA(A, n, cgDIA)(A, b, x, n, maxit, eps, M, normaFinal, trabalho)
+
+// Bytes dos vetores de cgDIA com n linhas de 'bytesReal' bytes (sizeof(T))
+#define BYTES_TRABALHO_CG_DIA(n, bytesReal) (4 * (((size_t) (n) * (bytesReal) + 63) & ~(size_t) 63))
+
+/**
+ * Definição das funções de uma instância (usada só em nucleos.c, que inclui
+ * <tgmath.h> para sqrt/fabs no tipo T). Mesmos laços de multDiagonais e do
+ * PCG: diagonais no laço externo, faixas de linhas por thread.
+ */
+#define NUCLEOS_DIA(SUF, T, I, K) \
+static inline void acumulaDIA_##SUF(const T *restrict A, const T *restrict v, T *restrict y, \
+                                    I n, I i0, I i1, int subtrai) \
+{ \
+    for (int diag_idx = 0; diag_idx < (K); diag_idx++) { \
+        const I offset = (I) diag_idx - (K) / 2; \
+        I inicio = (offset < 0) ? -offset : 0; \
+        I fim    = (offset > 0) ? n - offset : n; \
+        if (inicio < i0) inicio = i0; \
+        if (fim > i1) fim = i1; \
+        const T *diagonal = &A[(I) diag_idx * n]; \
+        if (subtrai) { \
+            for (I i = inicio; i < fim; i++) y[i] -= diagonal[i] * v[i + offset]; \
+        } else { \
+            for (I i = inicio; i < fim; i++) y[i] += diagonal[i] * v[i + offset]; \
+        } \
+    } \
+} \
+\
+void spmvDIA_##SUF(const T *A, const T *x, T *y, I n) \
+{ \
+    _Pragma("omp parallel if(n >= MIN_LINHAS_PARALELO)") \
+    { \
+        int64_t a, b; \
+        faixaThreadLonga(n, &a, &b); \
+        const I i0 = a, i1 = b; \
+        for (I i = i0; i < i1; ++i) y[i] = 0; \
+        acumulaDIA_##SUF(A, x, y, n, i0, i1, 0); \
+    } \
+} \
+\
+void residuoDIA_##SUF(const T *A, const T *b, const T *x, T *r, I n) \
+{ \
+    _Pragma("omp parallel if(n >= MIN_LINHAS_PARALELO)") \
+    { \
+        int64_t a, c; \
+        faixaThreadLonga(n, &a, &c); \
+        const I i0 = a, i1 = c; \
+        for (I i = i0; i < i1; ++i) r[i] = b[i]; \
+        acumulaDIA_##SUF(A, x, r, n, i0, i1, 1); \
+    } \
+} \
+\
+int cgDIA_##SUF(const T *A, const T *b, T *x, I n, int maxit, T eps, const T *M, T *normaFinal, \
+                arena_t *trabalhoDado) \
+{ \
+    const int paralelo = (n >= MIN_LINHAS_PARALELO); \
+    const size_t bytesVetor = ((size_t) n * sizeof(T) + 63) & ~(size_t) 63; \
+    arena_t *trabalho = trabalhoDado; \
+    if (trabalho && trabalho->tamanho >= BYTES_TRABALHO_CG_DIA(n, sizeof(T))) arenaReinicia(trabalho); \
+    else trabalho = criaArena(BYTES_TRABALHO_CG_DIA(n, sizeof(T)), ARENA_PAGINAS_ENORMES); \
+    if (!trabalho) return -1; \
+    T *r = arenaAloca(trabalho, bytesVetor); \
+    T *z = arenaAloca(trabalho, bytesVetor); \
+    T *p = arenaAloca(trabalho, bytesVetor); \
+    T *Ap = arenaAloca(trabalho, bytesVetor); \
+\
+    residuoDIA_##SUF(A, b, x, r, n); \
+    T rz_old = 0, norma_r0_sq = 0; \
+    _Pragma("omp parallel for schedule(static) reduction(+:rz_old, norma_r0_sq) if(paralelo)") \
+    for (I i = 0; i < n; i++) { \
+        z[i] = (M != NULL) ? r[i] / M[i] : r[i]; \
+        p[i] = z[i]; \
+        rz_old += r[i] * z[i]; \
+        norma_r0_sq += r[i] * r[i]; \
+    } \
+    /* ||r0||: o que normaFinal informa se p^T A p quebrar na primeira iteração */ \
+    *normaFinal = sqrt(norma_r0_sq); \
+\
+    int iter, feitas = 0; \
+    for (iter = 1; iter <= maxit; iter++) { \
+        feitas = iter; \
+        spmvDIA_##SUF(A, p, Ap, n); \
+\
+        T pAp = 0; \
+        _Pragma("omp parallel for schedule(static) reduction(+:pAp) if(paralelo)") \
+        for (I i = 0; i < n; i++) pAp += p[i] * Ap[i]; \
+        if (fabs(pAp) < 1e-15) break; \
+\
+        const T alpha = rz_old / pAp; \
+        T norma_r_sq = 0; \
+        _Pragma("omp parallel for schedule(static) reduction(+:norma_r_sq) if(paralelo)") \
+        for (I i = 0; i < n; i++) { \
+            x[i] += alpha * p[i]; \
+            r[i] -= alpha * Ap[i]; \
+            norma_r_sq += r[i] * r[i]; \
+        } \
+        *normaFinal = sqrt(norma_r_sq); \
+        if (*normaFinal < eps) break; \
+\
+        T rz_new = 0; \
+        _Pragma("omp parallel for schedule(static) reduction(+:rz_new) if(paralelo)") \
+        for (I i = 0; i < n; i++) { \
+            z[i] = (M != NULL) ? r[i] / M[i] : r[i]; \
+            rz_new += r[i] * z[i]; \
+        } \
+        const T beta = rz_new / rz_old; \
+        rz_old = rz_new; \
+\
+        _Pragma("omp parallel for schedule(static) if(paralelo)") \
+        for (I i = 0; i < n; i++) p[i] = z[i] + beta * p[i]; \
+    } \
+\
+    if (trabalho != trabalhoDado) liberaArena(trabalho); \
+    return feitas; \
+}
+
+#endif // __NUCLEOS_H__
@@ -0,0 +1,405 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <immintrin.h>
+#include "utils.h"
+#include "sislin.h"
+#include "operador.h"
+#include "densa.h"
+#include "topologia.h"
+#include "nucleos.h"
+#include "arena.h"
+
+const char *FORMATOS_OPERADOR[] = { "dia", "dia-fluxo", "dia-fantasma", "densa", NULL };
+
+// ========== Formato de diagonais (DIA) ==========
+
+//Ap = A * p com A no formato de diagonais (N_DIAG diagonais de tamanho n)
+//Cada thread calcula as suas linhas em todas as diagonais: as mesmas que tocou
+//primeiro na arena (arenaDiagonais), então A e Ap são lidos do nó NUMA local.
+//Interface antiga (real_t, int) sobre a instância double dos núcleos genéricos
+void multDiagonais(real_t *A, real_t *p, real_t *Ap, int n)
+{
+    spmvDIA_d(A, p, Ap, n);
+}
+
+static void aplicaDIA(const operador_t *A, const real_t *x, real_t *y)
+{
+    spmvDIA_d(A->dados, x, y, A->n);
+}
+
+//r = b - A*x numa passada: cada diagonal é subtraída direto de r
+static void residuoOperadorDIA(const operador_t *A, const real_t *b, const real_t *x, real_t *r)
+{
+    residuoDIA_d(A->dados, b, x, r, A->n);
+}
+
+operador_t *criaOperadorDIA(real_t *A, int n)
+{
+    //acima da última cache, o mesmo formato com os laços em fluxo
+    if (usaFluxoDIA(n)) return criaOperadorDIAFluxo(A, n);
+
+    operador_t *op = calloc(1, sizeof(operador_t));
+    if (!op) return NULL;
+
+    op->formato = "dia";
+    op->n = n;
+    op->dados = A;
+    op->aplica = aplicaDIA;
+    op->residuo = residuoOperadorDIA;
+    return op;
+}
+
+// ========== Formato de diagonais em fluxo (n acima da última cache) ==========
+
+//Linha i perto das bordas: só as diagonais que existem nela, na ordem de acumulaDIA
+static inline real_t linhaFluxo(const real_t *A, const real_t *b, const real_t *x, int n, int i)
+{
+    real_t s = b ? b[i] : 0.0;
+    for (int diag_idx = 0; diag_idx < N_DIAG; diag_idx++) {
+        int j = i + diag_idx - OFFSET_CENTER;
+        if (j < 0 || j >= n) continue;
+        if (b) s -= A[(size_t) diag_idx * n + i] * x[j];
+        else s += A[(size_t) diag_idx * n + i] * x[j];
+    }
+    return s;
+}
+
+//Linhas [i0, i1) de y = A x (b == NULL) ou y = b - A x, linhas no laço externo: cada y[i] é
+//escrito uma vez, por store não temporal (sem ler a linha de y para a cache antes), e as
+//diagonais e x são pré-buscados 'distancia' linhas à frente (0 = só o prefetch do hardware).
+//Os termos seguem a ordem das diagonais, com FMA quando acumulaDIA também usa:
+//o resultado é o mesmo de spmvDIA_d/residuoDIA_d
+static void fluxoFaixa(const real_t *A, const real_t *b, const real_t *x, real_t *y, int n, int i0, int i1,
+                       int distancia)
+{
+    int meio0 = (i0 > OFFSET_CENTER) ? i0 : OFFSET_CENTER;
+    int meio1 = (i1 < n - OFFSET_CENTER) ? i1 : n - OFFSET_CENTER;
+    if (meio0 > i1) meio0 = i1;
+    if (meio1 < meio0) meio1 = meio0;
+#ifdef __AVX__
+    //o stream de 32 bytes precisa de y alinhado
+    while (meio0 < meio1 && ((uintptr_t) &y[meio0] & 31)) meio0++;
+#endif
+
+    int i;
+    for (i = i0; i < meio0; i++) y[i] = linhaFluxo(A, b, x, n, i);
+
+#ifdef __AVX__
+    for (i = meio0; i + 4 <= meio1; i += 4) {
+        //uma linha de cache (8 reais) de cada fluxo a cada duas voltas
+        if (distancia && !(i & 7) && i + distancia < n) {
+            for (int diag_idx = 0; diag_idx < N_DIAG; diag_idx++)
+                _mm_prefetch((const char *) &A[(size_t) diag_idx * n + i + distancia], _MM_HINT_T0);
+            _mm_prefetch((const char *) &x[i + distancia], _MM_HINT_T0);
+            if (b) _mm_prefetch((const char *) &b[i + distancia], _MM_HINT_T0);
+        }
+
+        __m256d s = b ? _mm256_loadu_pd(&b[i]) : _mm256_setzero_pd();
+        for (int diag_idx = 0; diag_idx < N_DIAG; diag_idx++) {
+            __m256d a = _mm256_loadu_pd(&A[(size_t) diag_idx * n + i]);
+            __m256d v = _mm256_loadu_pd(&x[i + diag_idx - OFFSET_CENTER]);
+#ifdef __FMA__
+            s = b ? _mm256_fnmadd_pd(a, v, s) : _mm256_fmadd_pd(a, v, s);
+#else
+            s = b ? _mm256_sub_pd(s, _mm256_mul_pd(a, v)) : _mm256_add_pd(s, _mm256_mul_pd(a, v));
+#endif
+        }
+        _mm256_stream_pd(&y[i], s);
+    }
+    //os stores não temporais não seguem a ordem dos demais: visíveis antes da barreira do omp
+    _mm_sfence();
+#else
+    (void) distancia;
+    i = meio0;
+#endif
+
+    for (; i < i1; i++) y[i] = linhaFluxo(A, b, x, n, i);
+}
+
+void spmvDIAFluxo(const real_t *A, const real_t *x, real_t *y, int n, int distancia)
+{
+    #pragma omp parallel if(n >= MIN_LINHAS_PARALELO)
+    {
+        int i0, i1;
+        faixaThread(n, &i0, &i1);
+        fluxoFaixa(A, NULL, x, y, n, i0, i1, distancia);
+    }
+}
+
+void residuoDIAFluxo(const real_t *A, const real_t *b, const real_t *x, real_t *r, int n, int distancia)
+{
+    #pragma omp parallel if(n >= MIN_LINHAS_PARALELO)
+    {
+        int i0, i1;
+        faixaThread(n, &i0, &i1);
+        fluxoFaixa(A, b, x, r, n, i0, i1, distancia);
+    }
+}
+
+//A, x e y do SpMV maiores que a última cache (L2 se não houver L3): nada volta da cache
+//entre duas iterações e os stores não temporais só economizam tráfego
+int usaFluxoDIA(int n)
+{
+    size_t cache = tamanhoCache(3) ? tamanhoCache(3) : tamanhoCache(2);
+    return cache && (size_t) (N_DIAG + 2) * n * sizeof(real_t) > cache;
+}
+
+static void aplicaDIAFluxo(const operador_t *A, const real_t *x, real_t *y)
+{
+    spmvDIAFluxo(A->dados, x, y, A->n, DIST_PREFETCH_FLUXO);
+}
+
+static void residuoOperadorDIAFluxo(const operador_t *A, const real_t *b, const real_t *x, real_t *r)
+{
+    residuoDIAFluxo(A->dados, b, x, r, A->n, DIST_PREFETCH_FLUXO);
+}
+
+operador_t *criaOperadorDIAFluxo(real_t *A, int n)
+{
+    operador_t *op = calloc(1, sizeof(operador_t));
+    if (!op) return NULL;
+
+    op->formato = "dia-fluxo";
+    op->n = n;
+    op->dados = A;
+    op->aplica = aplicaDIAFluxo;
+    op->residuo = residuoOperadorDIAFluxo;
+    return op;
+}
+
+// ========== Formato de diagonais com fantasmas ==========
+
+typedef struct {
+    arena_t *arena;
+    real_t *D;          // D[diag_idx * passo + i], zero onde i + offset sai de [0, n)
+    int passo;          // n arredondado para 8 reais: toda diagonal começa alinhada
+    real_t *xMargem;    // cópia de x com margens para o resíduo inicial
+} diaFantasma_t;
+
+//Mesmo laço para todas as diagonais: [i0, i1), sem limites por offset.
+//As somas seguem a ordem das diagonais e os termos fora da matriz são 0 * 0,
+//então o resultado é o mesmo de multDiagonais
+static inline void acumulaFantasmaFaixa(const diaFantasma_t *d, const real_t *x, real_t *y, int i0, int i1, int subtrai)
+{
+    for (int diag_idx = 0; diag_idx < N_DIAG; diag_idx++) {
+        const real_t *diagonal = &d->D[(size_t) diag_idx * d->passo];
+        const real_t *xd = x + (diag_idx - OFFSET_CENTER);
+
+        if (subtrai) {
+            #pragma omp simd aligned(diagonal, y : 64)
+            for (int i = i0; i < i1; i++) y[i] -= diagonal[i] * xd[i];
+        } else {
+            #pragma omp simd aligned(diagonal, y : 64)
+            for (int i = i0; i < i1; i++) y[i] += diagonal[i] * xd[i];
+        }
+    }
+}
+
+static void aplicaDIAFantasma(const operador_t *op, const real_t *x, real_t *y)
+{
+    const diaFantasma_t *d = op->dados;
+
+    #pragma omp parallel if(op->n >= MIN_LINHAS_PARALELO)
+    {
+        int i0, i1;
+        faixaThread(op->n, &i0, &i1);
+        for (int i = i0; i < i1; ++i) y[i] = 0.0;
+        acumulaFantasmaFaixa(d, x, y, i0, i1, 0);
+    }
+}
+
+//x do chamador não tem margens: copiado para xMargem (uma vez por resolução)
+static void residuoDIAFantasma(const operador_t *op, const real_t *b, const real_t *x, real_t *r)
+{
+    const diaFantasma_t *d = op->dados;
+
+    #pragma omp parallel if(op->n >= MIN_LINHAS_PARALELO)
+    {
+        int i0, i1;
+        faixaThread(op->n, &i0, &i1);
+        for (int i = i0; i < i1; ++i) d->xMargem[i] = x[i];
+        #pragma omp barrier
+        for (int i = i0; i < i1; ++i) r[i] = b[i];
+        acumulaFantasmaFaixa(d, d->xMargem, r, i0, i1, 1);
+    }
+}
+
+static void liberaDIAFantasma(operador_t *op)
+{
+    diaFantasma_t *d = op->dados;
+    if (!d) return;
+    liberaArena(d->arena);
+    free(d);
+}
+
+operador_t *criaOperadorDIAFantasma(const real_t *A, int n)
+{
+    operador_t *op = calloc(1, sizeof(operador_t));
+    diaFantasma_t *d = calloc(1, sizeof(diaFantasma_t));
+    if (!op || !d) {
+        free(op); free(d);
+        return NULL;
+    }
+
+    op->formato = "dia-fantasma";
+    op->n = n;
+    op->fantasmas = OFFSET_CENTER;
+    const int margem = margemOperador(op);
+
+    //páginas tocadas primeiro na cópia abaixo, pelas threads donas das linhas
+    d->passo = (n + 7) / 8 * 8;
+    d->arena = criaArena(tamanhoVetorArena((size_t) N_DIAG * d->passo) + tamanhoVetorArena(n + 2 * margem),
+                         ARENA_PAGINAS_ENORMES);
+    if (!d->arena) {
+        free(op); free(d);
+        return NULL;
+    }
+    d->D = arenaVetor(d->arena, (size_t) N_DIAG * d->passo);
+    d->xMargem = arenaVetor(d->arena, n + 2 * margem) + margem;
+
+    #pragma omp parallel if(n >= MIN_LINHAS_PARALELO)
+    {
+        int i0, i1;
+        faixaThread(n, &i0, &i1);
+        for (int diag_idx = 0; diag_idx < N_DIAG; diag_idx++) {
+            int offset = diag_idx - OFFSET_CENTER;
+            real_t *diagonal = &d->D[(size_t) diag_idx * d->passo];
+            for (int i = i0; i < i1; i++)
+                diagonal[i] = (i + offset >= 0 && i + offset < n) ? A[diag_idx * n + i] : 0.0;
+        }
+    }
+
+    op->dados = d;
+    op->aplica = aplicaDIAFantasma;
+    op->residuo = residuoDIAFantasma;
+    op->libera = liberaDIAFantasma;
+    return op;
+}
+
+// ========== Formato denso ==========
+
+typedef struct {
+    real_t *A;              // n x n, A[i * n + j]
+    mapaBlocos_t *mapa;     // blocos não nulos (faixa de colunas de cada linha de blocos)
+} densa_t;
+
+static void aplicaDensa(const operador_t *op, const real_t *x, real_t *y)
+{
+    const densa_t *d = op->dados;
+    gemvDensa(d->A, x, op->n, d->mapa, y);
+}
+
+static void liberaDensa(operador_t *op)
+{
+    densa_t *d = op->dados;
+    if (!d) return;
+    liberaMapaBlocos(d->mapa);
+    if (op->dono) free(d->A);
+    free(d);
+}
+
+operador_t *criaOperadorDensa(real_t *A, int n)
+{
+    operador_t *op = calloc(1, sizeof(operador_t));
+    densa_t *d = calloc(1, sizeof(densa_t));
+    if (!op || !d) {
+        free(op); free(d);
+        return NULL;
+    }
+
+    d->A = A;
+    d->mapa = criaMapaBlocos(A, n);
+    if (!d->mapa) {
+        free(op); free(d);
+        return NULL;
+    }
+
+    op->formato = "densa";
+    op->n = n;
+    op->dados = d;
+    op->aplica = aplicaDensa;
+    op->residuo = NULL;
+    op->libera = liberaDensa;
+    return op;
+}
+
+//Cópia densa n x n das N_DIAG diagonais (linhas divididas entre as threads)
+static real_t *diaParaDensa(const real_t *ASP, int n)
+{
+    real_t *A = malloc((size_t) n * n * sizeof(real_t));
+    if (!A) return NULL;
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; ++i) {
+        real_t *linha = &A[(size_t) i * n];
+        memset(linha, 0, n * sizeof(real_t));
+        for (int diag_idx = 0; diag_idx < N_DIAG; diag_idx++) {
+            int j = i + diag_idx - OFFSET_CENTER;
+            if (j >= 0 && j < n) linha[j] = ASP[diag_idx * n + i];
+        }
+    }
+    return A;
+}
+
+// ========== Interface comum ==========
+
+operador_t *criaOperador(const char *formato, real_t *ASP, int n)
+{
+    if (strcmp(formato, "dia") == 0) return criaOperadorDIA(ASP, n);
+    if (strcmp(formato, "dia-fluxo") == 0) return criaOperadorDIAFluxo(ASP, n);
+    if (strcmp(formato, "dia-fantasma") == 0) return criaOperadorDIAFantasma(ASP, n);
+
+    if (strcmp(formato, "densa") == 0) {
+        real_t *A = diaParaDensa(ASP, n);
+        if (!A) {
+            printf("Erro: sem memória para a matriz densa (%zu bytes)\n", (size_t) n * n * sizeof(real_t));
+            return NULL;
+        }
+        operador_t *op = criaOperadorDensa(A, n);
+        if (!op) {
+            free(A);
+            return NULL;
+        }
+        op->dono = 1;
+        return op;
+    }
+
+    printf("Erro: formato '%s' desconhecido\n", formato);
+    return NULL;
+}
+
+void liberaOperador(operador_t *A)
+{
+    if (!A) return;
+    if (A->libera) A->libera(A);
+    free(A);
+}
+
+void residuoOperador(const operador_t *A, const real_t *b, const real_t *x, real_t *r)
+{
+    if (A->residuo) {
+        A->residuo(A, b, x, r);
+        return;
+    }
+
+    aplicaOperador(A, x, r);
+    #pragma omp parallel for schedule(static) if(A->n >= MIN_LINHAS_PARALELO)
+    for (int i = 0; i < A->n; ++i) r[i] = b[i] - r[i];
+}
+
+real_t *criaVetorOperador(const operador_t *A)
+{
+    const int margem = margemOperador(A);
+    size_t bytes = ((size_t) (A->n + 2 * margem) * sizeof(real_t) + 63) / 64 * 64;
+    real_t *base = aligned_alloc(64, bytes);
+    if (!base) return NULL;
+    memset(base, 0, bytes);
+    return base + margem;
+}
+
+void liberaVetorOperador(const operador_t *A, real_t *v)
+{
+    if (v) free(v - margemOperador(A));
+}
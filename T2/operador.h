@@ -0,0 +1,97 @@
+#ifndef __OPERADOR_H__
+#define __OPERADOR_H__
+
+#include "utils.h"
+
+/**
+ * Operador linear A (n x n) visto pelo solver apenas pelos seus produtos.
+ *
+ * Cada formato de armazenamento (backend) fornece 'aplica' (y = A x) e,
+ * opcionalmente, 'residuo' (r = b - A x numa passada só); o PCG, o CG
+ * deflacionado e o cálculo de resíduo só usam essas funções, então uma
+ * otimização do solver vale para todos os formatos e um formato novo
+ * só precisa implementar o seu produto.
+ */
+typedef struct operador_t operador_t;
+
+struct operador_t {
+    const char *formato;    // "dia", "dia-fluxo", "dia-fantasma", "densa"
+    int n;                  // dimensão
+    int fantasmas;          // posições que 'aplica' lê antes de x[0] e depois de x[n-1] (0 = nenhuma)
+    void *dados;            // matriz no formato do backend
+    int dono;               // 1 = 'dados' foi alocado pelo operador e é liberado com ele
+
+    void (*aplica)(const operador_t *A, const real_t *x, real_t *y);
+    void (*residuo)(const operador_t *A, const real_t *b, const real_t *x, real_t *r); // NULL: aplica + subtração (só sem fantasmas)
+    void (*libera)(operador_t *A);
+};
+
+// Formatos aceitos por criaOperador (terminado em NULL)
+extern const char *FORMATOS_OPERADOR[];
+
+// A no formato de diagonais (A[diag_idx * n + i], N_DIAG diagonais), sem cópia
+// (em fluxo, criaOperadorDIAFluxo, se não couber na última cache)
+operador_t *criaOperadorDIA(real_t *A, int n);
+
+/**
+ * Formato de diagonais em fluxo ("dia-fluxo"): a mesma A, sem cópia, com o
+ * SpMV e o resíduo por linhas. Cada y[i] é escrito uma vez, com store não
+ * temporal (y não é lido para a cache antes de ser escrito, nem a tira de lá),
+ * e as N_DIAG diagonais e x são pré-buscados DIST_PREFETCH_FLUXO linhas à
+ * frente. Mesmo resultado de "dia". criaOperadorDIA passa a ele sozinho quando
+ * A, x e y não cabem na última cache (usaFluxoDIA).
+ */
+#define DIST_PREFETCH_FLUXO 128
+operador_t *criaOperadorDIAFluxo(real_t *A, int n);
+int usaFluxoDIA(int n);
+
+// Núcleos do formato em fluxo, com a distância de prefetch em linhas (0 = sem prefetch)
+void spmvDIAFluxo(const real_t *A, const real_t *x, real_t *y, int n, int distancia);
+void residuoDIAFluxo(const real_t *A, const real_t *b, const real_t *x, real_t *r, int n, int distancia);
+
+// A densa n x n (A[i * n + j]), sem cópia; os blocos nulos são pulados nos produtos
+operador_t *criaOperadorDensa(real_t *A, int n);
+
+// Ap = A * p, A no formato de diagonais (o produto do backend "dia")
+void multDiagonais(real_t *A, real_t *p, real_t *Ap, int n);
+
+/**
+ * A no formato de diagonais com fantasmas: cópia de A com cada diagonal
+ * alinhada em 64 bytes e zeros onde a coluna sai da matriz. O produto lê
+ * x[i + offset] para todo i em [0, n), então x precisa de margemOperador(A)
+ * zeros de cada lado (criaVetorOperador) e todas as diagonais têm o mesmo
+ * laço alinhado, sem limites por diagonal.
+ */
+operador_t *criaOperadorDIAFantasma(const real_t *A, int n);
+
+/**
+ * Operador no formato pedido a partir da matriz no formato de diagonais:
+ * "dia" usa ASP diretamente; "dia-fantasma" copia ASP com as margens;
+ * "densa" monta a cópia n x n (n^2 reais).
+ * Retorna NULL para formato desconhecido ou falta de memória.
+ */
+operador_t *criaOperador(const char *formato, real_t *ASP, int n);
+
+void liberaOperador(operador_t *A);
+
+// y = A x (x com margemOperador(A) zeros de cada lado)
+static inline void aplicaOperador(const operador_t *A, const real_t *x, real_t *y)
+{
+    A->aplica(A, x, y);
+}
+
+// r = b - A x (x sem margens)
+void residuoOperador(const operador_t *A, const real_t *b, const real_t *x, real_t *r);
+
+// Zeros de cada lado dos vetores passados a 'aplica': os fantasmas arredondados
+// para 8 reais (64 bytes), então v[0] continua alinhado
+static inline int margemOperador(const operador_t *A)
+{
+    return (A->fantasmas + 7) / 8 * 8;
+}
+
+// Vetor de n reais zerado, alinhado e com as margens de A (liberado por liberaVetorOperador)
+real_t *criaVetorOperador(const operador_t *A);
+void liberaVetorOperador(const operador_t *A, real_t *v);
+
+#endif // __OPERADOR_H__
@@ -1,132 +1,528 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "utils.h"
 #include "sislin.h"
+#include "pcgc.h"
+#include "arena.h"
+#include "topologia.h"
+#include "operador.h"
+#include "reducao.h"
+#include "reciclagem.h"
+
+//Controle equivalente ao critério original: ||r||2 < eps em toda iteração
+const controleConvergencia_t CONTROLE_PADRAO = { CRITERIO_RESIDUO_ABS, 1, 0, 0.0, 0, 1e-15, NULL, NULL, NULL, 0, NULL, NULL };
+
+//Lê "abs|rel|inf|pre[,m]" (critério e intervalo entre testes)
+int leCriterio(const char *texto, controleConvergencia_t *ctl)
+{
+    static const char *nomes[] = { "abs", "rel", "inf", "pre" };
+    for (int c = 0; c < 4; c++) {
+        size_t tam = strlen(nomes[c]);
+        if (strncmp(texto, nomes[c], tam) != 0) continue;
+
+        ctl->criterio = (criterio_t) c;
+        ctl->intervalo = 1;
+        if (texto[tam] == ',') ctl->intervalo = atoi(texto + tam + 1);
+        else if (texto[tam] != '\0') return -1;
+        return (ctl->intervalo >= 1) ? 0 : -1;
+    }
+    return -1;
+}
+
+const char *descreveParada(motivoParada_t motivo)
+{
+    switch (motivo) {
+        case PARADA_CONVERGIU:  return "convergiu";
+        case PARADA_MAXIT:      return "atingiu maxit";
+        case PARADA_ESTAGNACAO: return "estagnação";
+        case PARADA_QUEBRA_PAP: return "quebra (p^T A p <= 0)";
+        case PARADA_QUEBRA_RZ:  return "quebra (r^T z <= 0, pré-condicionador não SPD)";
+        case PARADA_NAO_FINITO: return "quebra (valor não finito)";
+        case PARADA_DIVERGIU:   return "divergiu (lambda_max acima do intervalo do Chebyshev)";
+    }
+    return "?";
+}
 
 //gradiente Conjugado Pré condicionado
-int gradienteConjugado(real_t *A, real_t *b, real_t *x, int n, int maxit, double eps, real_t *M, real_t *normaFinal, rtime_t *tempoIter)
+int gradienteConjugado(const operador_t *A, real_t *b, real_t *x, int maxit, double eps, real_t *M, real_t *normaFinal, rtime_t *tempoIter)
 {
-    //constantes do formato dia
-    const int k_ASP = N_DIAG;       // 7
-    const int offset_center = OFFSET_CENTER; // 3
-
-    //alocação dos vetores auxiliares
-    real_t *r = malloc(n * sizeof(real_t));
-    real_t *z = malloc(n * sizeof(real_t));
-    real_t *p = malloc(n * sizeof(real_t));
-    real_t *Ap = malloc(n * sizeof(real_t));
-
-    if (!r || !z || !p || !Ap) return -1;
-
-    //calcular resíduo inicial,
-    
-    // Inicializa r com b
-    for(int i=0; i<n; ++i) r[i] = b[i];
-
-    // Subtrai A*x (Usando a lógica otimizada de diagonais)
-    for (int diag_idx = 0; diag_idx < k_ASP; diag_idx++) {
-        int offset = diag_idx - offset_center;
-        
-        // Calcula limites fora do loop para evitar IFs internos
-        int inicio = (offset < 0) ? -offset : 0;
-        int fim    = (offset > 0) ? n - offset : n;
-        
-        real_t *diagonal = &A[diag_idx * n]; // Ponteiro para o início da diagonal
+    controleConvergencia_t ctl = CONTROLE_PADRAO;
+    motivoParada_t motivo;
+    return gradienteConjugadoControle(A, b, x, maxit, eps, M, &ctl, &motivo, normaFinal, tempoIter);
+}
+
+size_t bytesTrabalhoPCG(int n, int margem, int reprodutivel)
+{
+    return 3 * tamanhoVetorArena(n) + tamanhoVetorArena(n + 2 * margem) +
+           (reprodutivel ? tamanhoVetorArena(blocosReducao(n)) : 0);
+}
+
+//Arena dos vetores auxiliares: a do chamador, reiniciada, se couber; senão uma própria
+static arena_t *arenaTrabalho(const controleConvergencia_t *ctl, size_t bytes)
+{
+    if (ctl->trabalho && ctl->trabalho->tamanho >= bytes) {
+        arenaReinicia(ctl->trabalho);
+        return ctl->trabalho;
+    }
+    return criaArena(bytes, ARENA_PAGINAS_ENORMES | ARENA_PRIMEIRO_TOQUE);
+}
 
-        // Loop "limpo" para o compilador vetorizar (Auto-vectorization)
-        for (int i = inicio; i < fim; i++) {
-            r[i] -= diagonal[i] * x[i + offset];
+//Zera as margens do vetor passado a aplicaOperador (numa arena reaproveitada, elas têm o
+//que outra chamada deixou ali)
+static inline void zeraMargens(real_t *v, int n, int margem)
+{
+    for (int i = 1; i <= margem; i++) v[-i] = v[n - 1 + i] = 0.0;
+}
+
+//Testa o valor monitorado: convergência, valor não finito e estagnação
+//(nenhuma redução de pelo menos (1 - fatorEstagnacao) nas últimas 'janelaEstagnacao' iterações)
+static inline int testaParada(const controleConvergencia_t *ctl, real_t valor, real_t limiar, int iter,
+                              real_t *melhor, int *iterMelhor, motivoParada_t *motivo)
+{
+    if (!isfinite(valor)) { *motivo = PARADA_NAO_FINITO; return 1; }
+    if (valor < limiar)   { *motivo = PARADA_CONVERGIU;  return 1; }
+
+    if (ctl->janelaEstagnacao > 0) {
+        if (valor < *melhor * ctl->fatorEstagnacao) {
+            *melhor = valor;
+            *iterMelhor = iter;
+        } else if (iter - *iterMelhor >= ctl->janelaEstagnacao) {
+            *motivo = PARADA_ESTAGNACAO;
+            return 1;
         }
     }
+    return 0;
+}
 
-    //Pré-condicionador -
-    for (int i = 0; i < n; i++) {
-        z[i] = (M != NULL) ? r[i] / M[i] : r[i];
-        p[i] = z[i];
+//gradiente Conjugado Pré condicionado com critério de parada configurável
+//||r||2 (com o peso do critério, se houver) fora do laço: valor em x0 e nas paradas por quebra
+static real_t normaResiduoControle(const real_t *r, const real_t *peso, int n, int reprodutivel, real_t *parciais)
+{
+    const int paralelo = (n >= MIN_LINHAS_PARALELO);
+    real_t soma = 0.0;
+    if (reprodutivel) {
+        SOMA_REPRODUTIVEL(soma, parciais, n, paralelo,
+                          s += peso ? (peso[i] * r[i]) * (peso[i] * r[i]) : r[i] * r[i];);
+    } else {
+        #pragma omp parallel for schedule(static) reduction(+:soma) if(paralelo)
+        for (int i = 0; i < n; i++) soma += peso ? (peso[i] * r[i]) * (peso[i] * r[i]) : r[i] * r[i];
     }
+    return sqrt(soma);
+}
 
-    //calculo do produto escalar inicial
-    real_t rz_old = 0.0;
-    for (int i = 0; i < n; i++) rz_old += r[i] * z[i];
+int gradienteConjugadoControle(const operador_t *A, real_t *b, real_t *x, int maxit, double eps, real_t *M,
+                               const controleConvergencia_t *ctl, motivoParada_t *motivo,
+                               real_t *normaFinal, rtime_t *tempoIter)
+{
+    const int n = A->n;
 
-    int iter;
-    *tempoIter = timestamp();
+    //loops paralelos com schedule(static): a divisão de linhas do primeiro toque
+    const int paralelo = (n >= MIN_LINHAS_PARALELO);
+
+    const criterio_t criterio = ctl->criterio;
+    const int porResiduo = (criterio == CRITERIO_RESIDUO_ABS || criterio == CRITERIO_RESIDUO_REL);
+    const real_t *peso = ctl->pesoResiduo;
+    const precondicionador_t *precond = ctl->precond;
+    const int reprodutivel = ctl->reprodutivel;
+    espectroCG_t *espectro = ctl->espectro;
+
+    //alocação dos vetores auxiliares: uma arena (um mmap) para os quatro e as somas parciais,
+    //ou a do chamador (ctl->trabalho), reaproveitada sem mmap nem primeiro toque
+    //p é o único vetor passado a aplicaOperador: leva as margens de zeros do formato
+    const int margem = margemOperador(A);
+    arena_t *trabalho = arenaTrabalho(ctl, bytesTrabalhoPCG(n, margem, reprodutivel));
+    if (!trabalho) return -1;
+
+    real_t *r = arenaVetor(trabalho, n);
+    //sem pré-condicionador z = r: nenhum vetor z nem passada de cópia
+    real_t *z = (M || precond) ? arenaVetor(trabalho, n) : r;
+    real_t *p = arenaVetor(trabalho, n + 2 * margem) + margem;
+    real_t *Ap = arenaVetor(trabalho, n);
+    zeraMargens(p, n, margem);
+    real_t *parciais = reprodutivel ? arenaVetor(trabalho, blocosReducao(n)) : NULL;
+
+    real_t pMax, rz_old, limiar, melhor;
+    real_t passo; // |alpha| ||p||_inf da última iteração (critério inf)
+    int iterMelhor, inicio = 0;
+    estadoCG_t estado;
+
+    if (ctl->checkpoint && leCheckpoint(ctl->checkpoint, x, r, p, &estado)) {
+        //retomada: o estado ao fim da iteração gravada, sem resíduo inicial
+        inicio = estado.iter;
+        rz_old = estado.rz_old;
+        pMax = estado.pMax;
+        limiar = estado.limiar;
+        melhor = estado.melhor;
+        iterMelhor = estado.iterMelhor;
+        *normaFinal = estado.normaFinal;
+        passo = estado.normaFinal;
+    } else {
+        //calcular resíduo inicial,
+
+        // r = b - A*x (numa passada quando o formato tem resíduo próprio)
+        residuoOperador(A, b, x, r);
+
+        //Pré-condicionador -
+        //||p||_inf acompanha p para o critério ||x - x_prev||_inf = |alpha| * ||p||_inf
+        if (precond) precond->aplica(precond->dados, r, z);
+        pMax = 0.0;
+        #pragma omp parallel for schedule(static) reduction(max:pMax) if(paralelo)
+        for (int i = 0; i < n; i++) {
+            if (M && !precond) z[i] = r[i] / M[i];
+            p[i] = z[i];
+            pMax = fmax(pMax, fabs(p[i]));
+        }
+
+        //calculo do produto escalar inicial
+        rz_old = 0.0;
+        if (reprodutivel) {
+            rz_old = produtoReprodutivel(r, z, n, parciais);
+        } else {
+            #pragma omp parallel for schedule(static) reduction(+:rz_old) if(paralelo)
+            for (int i = 0; i < n; i++) rz_old += r[i] * z[i];
+        }
+
+        //valor monitorado em x0 (única redução extra, fora do loop): é o que normaFinal informa
+        //se o PCG parar antes do primeiro teste; no critério relativo, ||r|| < eps * ||r0||
+        //(sem passo ainda no critério inf)
+        limiar = eps;
+        passo = INFINITY;
+        if (porResiduo) {
+            *normaFinal = normaResiduoControle(r, peso, n, reprodutivel, parciais);
+            if (criterio == CRITERIO_RESIDUO_REL) limiar = eps * *normaFinal;
+        } else {
+            *normaFinal = (criterio == CRITERIO_PRECOND) ? sqrt(rz_old) : passo;
+        }
+
+        melhor = INFINITY;
+        iterMelhor = 0;
+        estado.tempoIter = 0.0;
+    }
+    *motivo = PARADA_MAXIT;
+    if (espectro) espectro->nCoef = 0;
+
+    int iter, feitas = inicio;
+    //o tempo médio inclui as iterações anteriores à retomada
+    *tempoIter = timestamp() - estado.tempoIter;
 
     // Marcador LIKWID)
     LIKWID_MARKER_START("op1");
 
-    for (iter = 1; iter <= maxit; iter++) {
-        
-        //Loop externo nas diagonais
+    for (iter = inicio + 1; iter <= maxit; iter++) {
+        feitas = iter;
+        //o critério só é avaliado a cada ctl->intervalo iterações (e na última)
+        const int testa = (iter % ctl->intervalo == 0) || (iter == maxit);
         
-        //zera o vetor Ap
-        for(int i=0; i<n; ++i) Ap[i] = 0.0;
-
-        // acumula contribuição de cada diagonal
-        for (int diag_idx = 0; diag_idx < k_ASP; diag_idx++) {
-            int offset = diag_idx - offset_center;
-            
-            //Definição dos limites
-            int inicio = (offset < 0) ? -offset : 0;
-            int fim    = (offset > 0) ? n - offset : n;
-            
-            real_t *diagonal = &A[diag_idx * n];
-
-            //
-            for (int i = inicio; i < fim; i++) {
-                Ap[i] += diagonal[i] * p[i + offset];
-            }
-        }
+        //Ap = A * p
+        aplicaOperador(A, p, Ap);
 
         // produto escalar
         real_t pAp = 0.0;
-        for (int i = 0; i < n; i++) pAp += p[i] * Ap[i];
+        if (reprodutivel) {
+            pAp = produtoReprodutivel(p, Ap, n, parciais);
+        } else {
+            #pragma omp parallel for schedule(static) reduction(+:pAp) if(paralelo)
+            for (int i = 0; i < n; i++) pAp += p[i] * Ap[i];
+        }
 
-        // Verificação de divide por zero
-        if (fabs(pAp) < 1e-15) break; 
+        // Verificação de divide por zero (e de A não SPD, se pedido)
+        //(no modo estrito o limiar absoluto limiarQuebra não é usado: perto da convergência
+        //p^T A p fica legitimamente pequeno)
+        if (ctl->detectaQuebra ? !(pAp > 0.0) : fabs(pAp) < ctl->limiarQuebra) {
+            *motivo = isfinite(pAp) ? PARADA_QUEBRA_PAP : PARADA_NAO_FINITO;
+            //valor monitorado no x atual: o último teste pode ter sido iterações atrás
+            if (porResiduo) *normaFinal = normaResiduoControle(r, peso, n, reprodutivel, parciais);
+            else *normaFinal = (criterio == CRITERIO_PRECOND) ? sqrt(rz_old) : passo;
+            break;
+        }
 
         real_t alpha = rz_old / pAp;
+        passo = fabs(alpha) * pMax;
+        if (espectro && iter - inicio <= espectro->maxCoef) {
+            espectro->alphas[iter - inicio - 1] = alpha;
+            espectro->nCoef = iter - inicio;
+        }
+
+        //r^T r desta iteração, quando a norma sem peso já o calculou (reaproveitado sem M)
+        real_t rr = -1.0;
 
         // Atualizade X e R
-        real_t norma_r_sq = 0.0;
-        for (int i = 0; i < n; i++) {
-            x[i] += alpha * p[i];
-            r[i] -= alpha * Ap[i];
-            norma_r_sq += r[i] * r[i];
-        }
+        if (porResiduo && testa) {
+            //||r||2 aproveita a passada de atualização de r
+            real_t norma_r_sq = 0.0;
+            if (reprodutivel && peso) {
+                SOMA_REPRODUTIVEL(norma_r_sq, parciais, n, paralelo,
+                                  x[i] += alpha * p[i];
+                                  r[i] -= alpha * Ap[i];
+                                  s += (peso[i] * r[i]) * (peso[i] * r[i]););
+            } else if (reprodutivel) {
+                SOMA_REPRODUTIVEL(norma_r_sq, parciais, n, paralelo,
+                                  x[i] += alpha * p[i];
+                                  r[i] -= alpha * Ap[i];
+                                  s += r[i] * r[i];);
+                rr = norma_r_sq;
+            } else if (peso) {
+                #pragma omp parallel for schedule(static) reduction(+:norma_r_sq) if(paralelo)
+                for (int i = 0; i < n; i++) {
+                    x[i] += alpha * p[i];
+                    r[i] -= alpha * Ap[i];
+                    norma_r_sq += (peso[i] * r[i]) * (peso[i] * r[i]);
+                }
+            } else {
+                #pragma omp parallel for schedule(static) reduction(+:norma_r_sq) if(paralelo)
+                for (int i = 0; i < n; i++) {
+                    x[i] += alpha * p[i];
+                    r[i] -= alpha * Ap[i];
+                    norma_r_sq += r[i] * r[i];
+                }
+                rr = norma_r_sq;
+            }
 
-        real_t norma_r = sqrt(norma_r_sq);
-        *normaFinal = norma_r;
+            real_t norma_r = sqrt(norma_r_sq);
+            *normaFinal = norma_r;
 
-        // critério de parada
-        if (norma_r < eps) break;
+            // critério de parada
+            if (testaParada(ctl, norma_r, limiar, iter, &melhor, &iterMelhor, motivo)) break;
+        } else {
+            //sem teste nesta iteração: nenhuma redução
+            #pragma omp parallel for schedule(static) if(paralelo)
+            for (int i = 0; i < n; i++) {
+                x[i] += alpha * p[i];
+                r[i] -= alpha * Ap[i];
+            }
+        }
+
+        if (criterio == CRITERIO_NORMA_INF_X && testa) {
+            *normaFinal = passo;
+            if (testaParada(ctl, passo, limiar, iter, &melhor, &iterMelhor, motivo)) break;
+        }
 
-        // Aplica Precondicionador 
-        if (M) {
+        // Aplica Precondicionador (sem M, z = r)
+        if (precond) {
+            precond->aplica(precond->dados, r, z);
+        } else if (M) {
+            #pragma omp parallel for schedule(static) if(paralelo)
             for (int i = 0; i < n; i++) z[i] = r[i] / M[i];
-        } else {
-            for (int i = 0; i < n; i++) z[i] = r[i];
         }
 
         //calculo de Beta
         real_t rz_new = 0.0;
-        for (int i = 0; i < n; i++) rz_new += r[i] * z[i];
+        if ((M || precond || rr < 0.0) && reprodutivel) {
+            rz_new = produtoReprodutivel(r, z, n, parciais);
+        } else if (M || precond || rr < 0.0) {
+            #pragma omp parallel for schedule(static) reduction(+:rz_new) if(paralelo)
+            for (int i = 0; i < n; i++) rz_new += r[i] * z[i];
+        } else {
+            rz_new = rr;
+        }
+
+        if (ctl->detectaQuebra && !(rz_new > 0.0)) {
+            //r^T z == 0 com M SPD significa r == 0
+            *motivo = (rz_new == 0.0) ? PARADA_CONVERGIU : isfinite(rz_new) ? PARADA_QUEBRA_RZ : PARADA_NAO_FINITO;
+            //x e r já avançaram nesta iteração, sem teste se !testa
+            if (porResiduo && !testa) *normaFinal = normaResiduoControle(r, peso, n, reprodutivel, parciais);
+            else if (criterio == CRITERIO_PRECOND) *normaFinal = sqrt(fabs(rz_new));
+            else if (!porResiduo) *normaFinal = passo;
+            break;
+        }
+
+        //norma pré-condicionada sqrt(r^T M^-1 r): reaproveita rz, custo zero
+        if (criterio == CRITERIO_PRECOND && testa) {
+            real_t norma_z = sqrt(rz_new);
+            *normaFinal = norma_z;
+            if (testaParada(ctl, norma_z, limiar, iter, &melhor, &iterMelhor, motivo)) break;
+        }
 
         real_t beta = rz_new / rz_old;
         rz_old = rz_new;
+        if (espectro && iter - inicio <= espectro->maxCoef) espectro->betas[iter - inicio - 1] = beta;
 
         //atualiza direção p
-        for (int i = 0; i < n; i++) {
-            p[i] = z[i] + beta * p[i];
+        if (criterio == CRITERIO_NORMA_INF_X) {
+            pMax = 0.0;
+            #pragma omp parallel for schedule(static) reduction(max:pMax) if(paralelo)
+            for (int i = 0; i < n; i++) {
+                p[i] = z[i] + beta * p[i];
+                pMax = fmax(pMax, fabs(p[i]));
+            }
+        } else {
+            #pragma omp parallel for schedule(static) if(paralelo)
+            for (int i = 0; i < n; i++) {
+                p[i] = z[i] + beta * p[i];
+            }
+        }
+
+        //x, r, p e os escalares formam o estado completo ao fim da iteração
+        if (ctl->checkpoint) {
+            estadoCG_t ponto = { iter, iterMelhor, rz_old, pMax, limiar, melhor, *normaFinal, timestamp() - *tempoIter };
+            pontoCheckpoint(ctl->checkpoint, x, r, p, &ponto);
+        }
+    }
+
+    LIKWID_MARKER_STOP("op1");
+
+    //'feitas' conta as iterações iniciadas (sem o maxit+1 da saída natural do for)
+    *tempoIter = timestamp() - *tempoIter;
+    if (feitas > 0) *tempoIter = *tempoIter / feitas;
+
+    if (trabalho != ctl->trabalho) liberaArena(trabalho);
+    return feitas;
+}
+
+//Valores de Ritz extremos da tridiagonal de Lanczos dos coeficientes do PCG
+int estimaEspectro(const espectroCG_t *E, real_t *lambdaMin, real_t *lambdaMax)
+{
+    const int m = E->nCoef;
+    if (m < 2) return -1;
+    //alpha_j > 0 e beta_j > 0 com A e M SPD (beta de m - 1 pode não ter sido calculado)
+    for (int j = 0; j < m; j++)
+        if (!(E->alphas[j] > 0.0) || (j < m - 1 && !(E->betas[j] > 0.0))) return -1;
+
+    real_t *ritz = malloc(m * sizeof(real_t));
+    if (!ritz) return -1;
+    int status = autovaloresLanczos(m, E->alphas, E->betas, ritz, NULL);
+    if (!status) {
+        *lambdaMin = ritz[0];
+        *lambdaMax = ritz[m - 1];
+    }
+    free(ritz);
+    return status;
+}
+
+//Iteração de Chebyshev pré-condicionada: a recorrência do suavizador do AMG, sem produtos escalares
+int iteracaoChebyshev(const operador_t *A, real_t *b, real_t *x, int maxit, double eps, real_t *M,
+                      real_t lambdaMin, real_t lambdaMax, const controleConvergencia_t *ctl,
+                      motivoParada_t *motivo, real_t *normaFinal, rtime_t *tempoIter)
+{
+    const int n = A->n;
+    const int paralelo = (n >= MIN_LINHAS_PARALELO);
+
+    const criterio_t criterio = ctl->criterio;
+    const real_t *peso = ctl->pesoResiduo;
+    const precondicionador_t *precond = ctl->precond;
+    const int reprodutivel = ctl->reprodutivel;
+
+    if (!(lambdaMin > 0.0 && lambdaMax > lambdaMin) || criterio == CRITERIO_PRECOND) return -1;
+
+    //d é o vetor passado a aplicaOperador: leva as margens de zeros do formato
+    //z só com o pré-condicionador geral; o diagonal entra na passada de d
+    const int margem = margemOperador(A);
+    arena_t *trabalho = arenaTrabalho(ctl, bytesTrabalhoPCG(n, margem, reprodutivel));
+    if (!trabalho) return -1;
+
+    real_t *r = arenaVetor(trabalho, n);
+    real_t *z = precond ? arenaVetor(trabalho, n) : NULL;
+    real_t *d = arenaVetor(trabalho, n + 2 * margem) + margem;
+    real_t *Ad = arenaVetor(trabalho, n);
+    zeraMargens(d, n, margem);
+    real_t *parciais = reprodutivel ? arenaVetor(trabalho, blocosReducao(n)) : NULL;
+
+    //centro e meia largura do intervalo
+    const real_t theta = 0.5 * (lambdaMax + lambdaMin);
+    const real_t delta = 0.5 * (lambdaMax - lambdaMin);
+    const real_t sigma = theta / delta;
+    real_t rhoK = 1.0 / sigma;
+
+    // r = b - A*x e d_0 = M^-1 r / theta
+    residuoOperador(A, b, x, r);
+    if (precond) precond->aplica(precond->dados, r, z);
+    #pragma omp parallel for schedule(static) if(paralelo)
+    for (int i = 0; i < n; i++) d[i] = (precond ? z[i] : M ? r[i] / M[i] : r[i]) / theta;
+
+    //critério relativo: ao resíduo do início desta chamada
+    real_t limiar = eps;
+    if (criterio == CRITERIO_RESIDUO_REL) {
+        real_t r0 = 0.0;
+        if (reprodutivel) {
+            SOMA_REPRODUTIVEL(r0, parciais, n, paralelo,
+                              s += peso ? (peso[i] * r[i]) * (peso[i] * r[i]) : r[i] * r[i];);
+        } else {
+            #pragma omp parallel for schedule(static) reduction(+:r0) if(paralelo)
+            for (int i = 0; i < n; i++) r0 += peso ? (peso[i] * r[i]) * (peso[i] * r[i]) : r[i] * r[i];
+        }
+        limiar = eps * sqrt(r0);
+    }
+
+    real_t melhor = INFINITY, menor = INFINITY;
+    int iterMelhor = 0;
+    *motivo = PARADA_MAXIT;
+
+    int iter, feitas = 0;
+    *tempoIter = timestamp();
+
+    LIKWID_MARKER_START("op1");
+
+    for (iter = 1; iter <= maxit; iter++) {
+        feitas = iter;
+        const int testa = (iter % ctl->intervalo == 0) || (iter == maxit);
+
+        //Ad = A * d
+        aplicaOperador(A, d, Ad);
+
+        //coeficientes da próxima direção: só dependem do intervalo
+        const real_t rhoN = 1.0 / (2.0 * sigma - rhoK);
+        const real_t c1 = rhoN * rhoK, c2 = 2.0 * rhoN / delta;
+        rhoK = rhoN;
+
+        //x += d, r -= A d e (sem o pré-condicionador geral) d = c1 d + c2 M^-1 r, numa passada
+#define PASSO_CHEBYSHEV                                                     \
+        x[i] += d[i];                                                       \
+        r[i] -= Ad[i];                                                      \
+        if (!precond) d[i] = c1 * d[i] + c2 * (M ? r[i] / M[i] : r[i]);
+
+        real_t valor = 0.0;
+        if (testa && criterio == CRITERIO_NORMA_INF_X) {
+            //||x - x_prev||_inf = ||d||_inf, antes de d mudar
+            #pragma omp parallel for schedule(static) reduction(max:valor) if(paralelo)
+            for (int i = 0; i < n; i++) {
+                valor = fmax(valor, fabs(d[i]));
+                PASSO_CHEBYSHEV
+            }
+        } else if (testa && reprodutivel) {
+            SOMA_REPRODUTIVEL(valor, parciais, n, paralelo,
+                              PASSO_CHEBYSHEV
+                              s += peso ? (peso[i] * r[i]) * (peso[i] * r[i]) : r[i] * r[i];);
+            valor = sqrt(valor);
+        } else if (testa) {
+            #pragma omp parallel for schedule(static) reduction(+:valor) if(paralelo)
+            for (int i = 0; i < n; i++) {
+                PASSO_CHEBYSHEV
+                valor += peso ? (peso[i] * r[i]) * (peso[i] * r[i]) : r[i] * r[i];
+            }
+            valor = sqrt(valor);
+        } else {
+            //sem teste nesta iteração: nenhuma redução
+            #pragma omp parallel for schedule(static) if(paralelo)
+            for (int i = 0; i < n; i++) {
+                PASSO_CHEBYSHEV
+            }
+        }
+#undef PASSO_CHEBYSHEV
+
+        if (precond) {
+            precond->aplica(precond->dados, r, z);
+            #pragma omp parallel for schedule(static) if(paralelo)
+            for (int i = 0; i < n; i++) d[i] = c1 * d[i] + c2 * z[i];
+        }
+
+        if (testa) {
+            *normaFinal = valor;
+            if (testaParada(ctl, valor, limiar, iter, &melhor, &iterMelhor, motivo)) break;
+            if (valor > FATOR_DIVERGENCIA * menor) {
+                *motivo = PARADA_DIVERGIU;
+                break;
+            }
+            menor = fmin(menor, valor);
         }
     }
 
     LIKWID_MARKER_STOP("op1");
 
     *tempoIter = timestamp() - *tempoIter;
-    if (iter > 0) *tempoIter = *tempoIter / iter;
+    if (feitas > 0) *tempoIter = *tempoIter / feitas;
 
-    free(r); free(z); free(p); free(Ap);
-    return iter;
-}
\ No newline at end of file
+    if (trabalho != ctl->trabalho) liberaArena(trabalho);
+    return feitas;
+}
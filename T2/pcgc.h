@@ -2,25 +2,160 @@
 #define PCGC_H
 
 #include "utils.h"
+#include "operador.h"
+#include "checkpoint.h"
+#include "arena.h"
 
 /**
  * Conjugate Gradient pré-condicionado (suporta M=NULL ou M=diagonal)
  *
- * A: matriz ASC (n*n) armazenada linearmente (A[i*n + j])
+ * A: operador (n x n) em qualquer formato de operador.h; o PCG só usa A x e b - A x
  * b: vetor RHS (n)
- * x: vetor solução (entrada: inicial guess; saída: solução). Aqui assumimos x inicial = 0.
- * n: dimensão
- * k: número de diagonais (ímpar)
- * eps: tolerância (critério ||x - x_prev||_inf < eps)
+ * x: vetor solução (entrada: inicial guess; saída: solução). O cgSolver parte de x = 0, de -x arquivo ou do cache de soluções.
+ * eps: tolerância (critério ||r||2 < eps; ver gradienteConjugadoControle para os demais)
  * maxit: número máximo de iterações
  * residuo_out: saída (norma L2 do resíduo final)
- * M: ponteiro para pré-condicionador. Se NULL -> M = I. Caso Jacobi, M aponta para vetor de dimensão n contendo os elementos da diagonal (D_i).
+ * M: ponteiro para pré-condicionador. Se NULL -> M = I, sem o vetor z (z = r). Caso Jacobi, M aponta para vetor de dimensão n contendo os elementos da diagonal (D_i).
  * norma_inf_out: saída (norma infinita entre últimas iterações)
  *
  * Retorna: número de iterações realizadas (>0) em caso de sucesso,
  *          0 se solução inicial já é correta (r==0),
  *         -1 em caso de quebra numérica (p^T A p == 0 ou divisão por zero no pré-condicionador).
  */
-int gradienteConjugado(real_t *A, real_t *b, real_t *x, int n, int maxit, double eps, real_t *M, real_t *normaFinal, rtime_t *tempoIter);
+int gradienteConjugado(const operador_t *A, real_t *b, real_t *x, int maxit, double eps, real_t *M, real_t *normaFinal, rtime_t *tempoIter);
+
+// Critérios de parada do PCG
+typedef enum {
+    CRITERIO_RESIDUO_ABS, // ||r||2 < eps (original)
+    CRITERIO_RESIDUO_REL, // ||r||2 < eps * ||r0||2
+    CRITERIO_NORMA_INF_X, // ||x - x_prev||_inf = |alpha| * ||p||_inf < eps
+    CRITERIO_PRECOND      // sqrt(r^T M^-1 r) < eps (reaproveita rz, sem redução extra)
+} criterio_t;
+
+// Motivo pelo qual o PCG parou
+typedef enum {
+    PARADA_CONVERGIU,
+    PARADA_MAXIT,
+    PARADA_ESTAGNACAO,
+    PARADA_QUEBRA_PAP,  // p^T A p <= 0 (A não SPD) ou, no teste original, |p^T A p| < 1e-15
+    PARADA_QUEBRA_RZ,   // r^T z < 0 (pré-condicionador não SPD)
+    PARADA_NAO_FINITO,  // NaN/Inf
+    PARADA_DIVERGIU     // Chebyshev: o valor cresceu FATOR_DIVERGENCIA vezes (intervalo curto demais)
+} motivoParada_t;
+
+/**
+ * Pré-condicionador geral: z = M^-1 r por uma função (AMG, Jacobi em blocos),
+ * no lugar do M diagonal. Precisa ser simétrico positivo definido; 'dados' é o
+ * estado do pré-condicionador.
+ */
+typedef struct {
+    void (*aplica)(void *dados, const real_t *r, real_t *z);
+    void *dados;
+} precondicionador_t;
+
+/**
+ * Coeficientes alpha_j e beta_j do PCG (até maxCoef iterações). Definem a
+ * tridiagonal de Lanczos de M^-1 A (autovaloresLanczos, reciclagem.h): os
+ * valores de Ritz extremos estimam lambdaMin e lambdaMax (estimaEspectro).
+ * Registrá-los custa dois escalares por iteração.
+ */
+typedef struct {
+    int maxCoef, nCoef;
+    real_t *alphas, *betas;
+} espectroCG_t;
+
+/**
+ * Controle de convergência do PCG
+ *
+ * criterio: valor monitorado (ver criterio_t)
+ * intervalo: o critério é testado a cada 'intervalo' iterações; nas demais o
+ *            loop não faz a redução de ||r||2
+ * janelaEstagnacao: para se o valor monitorado não cair abaixo de
+ *            fatorEstagnacao * (melhor valor) em tantas iterações (0 = desligado)
+ * detectaQuebra: 1 = para em p^T A p <= 0 ou r^T z <= 0; 0 = só |p^T A p| < limiarQuebra (original)
+ *            (o resíduo do CG não é monótono: janelas curtas podem parar cedo demais)
+ * limiarQuebra: limiar de |p^T A p| sem detectaQuebra (1e-15 no padrão; o solver da
+ *            raiz usa DBL_EPSILON, o do seu PCG denso)
+ * pesoResiduo: NULL ou w; os critérios de resíduo medem ||w .* r||2. Com a escala
+ *            simétrica (w = D^1/2) é o resíduo do sistema original
+ * checkpoint: NULL ou arquivo de checkpoint; se tiver um estado gravado, o PCG
+ *            continua dele (x de entrada ignorado) e grava pontos periódicos
+ * precond: NULL ou pré-condicionador geral; z = aplica(r) no lugar de z = r / M
+ * reprodutivel: 1 = produtos escalares e normas por SOMA_REPRODUTIVEL (reducao.h): iterações e
+ *            normaFinal iguais bit a bit com qualquer número de threads; 0 = reduction(+) do OpenMP
+ * espectro: NULL ou onde registrar alpha/beta de cada iteração (nCoef é zerado no início)
+ * trabalho: NULL (cada chamada mapeia e libera a sua arena) ou a arena dos vetores auxiliares,
+ *           reiniciada a cada chamada e reaproveitada entre as resoluções (bytesTrabalhoPCG)
+ */
+typedef struct {
+    criterio_t criterio;
+    int intervalo;
+    int janelaEstagnacao;
+    double fatorEstagnacao;
+    int detectaQuebra;
+    double limiarQuebra;
+    const real_t *pesoResiduo;
+    checkpoint_t *checkpoint;
+    const precondicionador_t *precond;
+    int reprodutivel;
+    espectroCG_t *espectro;
+    arena_t *trabalho;
+} controleConvergencia_t;
+
+// ||r||2 < eps testado a cada iteração, sem estagnação: o comportamento de gradienteConjugado
+extern const controleConvergencia_t CONTROLE_PADRAO;
+
+/**
+ * PCG com critério de parada configurável. normaFinal recebe o último valor
+ * monitorado e motivo, a razão da parada. Retorna o número de iterações ou -1.
+ */
+int gradienteConjugadoControle(const operador_t *A, real_t *b, real_t *x, int maxit, double eps, real_t *M,
+                               const controleConvergencia_t *ctl, motivoParada_t *motivo,
+                               real_t *normaFinal, rtime_t *tempoIter);
+
+// Bytes dos vetores auxiliares de gradienteConjugadoControle e iteracaoChebyshev para n
+// linhas, um operador com 'margem' (margemOperador) e somas reprodutíveis ou não
+size_t bytesTrabalhoPCG(int n, int margem, int reprodutivel);
+
+// Folga sobre lambdaMax: o maior valor de Ritz subestima o maior autovalor, e o Chebyshev
+// diverge com autovalores acima do intervalo (abaixo dele só converge mais devagar)
+#define FOLGA_LAMBDA_MAX 1.1
+#define FATOR_DIVERGENCIA 100.0 // Chebyshev: crescimento sobre o menor valor testado que é divergência
+#define ITER_ESPECTRO 20 // iterações do PCG que estimam o intervalo do Chebyshev (padrão)
+
+/**
+ * lambdaMin e lambdaMax de M^-1 A pelos valores de Ritz extremos dos nCoef
+ * coeficientes registrados. Retorna 0, ou -1 com menos de 2 coeficientes,
+ * coeficientes não positivos (A ou M não SPD) ou se o QL não convergir.
+ */
+int estimaEspectro(const espectroCG_t *E, real_t *lambdaMin, real_t *lambdaMax);
+
+/**
+ * Iteração de Chebyshev pré-condicionada (Saad, alg. 12.1) para M^-1 A com
+ * espectro em [lambdaMin, lambdaMax] (0 < lambdaMin < lambdaMax):
+ *   x_{k+1} = x_k + d_k,  r_{k+1} = r_k - A d_k,  d_{k+1} = c1 d_k + c2 M^-1 r_{k+1}
+ * com c1 e c2 da recorrência de Chebyshev, que só dependem do intervalo.
+ *
+ * Nenhum produto escalar: cada iteração é o SpMV e uma passada local (com M
+ * diagonal, x, r e d na mesma). A única redução é a do critério, a cada
+ * ctl->intervalo iterações (e na última): sem ela, as threads (ou processos)
+ * não se sincronizam no loop. Custo: converge como o CG no pior caso do
+ * intervalo, sem a adaptação ao espectro do CG.
+ *
+ * ctl: critérios abs, rel (relativo ao resíduo inicial desta chamada) e inf
+ * (||d||_inf), intervalo, estagnação, pesoResiduo, precond e reprodutivel; o
+ * checkpoint e o espectro não são usados. Com lambdaMax abaixo do maior
+ * autovalor o método diverge: o valor testado passa de FATOR_DIVERGENCIA vezes
+ * o menor já visto e a chamada para com PARADA_DIVERGIU (x e o resíduo ainda
+ * finitos: quem chama pode continuar com um intervalo maior). Retorna o número
+ * de iterações ou -1.
+ */
+int iteracaoChebyshev(const operador_t *A, real_t *b, real_t *x, int maxit, double eps, real_t *M,
+                      real_t lambdaMin, real_t lambdaMax, const controleConvergencia_t *ctl,
+                      motivoParada_t *motivo, real_t *normaFinal, rtime_t *tempoIter);
+
+// Lê "abs|rel|inf|pre[,m]" em ctl (m = intervalo entre testes). Retorna 0 ou -1.
+int leCriterio(const char *texto, controleConvergencia_t *ctl);
+const char *descreveParada(motivoParada_t motivo);
 
 #endif
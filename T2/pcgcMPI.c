@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <mpi.h>
+#include "utils.h"
+#include "sislin.h"
+#include "pcgcMPI.h"
+
+#define TAG_ESQUERDA 0 // mensagem com as primeiras linhas do bloco (vai para rank-1)
+#define TAG_DIREITA  1 // mensagem com as últimas linhas do bloco (vai para rank+1)
+
+//Divide as n linhas em blocos contíguos
+void particionaLinhas(int n, MPI_Comm comm, blocoMPI_t *bloco)
+{
+    MPI_Comm_rank(comm, &bloco->rank);
+    MPI_Comm_size(comm, &bloco->nprocs);
+
+    int base  = n / bloco->nprocs;
+    int resto = n % bloco->nprocs;
+
+    bloco->n = n;
+    bloco->comm = comm;
+    bloco->nLocal = base + (bloco->rank < resto ? 1 : 0);
+    bloco->inicio = bloco->rank * base + (bloco->rank < resto ? bloco->rank : resto);
+}
+
+//Inicia a troca de halo de v (h elementos fantasmas de cada lado: v[-h..-1] e v[nLocal..nLocal+h-1]).
+//Nas bordas globais o vizinho é MPI_PROC_NULL e os fantasmas continuam zerados.
+static void iniciaHalo(const blocoMPI_t *bloco, real_t *v, int h, MPI_Request req[4])
+{
+    int nL = bloco->nLocal;
+    int esq = (bloco->rank > 0) ? bloco->rank - 1 : MPI_PROC_NULL;
+    int dir = (bloco->rank < bloco->nprocs - 1) ? bloco->rank + 1 : MPI_PROC_NULL;
+
+    MPI_Irecv(v - h,      h, MPI_DOUBLE, esq, TAG_DIREITA,  bloco->comm, &req[0]);
+    MPI_Irecv(v + nL,     h, MPI_DOUBLE, dir, TAG_ESQUERDA, bloco->comm, &req[1]);
+    MPI_Isend(v,          h, MPI_DOUBLE, esq, TAG_ESQUERDA, bloco->comm, &req[2]);
+    MPI_Isend(v + nL - h, h, MPI_DOUBLE, dir, TAG_DIREITA,  bloco->comm, &req[3]);
+}
+
+//Ap[i] = sum_d A[d][i] * p[i + offset_d] para as linhas locais [i0, i1).
+//Loop por linha (todas as diagonais de uma vez) para dividir as linhas entre threads;
+//N_DIAG é constante, então o loop interno é desenrolado e o externo vetorizado.
+static inline void spmvLinhas(const real_t *A, const real_t *p, real_t *Ap, int nL, int i0, int i1)
+{
+    #pragma omp parallel for schedule(static) if (i1 - i0 > 4096)
+    for (int i = i0; i < i1; ++i) {
+        real_t soma = 0.0;
+        for (int diag_idx = 0; diag_idx < N_DIAG; ++diag_idx)
+            soma += A[diag_idx * nL + i] * p[i + diag_idx - OFFSET_CENTER];
+        Ap[i] = soma;
+    }
+}
+
+//SpMV distribuído: linhas internas são calculadas enquanto o halo de p trafega;
+//as OFFSET_CENTER linhas de cada borda do bloco esperam a troca terminar.
+static void spmvDistribuido(const blocoMPI_t *bloco, const real_t *A, real_t *p, real_t *Ap)
+{
+    const int h = OFFSET_CENTER;
+    const int nL = bloco->nLocal;
+    MPI_Request req[4];
+
+    iniciaHalo(bloco, p, h, req);
+
+    spmvLinhas(A, p, Ap, nL, h, nL - h);
+
+    MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
+
+    spmvLinhas(A, p, Ap, nL, 0, h);
+    spmvLinhas(A, p, Ap, nL, (nL - h > h) ? nL - h : h, nL);
+}
+
+//gradiente Conjugado Pré condicionado distribuído
+int gradienteConjugadoMPI(const blocoMPI_t *bloco, real_t *A, real_t *b, real_t *x, int maxit, double eps, real_t *M, real_t *normaFinal, rtime_t *tempoIter)
+{
+    const int nL = bloco->nLocal;
+    const int h = OFFSET_CENTER;
+
+    if (nL < h) {
+        printf("Erro: bloco com %d linhas é menor que o halo (%d)\n", nL, h);
+        return -1;
+    }
+
+    //p carrega h fantasmas de cada lado para receber o halo dos vizinhos
+    real_t *r = malloc(nL * sizeof(real_t));
+    real_t *z = malloc(nL * sizeof(real_t));
+    real_t *Ap = malloc(nL * sizeof(real_t));
+    real_t *pExt = calloc(nL + 2 * h, sizeof(real_t));
+
+    if (!r || !z || !Ap || !pExt) {
+        free(r); free(z); free(Ap); free(pExt);
+        return -1;
+    }
+    real_t *p = pExt + h;
+
+    //resíduo inicial r = b - A*x (p é usado como área de troca para x)
+    for (int i = 0; i < nL; ++i) p[i] = x[i];
+    spmvDistribuido(bloco, A, p, Ap);
+
+    real_t rzLocal = 0.0, rz_old = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:rzLocal)
+    for (int i = 0; i < nL; ++i) {
+        r[i] = b[i] - Ap[i];
+        z[i] = (M != NULL) ? r[i] / M[i] : r[i];
+        p[i] = z[i];
+        rzLocal += r[i] * z[i];
+    }
+    MPI_Allreduce(&rzLocal, &rz_old, 1, MPI_DOUBLE, MPI_SUM, bloco->comm);
+
+    int iter;
+    MPI_Barrier(bloco->comm);
+    *tempoIter = timestamp();
+
+    LIKWID_MARKER_START("op1");
+
+    for (iter = 1; iter <= maxit; iter++) {
+
+        spmvDistribuido(bloco, A, p, Ap);
+
+        real_t pApLocal = 0.0, pAp = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:pApLocal)
+        for (int i = 0; i < nL; i++) pApLocal += p[i] * Ap[i];
+        MPI_Allreduce(&pApLocal, &pAp, 1, MPI_DOUBLE, MPI_SUM, bloco->comm);
+
+        // Verificação de divide por zero
+        if (fabs(pAp) < 1e-15) break;
+
+        real_t alpha = rz_old / pAp;
+
+        //atualiza x e r, aplica o pré-condicionador e acumula r.r e r.z no mesmo
+        //passo: as duas reduções globais viram um único Allreduce
+        real_t rrLocal = 0.0;
+        rzLocal = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:rrLocal,rzLocal)
+        for (int i = 0; i < nL; i++) {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * Ap[i];
+            z[i] = (M != NULL) ? r[i] / M[i] : r[i];
+            rrLocal += r[i] * r[i];
+            rzLocal += r[i] * z[i];
+        }
+
+        real_t local[2] = { rrLocal, rzLocal }, global[2];
+        MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_SUM, bloco->comm);
+
+        real_t norma_r = sqrt(global[0]);
+        *normaFinal = norma_r;
+
+        // critério de parada
+        if (norma_r < eps) break;
+
+        real_t beta = global[1] / rz_old;
+        rz_old = global[1];
+
+        //atualiza direção p
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < nL; i++)
+            p[i] = z[i] + beta * p[i];
+    }
+
+    LIKWID_MARKER_STOP("op1");
+
+    if (iter > maxit) iter = maxit;
+    *tempoIter = timestamp() - *tempoIter;
+    if (iter > 0) *tempoIter = *tempoIter / iter;
+
+    free(r); free(z); free(Ap); free(pExt);
+    return iter;
+}
+
+//Calcula a norma do resíduo ||b - A*X||2 do SL original, distribuído
+real_t calcResiduoSLMPI(const blocoMPI_t *bloco, real_t *A, real_t *b, real_t *X, int k, rtime_t *tempo)
+{
+    rtime_t t0 = timestamp();
+
+    LIKWID_MARKER_START("op2");
+
+    const int nL = bloco->nLocal;
+    const int d = (k - 1) / 2; //raio de banda = tamanho do halo de X
+
+    real_t *xExt = calloc(nL + 2 * d, sizeof(real_t));
+    if (!xExt) return -1.0;
+    real_t *x = xExt + d;
+    for (int i = 0; i < nL; ++i) x[i] = X[i];
+
+    MPI_Request req[4];
+    iniciaHalo(bloco, x, d, req);
+    MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
+
+    //posições fora da matriz são zero em A e nos fantasmas: sem testes de borda
+    real_t somaLocal = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:somaLocal)
+    for (int i = 0; i < nL; ++i) {
+        real_t ri = b[i];
+        for (int diag_idx = 0; diag_idx < k; ++diag_idx)
+            ri -= A[diag_idx * nL + i] * x[i + diag_idx - d];
+        somaLocal += ri * ri;
+    }
+
+    real_t soma = 0.0;
+    MPI_Allreduce(&somaLocal, &soma, 1, MPI_DOUBLE, MPI_SUM, bloco->comm);
+
+    LIKWID_MARKER_STOP("op2");
+
+    free(xExt);
+    *tempo = timestamp() - t0;
+    return sqrt(soma);
+}
@@ -0,0 +1,43 @@
+#ifndef __PCGCMPI_H__
+#define __PCGCMPI_H__
+
+#include <mpi.h>
+#include "utils.h"
+
+/**
+ * Bloco de linhas de um processo MPI.
+ *
+ * As linhas do SL são divididas em blocos contíguos: o processo 'rank' possui
+ * as linhas globais [inicio, inicio + nLocal) e a fatia correspondente de cada
+ * diagonal (layout local A[diag_idx * nLocal + i]).
+ */
+typedef struct {
+    int n;          // dimensão global do SL
+    int nLocal;     // número de linhas deste processo
+    int inicio;     // primeira linha global do bloco
+    int rank;       // identificador do processo
+    int nprocs;     // número de processos
+    MPI_Comm comm;  // comunicador
+} blocoMPI_t;
+
+// Divide n linhas em blocos contíguos (os primeiros n % nprocs ficam com uma linha a mais)
+void particionaLinhas(int n, MPI_Comm comm, blocoMPI_t *bloco);
+
+/**
+ * Gradiente Conjugado pré-condicionado distribuído (mesmo algoritmo de gradienteConjugado)
+ *
+ * A: fatia local das N_DIAG diagonais de ASP (A[diag_idx * nLocal + i])
+ * b, x: fatias locais (nLocal) do RHS e da solução (x inicial = 0)
+ * M: fatia local do pré-condicionador Jacobi ou NULL
+ *
+ * O SpMV troca apenas (N_DIAG-1)/2 elementos de p com cada vizinho, sobrepondo a
+ * comunicação com o cálculo das linhas internas. Produtos escalares usam MPI_Allreduce.
+ *
+ * Retorna o número de iterações ou -1 em caso de erro.
+ */
+int gradienteConjugadoMPI(const blocoMPI_t *bloco, real_t *A, real_t *b, real_t *x, int maxit, double eps, real_t *M, real_t *normaFinal, rtime_t *tempoIter);
+
+// Norma L2 do resíduo b - A*x do SL original (k diagonais), distribuída
+real_t calcResiduoSLMPI(const blocoMPI_t *bloco, real_t *A, real_t *b, real_t *X, int k, rtime_t *tempo);
+
+#endif // __PCGCMPI_H__
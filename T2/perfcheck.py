@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+import json
+import os
+import statistics
+import subprocess
+import sys
+
+# ==============================================================================
+# CONFIGURAÇÕES
+# ==============================================================================
+# 'make perfcheck': roda a matriz fixa de benchmarks com o cgSolver, compara as
+# medianas com a linha de base (perfcheck_base.json) e sai com código 1 se algum
+# núcleo ficou mais lento além do ruído. 'make perfbase' regrava a linha de base.
+EXECUTAVEL = './cgSolver'
+ARQ_BASE = os.environ.get('PERF_BASE', 'perfcheck_base.json')
+REPETICOES = int(os.environ.get('PERF_REPETICOES', '5'))
+
+# Parâmetros do problema (os do exec.sh); k = 7 é fixo no cgSolver do T2 (N_DIAG)
+K = 7
+MAXIT = 25
+EPSILON = 1.0e-9
+
+# Matriz de benchmarks: n (em cache, L2/L3 e DRAM) x pré-condicionador x formato de A
+TAMANHOS = [4096, 65536, 1048576]
+PRECONDICIONADORES = {'jacobi': 0.0, 'sem': -1.0}
+FORMATOS = ['dia', 'dia-fantasma']
+
+# Limiares: regressão se a mediana subir mais que TOLERANCIA (fração) E mais que
+# FATOR_RUIDO desvios robustos (1.4826 * MAD) da medição mais ruidosa (base ou atual)
+TOLERANCIA = float(os.environ.get('PERF_TOLERANCIA', '0.10'))
+FATOR_RUIDO = 3.0
+
+# Núcleos medidos: linha da saída do cgSolver (1 = n) e flops por linha de A,
+# para o GFLOP/s derivado. op1 (iteração do PCG, ms por iteração): SpMV 2k, p.Ap 2,
+# x e r 4, ||r|| 2, r.z 2 e p 2, mais z = r/M 1 com pré-condicionador (sem M, r.z = r.r
+# sai da norma). op2 (resíduo): b - A x 2k + 1 e a norma 2.
+NUCLEOS = {
+    'op1':     {'linha': 6, 'nome': 'iteração do PCG'},
+    'op2':     {'linha': 7, 'nome': 'resíduo'},
+    'precond': {'linha': 5, 'nome': 'DLU + pré-condicionador'},
+}
+
+
+def flops_por_linha(nucleo, precond):
+    if nucleo == 'op1':
+        return 2 * K + 12 + (1 if precond != 'sem' else -2)
+    if nucleo == 'op2':
+        return 2 * K + 3
+    return None
+
+
+# ==============================================================================
+# MEDIÇÃO
+# ==============================================================================
+def executa(n, omega, formato):
+    """Uma execução do cgSolver; devolve os tempos (ms) de cada núcleo."""
+    entrada = f"{n} {omega} {MAXIT} {EPSILON}\n"
+    proc = subprocess.run([EXECUTAVEL, '-f', formato], input=entrada, capture_output=True, text=True)
+    linhas = proc.stdout.split('\n')
+    if proc.returncode != 0 or len(linhas) < 7:
+        raise RuntimeError(f"cgSolver falhou (n={n}, omega={omega}, -f {formato}): {proc.stdout[:200]}")
+
+    tempos = {}
+    for nucleo, cfg in NUCLEOS.items():
+        valor = linhas[cfg['linha'] - 1].strip()
+        if valor != 'Nao calculado':
+            tempos[nucleo] = float(valor)
+    return tempos
+
+
+def mad(valores, mediana):
+    return statistics.median([abs(v - mediana) for v in valores])
+
+
+def mede_matriz():
+    """Mediana e MAD de cada (núcleo, n, pré-condicionador, formato)."""
+    resultados = {}
+    for n in TAMANHOS:
+        for precond, omega in PRECONDICIONADORES.items():
+            for formato in FORMATOS:
+                amostras = {}
+                for _ in range(REPETICOES):
+                    for nucleo, t in executa(n, omega, formato).items():
+                        amostras.setdefault(nucleo, []).append(t)
+
+                for nucleo, valores in amostras.items():
+                    mediana = statistics.median(valores)
+                    chave = f"{nucleo}|{n}|{precond}|{formato}"
+                    fl = flops_por_linha(nucleo, precond)
+                    resultados[chave] = {
+                        'mediana_ms': mediana,
+                        'mad_ms': mad(valores, mediana),
+                        'gflops': (fl * n / (mediana * 1e6)) if fl and mediana > 0 else None,
+                    }
+                print(f"  n={n:<8d} {precond:<7s} {formato:<13s} " +
+                      "  ".join(f"{nu}={statistics.median(v):.4g} ms" for nu, v in amostras.items()), flush=True)
+    return resultados
+
+
+def modelo_cpu():
+    try:
+        with open('/proc/cpuinfo') as f:
+            for linha in f:
+                if linha.startswith('model name'):
+                    return linha.split(':', 1)[1].strip()
+    except OSError:
+        pass
+    return 'desconhecido'
+
+
+# ==============================================================================
+# COMPARAÇÃO
+# ==============================================================================
+def ordem(chave):
+    nucleo, n, precond, formato = chave.split('|')
+    return (list(NUCLEOS).index(nucleo), int(n), precond, formato)
+
+
+def compara(base, atual):
+    """Lista de (chave, variação, limite, status) e as regressões."""
+    linhas, regressoes = [], []
+    for chave, med in sorted(atual.items(), key=lambda kv: ordem(kv[0])):
+        ref = base['resultados'].get(chave)
+        if ref is None:
+            linhas.append((chave, None, None, 'NOVO'))
+            continue
+
+        variacao = (med['mediana_ms'] - ref['mediana_ms']) / ref['mediana_ms']
+        ruido = 1.4826 * FATOR_RUIDO * max(ref['mad_ms'], med['mad_ms'])
+        #limite efetivo: o maior entre a tolerância e o ruído medido
+        limite = max(TOLERANCIA, ruido / ref['mediana_ms'])
+        if variacao > limite:
+            status = 'REGRESSÃO'
+            regressoes.append((chave, ref, med, variacao, limite))
+        elif variacao < -limite:
+            status = 'melhora'
+        else:
+            status = 'ok'
+        linhas.append((chave, variacao, limite, status))
+    return linhas, regressoes
+
+
+def descreve(chave):
+    nucleo, n, precond, formato = chave.split('|')
+    return f"{nucleo} ({NUCLEOS[nucleo]['nome']}) n={n} {precond} -f {formato}"
+
+
+def main():
+    grava = '--grava' in sys.argv[1:]
+    if not os.path.exists(EXECUTAVEL):
+        print(f"ERRO: {EXECUTAVEL} não encontrado (rode 'make')")
+        return 2
+
+    base = None
+    if not grava:
+        try:
+            with open(ARQ_BASE) as f:
+                base = json.load(f)
+        except (OSError, ValueError) as erro:
+            print(f"ERRO: linha de base {ARQ_BASE} ilegível ({erro}); gere com 'make perfbase'")
+            return 2
+
+    threads = os.environ.get('OMP_NUM_THREADS', 'padrão')
+    #tempos de outra CPU ou de outro número de threads não servem de referência
+    if base and (base.get('cpu') != modelo_cpu() or base.get('omp_num_threads') != threads):
+        print(f"ERRO: linha de base medida em '{base.get('cpu')}' com OMP_NUM_THREADS={base.get('omp_num_threads')}, "
+              f"execução atual em '{modelo_cpu()}' com OMP_NUM_THREADS={threads}; gere com 'make perfbase'")
+        return 2
+
+    print(f"--- perfcheck: {REPETICOES} repetições, OMP_NUM_THREADS={threads}, MAXIT={MAXIT} ---")
+    try:
+        atual = mede_matriz()
+    except RuntimeError as erro:
+        print(f"ERRO: {erro}")
+        return 2
+
+    if grava:
+        with open(ARQ_BASE, 'w') as f:
+            json.dump({'cpu': modelo_cpu(), 'omp_num_threads': threads, 'repeticoes': REPETICOES,
+                       'maxit': MAXIT, 'resultados': atual}, f, indent=1, sort_keys=True)
+            f.write('\n')
+        print(f"Linha de base gravada em {ARQ_BASE} ({len(atual)} medições)")
+        return 0
+
+    linhas, regressoes = compara(base, atual)
+    print("")
+    print(f"{'núcleo|n|precond|formato':<36s} {'base':>10s} {'atual':>10s} {'GFLOP/s':>8s} {'var.':>8s} {'limite':>7s}  status")
+    for chave, variacao, limite, status in linhas:
+        med = atual[chave]
+        ref = base['resultados'].get(chave, {})
+        gf = f"{med['gflops']:.3f}" if med['gflops'] else '-'
+        print(f"{chave:<36s} {ref.get('mediana_ms', float('nan')):>10.4g} {med['mediana_ms']:>10.4g} {gf:>8s} " +
+              (f"{100 * variacao:>+7.1f}% {100 * limite:>6.1f}%" if variacao is not None else f"{'-':>8s} {'-':>7s}") +
+              f"  {status}")
+
+    print("")
+    if not regressoes:
+        print(f"perfcheck: OK ({len(linhas)} medições dentro dos limites)")
+        return 0
+    for chave, ref, med, variacao, limite in regressoes:
+        print(f"REGRESSÃO: {descreve(chave)}: {ref['mediana_ms']:.4g} -> {med['mediana_ms']:.4g} ms "
+              f"(+{100 * variacao:.1f}%, limite +{100 * limite:.1f}%)")
+    return 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,223 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "utils.h"
+#include "pipeline.h"
+
+// Ocupação de cada fila (para o relatório), guardada ao fim de executaPipeline
+static double ocupacaoMedia[PIPELINE_MAX_ESTAGIOS];
+static int ocupacaoMaxima[PIPELINE_MAX_ESTAGIOS];
+static int capacidadeFila[PIPELINE_MAX_ESTAGIOS];
+static rtime_t tempoTotal;
+
+static int criaFila(fila_t *f, int capacidade)
+{
+    f->itens = malloc(capacidade * sizeof(void *));
+    if (!f->itens) return -1;
+    f->capacidade = capacidade;
+    f->inicio = f->tamanho = f->fechada = 0;
+    f->somaOcupacao = 0.0;
+    f->maxOcupacao = 0;
+    f->ultimaMudanca = timestamp();
+    pthread_mutex_init(&f->trava, NULL);
+    pthread_cond_init(&f->naoVazia, NULL);
+    pthread_cond_init(&f->naoCheia, NULL);
+    return 0;
+}
+
+static void liberaFila(fila_t *f)
+{
+    pthread_mutex_destroy(&f->trava);
+    pthread_cond_destroy(&f->naoVazia);
+    pthread_cond_destroy(&f->naoCheia);
+    free(f->itens);
+}
+
+//acumula tamanho * dt antes de cada mudança (chamada com a trava)
+static inline void registraOcupacao(fila_t *f)
+{
+    rtime_t agora = timestamp();
+    f->somaOcupacao += f->tamanho * (agora - f->ultimaMudanca);
+    f->ultimaMudanca = agora;
+}
+
+//Insere bloqueando enquanto a fila estiver cheia; *espera acumula o tempo bloqueado
+static void empilha(fila_t *f, void *item, rtime_t *espera)
+{
+    rtime_t t0 = timestamp();
+    pthread_mutex_lock(&f->trava);
+    while (f->tamanho == f->capacidade && !f->fechada) pthread_cond_wait(&f->naoCheia, &f->trava);
+    *espera += timestamp() - t0;
+
+    //fila fechada por falha do consumidor: o item é descartado
+    if (f->fechada) {
+        pthread_mutex_unlock(&f->trava);
+        return;
+    }
+
+    registraOcupacao(f);
+    f->itens[(f->inicio + f->tamanho) % f->capacidade] = item;
+    f->tamanho++;
+    if (f->tamanho > f->maxOcupacao) f->maxOcupacao = f->tamanho;
+
+    pthread_cond_signal(&f->naoVazia);
+    pthread_mutex_unlock(&f->trava);
+}
+
+//Retira bloqueando enquanto vazia; NULL se a fila foi fechada e esvaziou
+static void *desempilha(fila_t *f, rtime_t *espera)
+{
+    rtime_t t0 = timestamp();
+    pthread_mutex_lock(&f->trava);
+    while (f->tamanho == 0 && !f->fechada) pthread_cond_wait(&f->naoVazia, &f->trava);
+    *espera += timestamp() - t0;
+
+    void *item = NULL;
+    if (f->tamanho > 0) {
+        registraOcupacao(f);
+        item = f->itens[f->inicio];
+        f->inicio = (f->inicio + 1) % f->capacidade;
+        f->tamanho--;
+        pthread_cond_signal(&f->naoCheia);
+    }
+    pthread_mutex_unlock(&f->trava);
+    return item;
+}
+
+static void fechaFila(fila_t *f)
+{
+    pthread_mutex_lock(&f->trava);
+    f->fechada = 1;
+    pthread_cond_broadcast(&f->naoVazia);
+    pthread_cond_broadcast(&f->naoCheia);
+    pthread_mutex_unlock(&f->trava);
+}
+
+typedef struct {
+    estagio_t *estagio;
+    fila_t *entrada, *saida;
+    int primeiro, ultimo;   // o primeiro conta as tarefas; o último devolve os itens
+    int nTarefas;
+    void *contexto;
+    volatile int *erro;
+} argEstagio_t;
+
+static void *rodaEstagio(void *arg)
+{
+    argEstagio_t *a = arg;
+    estagio_t *e = a->estagio;
+
+    for (;;) {
+        //o primeiro estágio para depois de nTarefas (ou de um erro) e fecha a sua saída
+        if (a->primeiro && (e->itens == a->nTarefas || *a->erro)) break;
+
+        void *item = desempilha(a->entrada, &e->tempoEsperaEntrada);
+        if (!item) break;
+
+        //após um erro os itens só passam adiante, para drenar o pipeline
+        if (!*a->erro) {
+            rtime_t t0 = timestamp();
+            if (e->funcao(a->contexto, item)) *a->erro = 1;
+            e->tempoOcupado += timestamp() - t0;
+            e->itens++;
+        }
+        empilha(a->saida, item, &e->tempoEsperaSaida);
+    }
+
+    //o último estágio devolve itens à fila livre, que nunca fecha
+    if (!a->ultimo) fechaFila(a->saida);
+    return NULL;
+}
+
+int executaPipeline(estagio_t *estagios, int nEstagios, void **itens, int nItens,
+                    int nTarefas, int capacidade, void *contexto)
+{
+    if (nEstagios < 1 || nEstagios > PIPELINE_MAX_ESTAGIOS || nItens < 1 || capacidade < 1) return -1;
+
+    //filas[0]: itens livres (entrada do primeiro estágio); filas[s]: entre s-1 e s
+    fila_t filas[PIPELINE_MAX_ESTAGIOS];
+    argEstagio_t args[PIPELINE_MAX_ESTAGIOS];
+    pthread_t threads[PIPELINE_MAX_ESTAGIOS];
+    volatile int erro = 0;
+
+    for (int s = 0; s < nEstagios; s++) {
+        if (criaFila(&filas[s], s == 0 ? nItens : capacidade)) {
+            for (int j = 0; j < s; j++) liberaFila(&filas[j]);
+            return -1;
+        }
+        capacidadeFila[s] = filas[s].capacidade;
+    }
+    rtime_t espera = 0.0;
+    for (int i = 0; i < nItens; i++) empilha(&filas[0], itens[i], &espera);
+
+    //threads auxiliares em todas as CPUs online: sem isso herdariam a afinidade
+    //da thread principal (fixada numa CPU por fixaThreads)
+    cpu_set_t todas;
+    CPU_ZERO(&todas);
+    long nCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long c = 0; c < nCPUs && c < CPU_SETSIZE; c++) CPU_SET(c, &todas);
+    pthread_attr_t atributos;
+    pthread_attr_init(&atributos);
+    pthread_attr_setaffinity_np(&atributos, sizeof(todas), &todas);
+
+    tempoTotal = timestamp();
+    int principal = -1, criadas = 0;
+    for (int s = 0; s < nEstagios; s++) {
+        estagios[s].itens = 0;
+        estagios[s].tempoOcupado = estagios[s].tempoEsperaEntrada = estagios[s].tempoEsperaSaida = 0.0;
+        args[s] = (argEstagio_t) { &estagios[s], &filas[s], &filas[(s + 1) % nEstagios],
+                                   s == 0, s == nEstagios - 1, nTarefas, contexto, &erro };
+
+        if (estagios[s].naThreadPrincipal && principal < 0) {
+            principal = s;
+        } else if (pthread_create(&threads[s], &atributos, rodaEstagio, &args[s]) == 0) {
+            criadas |= 1 << s;
+        } else {
+            printf("Erro: não foi possível criar a thread do estágio %s\n", estagios[s].nome);
+            //sem este estágio os itens não circulam: o anterior descarta o que receber
+            erro = 1;
+            fechaFila(&filas[s]);
+        }
+    }
+    pthread_attr_destroy(&atributos);
+
+    if (principal >= 0) rodaEstagio(&args[principal]);
+    for (int s = 0; s < nEstagios; s++)
+        if (criadas & (1 << s)) pthread_join(threads[s], NULL);
+    tempoTotal = timestamp() - tempoTotal;
+
+    for (int s = 0; s < nEstagios; s++) {
+        registraOcupacao(&filas[s]);
+        ocupacaoMedia[s] = tempoTotal > 0.0 ? filas[s].somaOcupacao / tempoTotal : 0.0;
+        ocupacaoMaxima[s] = filas[s].maxOcupacao;
+        liberaFila(&filas[s]);
+    }
+    return erro ? -1 : 0;
+}
+
+void relatorioPipeline(const estagio_t *estagios, int nEstagios, int nTarefas, FILE *saida)
+{
+    fprintf(saida, "# pipeline: %d sistemas em %.3f ms (%.2f sistemas/s)\n",
+            nTarefas, tempoTotal, tempoTotal > 0.0 ? 1e3 * nTarefas / tempoTotal : 0.0);
+    fprintf(saida, "# %-10s %6s %12s %10s %6s %12s %12s %18s\n", "estagio", "itens", "ocupado(ms)",
+            "sist/s", "uso", "espera ent.", "espera sai.", "fila ent. med/max");
+
+    //o gargalo é o estágio com maior tempo ocupado: ele dita a vazão do pipeline
+    int gargalo = 0;
+    for (int s = 1; s < nEstagios; s++)
+        if (estagios[s].tempoOcupado > estagios[gargalo].tempoOcupado) gargalo = s;
+
+    for (int s = 0; s < nEstagios; s++) {
+        const estagio_t *e = &estagios[s];
+        fprintf(saida, "# %-10s %6ld %12.3f %10.2f %5.1f%% %12.3f %12.3f %11.2f/%d de %d%s\n",
+                e->nome, e->itens, e->tempoOcupado,
+                e->tempoOcupado > 0.0 ? 1e3 * e->itens / e->tempoOcupado : 0.0,
+                tempoTotal > 0.0 ? 100.0 * e->tempoOcupado / tempoTotal : 0.0,
+                e->tempoEsperaEntrada, e->tempoEsperaSaida,
+                ocupacaoMedia[s], ocupacaoMaxima[s], capacidadeFila[s],
+                s == gargalo ? "  <- gargalo" : "");
+    }
+}
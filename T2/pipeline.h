@@ -0,0 +1,59 @@
+#ifndef __PIPELINE_H__
+#define __PIPELINE_H__
+
+#include <stdio.h>
+#include <pthread.h>
+#include "utils.h"
+
+#define PIPELINE_MAX_ESTAGIOS 8
+
+/**
+ * Fila limitada entre dois estágios (produtor/consumidor com mutex e variáveis
+ * de condição). Guarda a ocupação média ponderada pelo tempo e a máxima.
+ */
+typedef struct {
+    void **itens;
+    int capacidade, inicio, tamanho;
+    int fechada;                // o produtor terminou: consumidores saem quando esvaziar
+    pthread_mutex_t trava;
+    pthread_cond_t naoVazia, naoCheia;
+    rtime_t ultimaMudanca;      // para a ocupação média ponderada pelo tempo
+    double somaOcupacao;        // integral de 'tamanho' no tempo (itens * ms)
+    int maxOcupacao;
+} fila_t;
+
+// Processa um item; retorna 0 ou != 0 em caso de erro (o pipeline é drenado)
+typedef int (*funcaoEstagio_t)(void *contexto, void *item);
+
+/**
+ * Estágio do pipeline. Cada estágio roda numa thread e processa os itens em
+ * ordem (FIFO), então a ordem de saída é a de entrada. Um estágio marcado com
+ * naThreadPrincipal roda na thread que chamou executaPipeline (e usa o pool
+ * OpenMP já fixado por fixaThreads); os demais não herdam essa afinidade.
+ */
+typedef struct {
+    const char *nome;
+    funcaoEstagio_t funcao;
+    int naThreadPrincipal;
+    // estatísticas (preenchidas por executaPipeline)
+    long itens;
+    rtime_t tempoOcupado;       // ms dentro de 'funcao'
+    rtime_t tempoEsperaEntrada; // ms bloqueado na fila de entrada
+    rtime_t tempoEsperaSaida;   // ms bloqueado na fila de saída (cheia)
+} estagio_t;
+
+/**
+ * Executa nTarefas itens pelos estágios, em pipeline.
+ *
+ * itens: nItens buffers reutilizáveis (os itens circulam: o último estágio os
+ * devolve ao primeiro), então no máximo nItens tarefas estão em andamento.
+ * Entre estágios consecutivos há filas de 'capacidade' posições.
+ * Retorna 0, ou -1 se algum estágio falhou ou não foi possível criar as threads.
+ */
+int executaPipeline(estagio_t *estagios, int nEstagios, void **itens, int nItens,
+                    int nTarefas, int capacidade, void *contexto);
+
+// Vazão e ocupação de cada estágio/fila da última execução
+void relatorioPipeline(const estagio_t *estagios, int nEstagios, int nTarefas, FILE *saida);
+
+#endif // __PIPELINE_H__
@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "preparo.h"
+
+#define MAGICA_PREPARO "PCGPREP1"
+#define PAGINA_PREPARO 4096
+
+enum { SECAO_ASP, SECAO_D, SECAO_M, SECAO_RAIZ, SECAO_FATOR, SECAO_BLOCOS, N_SECOES };
+
+//Primeira página do arquivo; as seções começam na segunda, cada uma numa página nova
+typedef struct {
+    char magica[8];
+    uint64_t chave;
+    int32_t n, k;
+    int32_t tipoFator, b, nBlocos, reservado;
+    uint64_t deslocamento[N_SECOES], bytes[N_SECOES]; // bytes = 0: seção ausente
+    double tempoPreparo;
+} cabecalhoPreparo_t;
+
+struct cachePreparo_t {
+    char *diretorio;
+    size_t limite;
+    pthread_mutex_t trava;  // estatísticas e diretório (geração e preparo do pipeline)
+
+    //estatísticas
+    int acertos, faltas, gravados, grandes, removidos;
+    double bytesMapeados, bytesGravados;
+    double tempoMapa;       // ms abrindo e mapeando acertos
+    double tempoGravacao;   // ms gravando (e removendo)
+    double tempoEvitado;    // ms de preparo que os acertos evitaram
+};
+
+static void nomePreparo(const cachePreparo_t *c, uint64_t chave, char *nome, size_t tam)
+{
+    snprintf(nome, tam, "%s/%016llx.prep", c->diretorio, (unsigned long long) chave);
+}
+
+static inline size_t arredondaPagina(size_t bytes)
+{
+    return (bytes + PAGINA_PREPARO - 1) & ~(size_t) (PAGINA_PREPARO - 1);
+}
+
+cachePreparo_t *criaCachePreparo(const char *diretorio, size_t limite)
+{
+    mkdir(diretorio, 0755); //já existir não é erro
+    DIR *dir = opendir(diretorio);
+    if (!dir) {
+        printf("Erro: não foi possível abrir o diretório do cache de preparo %s\n", diretorio);
+        return NULL;
+    }
+    closedir(dir);
+
+    cachePreparo_t *c = calloc(1, sizeof(cachePreparo_t));
+    if (!c) return NULL;
+    c->diretorio = strdup(diretorio);
+    c->limite = limite;
+    if (!c->diretorio) {
+        free(c);
+        return NULL;
+    }
+    pthread_mutex_init(&c->trava, NULL);
+    return c;
+}
+
+void liberaCachePreparo(cachePreparo_t *c)
+{
+    if (!c) return;
+    pthread_mutex_destroy(&c->trava);
+    free(c->diretorio);
+    free(c);
+}
+
+static inline void *secao(const preparo_t *p, const cabecalhoPreparo_t *cab, int s)
+{
+    return cab->bytes[s] ? (char *) p->mapa + cab->deslocamento[s] : NULL;
+}
+
+preparo_t *abrePreparo(cachePreparo_t *c, uint64_t chave, int n, int k)
+{
+    rtime_t t0 = timestamp();
+    char nome[4096];
+    nomePreparo(c, chave, nome, sizeof(nome));
+
+    preparo_t *p = NULL;
+    int fd = open(nome, O_RDONLY);
+    struct stat st;
+    if (fd >= 0 && !fstat(fd, &st) && (size_t) st.st_size >= PAGINA_PREPARO) {
+        //escrita (cópia privada) só para os ponteiros serem os de real_t *; o arquivo não muda
+        void *mapa = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        const cabecalhoPreparo_t *cab = mapa;
+        int valido = (mapa != MAP_FAILED) && !memcmp(cab->magica, MAGICA_PREPARO, 8) && cab->chave == chave &&
+                     cab->n == n && cab->k == k;
+        for (int s = 0; valido && s < N_SECOES; s++)
+            if (cab->bytes[s] && cab->deslocamento[s] + cab->bytes[s] > (uint64_t) st.st_size) valido = 0;
+        p = valido ? calloc(1, sizeof(preparo_t)) : NULL;
+
+        if (p) {
+            p->mapa = mapa;
+            p->bytes = st.st_size;
+            p->n = n;
+            p->k = k;
+            p->ASP = secao(p, cab, SECAO_ASP);
+            p->D = secao(p, cab, SECAO_D);
+            p->M = secao(p, cab, SECAO_M);
+            p->raizD = secao(p, cab, SECAO_RAIZ);
+            p->tipoFator = cab->tipoFator;
+            p->tempoPreparo = cab->tempoPreparo;
+            if (p->tipoFator != FATOR_PREPARO_NENHUM) {
+                p->fatorMapa = (fatorBanda_t) { n, cab->b, secao(p, cab, SECAO_FATOR), cab->nBlocos,
+                                                secao(p, cab, SECAO_BLOCOS), NULL };
+                p->fator = &p->fatorMapa;
+            }
+        } else if (mapa != MAP_FAILED) {
+            munmap(mapa, st.st_size);
+        }
+    }
+    if (fd >= 0) close(fd);
+
+    //uso recente: o último a sair na remoção
+    if (p) utimensat(AT_FDCWD, nome, NULL, 0);
+
+    pthread_mutex_lock(&c->trava);
+    if (p) {
+        c->acertos++;
+        c->bytesMapeados += p->bytes;
+        c->tempoEvitado += p->tempoPreparo;
+        c->tempoMapa += timestamp() - t0;
+    } else {
+        c->faltas++;
+    }
+    pthread_mutex_unlock(&c->trava);
+    return p;
+}
+
+fatorBanda_t *fatorPreparo(const preparo_t *p)
+{
+    if (!p->fator) return NULL;
+    fatorBanda_t *F = malloc(sizeof(fatorBanda_t));
+    if (F) *F = p->fatorMapa;
+    return F;
+}
+
+void fechaPreparo(preparo_t *p)
+{
+    if (!p) return;
+    munmap(p->mapa, p->bytes);
+    free(p);
+}
+
+typedef struct {
+    char nome[4096];
+    size_t bytes;
+    struct timespec uso;
+} arquivoPreparo_t;
+
+static int comparaUso(const void *a, const void *b)
+{
+    const struct timespec *x = &((const arquivoPreparo_t *) a)->uso, *y = &((const arquivoPreparo_t *) b)->uso;
+    if (x->tv_sec != y->tv_sec) return (x->tv_sec < y->tv_sec) ? -1 : 1;
+    return (x->tv_nsec < y->tv_nsec) ? -1 : (x->tv_nsec > y->tv_nsec);
+}
+
+//Remove os .prep usados há mais tempo até sobrar espaço para 'novo' bytes (com a trava)
+static void abreEspaco(cachePreparo_t *c, size_t novo)
+{
+    DIR *dir = opendir(c->diretorio);
+    if (!dir) return;
+
+    arquivoPreparo_t *arqs = NULL;
+    int nArqs = 0, capacidade = 0;
+    size_t total = 0;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        size_t tam = strlen(ent->d_name);
+        if (tam < 5 || strcmp(ent->d_name + tam - 5, ".prep") != 0) continue;
+        if (nArqs == capacidade) {
+            capacidade = capacidade ? 2 * capacidade : 16;
+            arquivoPreparo_t *novos = realloc(arqs, capacidade * sizeof(arquivoPreparo_t));
+            if (!novos) break;
+            arqs = novos;
+        }
+        arquivoPreparo_t *a = &arqs[nArqs];
+        struct stat st;
+        snprintf(a->nome, sizeof(a->nome), "%s/%s", c->diretorio, ent->d_name);
+        if (stat(a->nome, &st)) continue;
+        a->bytes = st.st_size;
+        a->uso = st.st_mtim;
+        total += a->bytes;
+        nArqs++;
+    }
+    closedir(dir);
+
+    qsort(arqs, nArqs, sizeof(arquivoPreparo_t), comparaUso);
+    for (int i = 0; i < nArqs && total + novo > c->limite; i++) {
+        if (unlink(arqs[i].nome)) continue;
+        total -= arqs[i].bytes;
+        c->removidos++;
+    }
+    free(arqs);
+}
+
+int gravaPreparo(cachePreparo_t *c, uint64_t chave, const preparo_t *p)
+{
+    rtime_t t0 = timestamp();
+    const size_t n = p->n;
+    const fatorBanda_t *F = (p->tipoFator != FATOR_PREPARO_NENHUM) ? p->fator : NULL;
+
+    cabecalhoPreparo_t cab = { MAGICA_PREPARO, chave, p->n, p->k, F ? p->tipoFator : FATOR_PREPARO_NENHUM,
+                               F ? F->b : 0, F ? F->nBlocos : 0, 0, { 0 }, { 0 }, p->tempoPreparo };
+    const void *dados[N_SECOES] = { p->ASP, p->D, p->M, p->raizD, F ? F->L : NULL, F ? F->inicioBloco : NULL };
+    cab.bytes[SECAO_ASP] = p->ASP ? n * p->k * sizeof(real_t) : 0;
+    cab.bytes[SECAO_D] = p->D ? n * sizeof(real_t) : 0;
+    cab.bytes[SECAO_M] = p->M ? n * sizeof(real_t) : 0;
+    cab.bytes[SECAO_RAIZ] = p->raizD ? n * sizeof(real_t) : 0;
+    cab.bytes[SECAO_FATOR] = F ? n * (F->b + 1) * sizeof(real_t) : 0;
+    cab.bytes[SECAO_BLOCOS] = F ? (F->nBlocos + 1) * sizeof(int) : 0;
+
+    size_t total = PAGINA_PREPARO;
+    for (int s = 0; s < N_SECOES; s++) {
+        if (!cab.bytes[s]) continue;
+        cab.deslocamento[s] = total;
+        total += arredondaPagina(cab.bytes[s]);
+    }
+
+    pthread_mutex_lock(&c->trava);
+    if (total > c->limite) {
+        c->grandes++;
+        pthread_mutex_unlock(&c->trava);
+        return 1;
+    }
+    abreEspaco(c, total);
+    pthread_mutex_unlock(&c->trava);
+
+    //arquivo temporário renomeado no fim: um leitor nunca mapeia um preparo pela metade
+    char nome[4096], tmp[4200];
+    nomePreparo(c, chave, nome, sizeof(nome));
+    snprintf(tmp, sizeof(tmp), "%s.%d.tmp", nome, (int) getpid());
+
+    int fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, total)) {
+        if (fd >= 0) close(fd);
+        unlink(tmp);
+        return -1;
+    }
+    char *mapa = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapa == MAP_FAILED) {
+        unlink(tmp);
+        return -1;
+    }
+    memcpy(mapa, &cab, sizeof(cab));
+    for (int s = 0; s < N_SECOES; s++)
+        if (cab.bytes[s]) memcpy(mapa + cab.deslocamento[s], dados[s], cab.bytes[s]);
+    munmap(mapa, total);
+
+    if (rename(tmp, nome)) {
+        unlink(tmp);
+        return -1;
+    }
+
+    pthread_mutex_lock(&c->trava);
+    c->gravados++;
+    c->bytesGravados += total;
+    c->tempoGravacao += timestamp() - t0;
+    pthread_mutex_unlock(&c->trava);
+    return 0;
+}
+
+void relatorioCachePreparo(const cachePreparo_t *c, FILE *saida)
+{
+    fprintf(saida, "# preparo: %d acertos (%.1f MiB mapeados em %.3f ms, %.3f ms de preparo evitados), %d faltas, "
+            "%d gravados (%.1f MiB, %.3f ms), %d removidos pelo limite de %.0f MiB",
+            c->acertos, c->bytesMapeados / (1 << 20), c->tempoMapa, c->tempoEvitado, c->faltas,
+            c->gravados, c->bytesGravados / (1 << 20), c->tempoGravacao, c->removidos, (double) c->limite / (1 << 20));
+    if (c->grandes) fprintf(saida, ", %d maiores que o limite", c->grandes);
+    fprintf(saida, "\n");
+}
@@ -0,0 +1,70 @@
+#ifndef __PREPARO_H__
+#define __PREPARO_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include "utils.h"
+#include "banda.h"
+
+#define LIMITE_PREPARO_MIB 4096 // tamanho padrão do diretório do cache de preparo
+
+/**
+ * Cache em disco do preparo de um SL: ASP (já escalada, com -d), D, M, D^1/2
+ * e o fator de Cholesky em banda (o de -m direto|auto ou os blocos de -j).
+ *
+ * Um arquivo por preparo, <chave>.prep: uma página de cabeçalho e as seções
+ * alinhadas a páginas, no layout dos vetores da arena. Num acerto o arquivo é
+ * mapeado (MAP_PRIVATE) e os ponteiros apontam para o mapa: nada é copiado, e
+ * cada página só é lida do disco (ou do page cache) quando o PCG a toca.
+ *
+ * A chave é de quem chama (hash de A e dos parâmetros do preparo). O diretório
+ * tem um limite de bytes: antes de gravar, os arquivos usados há mais tempo
+ * (mtime, renovado a cada acerto) são removidos até o novo caber.
+ *
+ * Seguro com o pipeline (-P): geração e preparo de SLs diferentes usam o
+ * mesmo cache ao mesmo tempo.
+ */
+typedef struct cachePreparo_t cachePreparo_t;
+
+// Tipos de fator guardados
+#define FATOR_PREPARO_NENHUM 0
+#define FATOR_PREPARO_DIRETO 'd' // Cholesky de ASP (-m direto|auto)
+#define FATOR_PREPARO_BLOCOS 'j' // Jacobi em blocos (-j)
+
+// Um preparo: na gravação, os dados do SL; num acerto, ponteiros para o mapa (NULL = seção ausente)
+typedef struct {
+    int n, k;
+    real_t *ASP, *D, *M, *raizD;
+    int tipoFator;
+    const fatorBanda_t *fator;  // gravação: o fator do SL (ou NULL)
+    double tempoPreparo;        // ms do preparo original (o que um acerto evita)
+
+    //acerto
+    void *mapa;
+    size_t bytes;
+    fatorBanda_t fatorMapa;     // L e inicioBloco no mapa
+} preparo_t;
+
+// Cache em 'diretorio' (criado se não existir) com até 'limite' bytes. NULL em erro.
+cachePreparo_t *criaCachePreparo(const char *diretorio, size_t limite);
+void liberaCachePreparo(cachePreparo_t *c);
+
+// Mapeia o preparo de 'chave' (n linhas, k diagonais em ASP). NULL se ausente ou inválido.
+preparo_t *abrePreparo(cachePreparo_t *c, uint64_t chave, int n, int k);
+
+// Fator do mapa numa estrutura própria (liberaFatorBanda a solta; o mapa continua de fechaPreparo)
+fatorBanda_t *fatorPreparo(const preparo_t *p);
+
+void fechaPreparo(preparo_t *p);
+
+/**
+ * Grava p (as seções não NULL e o fator, se houver) como 'chave', removendo os
+ * mais antigos além do limite. Retorna 0, 1 se o preparo sozinho passa do
+ * limite (não é gravado) ou -1 em erro de disco.
+ */
+int gravaPreparo(cachePreparo_t *c, uint64_t chave, const preparo_t *p);
+
+// Acertos, faltas, gravações, remoções, bytes mapeados e tempo de preparo evitado
+void relatorioCachePreparo(const cachePreparo_t *c, FILE *saida);
+
+#endif // __PREPARO_H__
@@ -0,0 +1,356 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include "utils.h"
+#include "sislin.h"
+#include "pcgc.h"
+#include "reciclagem.h"
+
+//Cria um subespaço vazio com memória limitada
+subespaco_t *criaSubespaco(int n, int maxVetores, int maxLanczos)
+{
+    subespaco_t *S = calloc(1, sizeof(subespaco_t));
+    if (!S) return NULL;
+
+    S->n = n;
+    S->maxVetores = maxVetores;
+    S->maxLanczos = maxLanczos;
+    S->W = malloc((size_t) maxVetores * n * sizeof(real_t));
+    S->AW = malloc((size_t) maxVetores * n * sizeof(real_t));
+    S->V = malloc((size_t) maxLanczos * n * sizeof(real_t));
+    S->alphas = malloc(maxLanczos * sizeof(real_t));
+    S->betas = malloc(maxLanczos * sizeof(real_t));
+
+    if (!S->W || !S->AW || !S->V || !S->alphas || !S->betas) {
+        liberaSubespaco(S);
+        return NULL;
+    }
+    return S;
+}
+
+void liberaSubespaco(subespaco_t *S)
+{
+    if (!S) return;
+    free(S->W); free(S->AW); free(S->V);
+    free(S->alphas); free(S->betas);
+    free(S);
+}
+
+static inline real_t produtoEscalar(const real_t *x, const real_t *y, int n)
+{
+    real_t soma = 0.0;
+    for (int i = 0; i < n; i++) soma += x[i] * y[i];
+    return soma;
+}
+
+//QL implícito para tridiagonal simétrica (d: diagonal, e[i] = T[i][i+1]).
+//z (m*m, linha k = componente k) acumula as rotações; deve entrar como identidade.
+static int tridiagonalQL(real_t *d, real_t *e, int m, real_t *z)
+{
+    e[m - 1] = 0.0;
+    for (int l = 0; l < m; l++) {
+        int iter = 0, j;
+        do {
+            for (j = l; j < m - 1; j++) {
+                real_t dd = fabs(d[j]) + fabs(d[j + 1]);
+                if (fabs(e[j]) <= DBL_EPSILON * dd) break;
+            }
+            if (j != l) {
+                if (iter++ == 60) return -1;
+                real_t g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+                real_t r = hypot(g, 1.0);
+                g = d[j] - d[l] + e[l] / (g + copysign(r, g));
+                real_t s = 1.0, c = 1.0, p = 0.0;
+                int i;
+                for (i = j - 1; i >= l; i--) {
+                    real_t f = s * e[i];
+                    real_t b = c * e[i];
+                    e[i + 1] = (r = hypot(f, g));
+                    if (r == 0.0) {
+                        d[i + 1] -= p;
+                        e[j] = 0.0;
+                        break;
+                    }
+                    s = f / r;
+                    c = g / r;
+                    g = d[i + 1] - p;
+                    r = (d[i] - g) * s + 2.0 * c * b;
+                    d[i + 1] = g + (p = s * r);
+                    g = c * r - b;
+                    if (z) {
+                        for (int k = 0; k < m; k++) {
+                            f = z[k * m + i + 1];
+                            z[k * m + i + 1] = s * z[k * m + i] + c * f;
+                            z[k * m + i] = c * z[k * m + i] - s * f;
+                        }
+                    }
+                }
+                if (r == 0.0 && i >= l) continue;
+                d[l] -= p;
+                e[l] = g;
+                e[j] = 0.0;
+            }
+        } while (j != l);
+    }
+    return 0;
+}
+
+//Autovalores/autovetores da tridiagonal de Lanczos montada a partir de alpha/beta
+int autovaloresLanczos(int m, const real_t *alphas, const real_t *betas, real_t *autoval, real_t *autovet)
+{
+    real_t *e = malloc(m * sizeof(real_t));
+    if (!e) return -1;
+
+    for (int j = 0; j < m; j++) {
+        autoval[j] = 1.0 / alphas[j];
+        if (j > 0) autoval[j] += betas[j - 1] / alphas[j - 1];
+        e[j] = (j < m - 1) ? -sqrt(betas[j]) / alphas[j] : 0.0;
+    }
+
+    if (autovet) {
+        for (int i = 0; i < m * m; i++) autovet[i] = 0.0;
+        for (int i = 0; i < m; i++) autovet[i * m + i] = 1.0;
+    }
+
+    int status = tridiagonalQL(autoval, e, m, autovet);
+    free(e);
+    if (status) return status;
+
+    //ordena em ordem crescente (m pequeno: seleção direta)
+    for (int i = 0; i < m - 1; i++) {
+        int menor = i;
+        for (int j = i + 1; j < m; j++)
+            if (autoval[j] < autoval[menor]) menor = j;
+        if (menor == i) continue;
+
+        real_t t = autoval[i]; autoval[i] = autoval[menor]; autoval[menor] = t;
+        if (autovet) {
+            for (int k = 0; k < m; k++) {
+                t = autovet[k * m + i];
+                autovet[k * m + i] = autovet[k * m + menor];
+                autovet[k * m + menor] = t;
+            }
+        }
+    }
+    return 0;
+}
+
+//Quociente de Rayleigh de M^-1 A para w A-normalizado: (wT A w) / (wT M w) = 1 / (wT M w)
+static real_t quocienteRayleigh(const real_t *w, const real_t *M, int n)
+{
+    real_t wMw = 0.0;
+    for (int i = 0; i < n; i++) wMw += w[i] * ((M != NULL) ? M[i] : 1.0) * w[i];
+    return 1.0 / wMw;
+}
+
+//Acrescenta y (com Ay = A*y) a W, A-ortonormalizando contra os vetores já guardados.
+//Com W cheio, substitui o vetor de maior quociente de Rayleigh se y for melhor.
+static void incluiVetor(subespaco_t *S, real_t *y, real_t *Ay, real_t *M)
+{
+    const int n = S->n;
+    real_t normaOriginal = sqrt(fabs(produtoEscalar(y, Ay, n)));
+
+    for (int j = 0; j < S->nVetores; j++) {
+        real_t c = produtoEscalar(&S->AW[(size_t) j * n], y, n);
+        for (int i = 0; i < n; i++) {
+            y[i] -= c * S->W[(size_t) j * n + i];
+            Ay[i] -= c * S->AW[(size_t) j * n + i];
+        }
+    }
+
+    //yT A y <= 0: operador não é SPD nesta direção, vetor descartado
+    real_t yAy = produtoEscalar(y, Ay, n);
+    if (!(yAy > 0.0) || sqrt(yAy) < 1e-8 * normaOriginal) return;
+
+    real_t escala = 1.0 / sqrt(yAy);
+    for (int i = 0; i < n; i++) {
+        y[i] *= escala;
+        Ay[i] *= escala;
+    }
+
+    int destino = S->nVetores;
+    if (destino == S->maxVetores) {
+        real_t pior = quocienteRayleigh(y, M, n);
+        destino = -1;
+        for (int j = 0; j < S->nVetores; j++) {
+            real_t theta = quocienteRayleigh(&S->W[(size_t) j * n], M, n);
+            if (theta > pior) {
+                pior = theta;
+                destino = j;
+            }
+        }
+        if (destino < 0) return;
+    } else {
+        S->nVetores++;
+    }
+
+    memcpy(&S->W[(size_t) destino * n], y, n * sizeof(real_t));
+    memcpy(&S->AW[(size_t) destino * n], Ay, n * sizeof(real_t));
+}
+
+//Extrai vetores de Ritz da resolução corrente e os incorpora a W
+static void atualizaSubespaco(subespaco_t *S, const operador_t *A, real_t *M)
+{
+    const int n = S->n;
+    const int m = S->nLanczos;
+    if (m < 2) return;
+
+    real_t *theta = malloc(m * sizeof(real_t));
+    real_t *s = malloc((size_t) m * m * sizeof(real_t));
+    real_t *y = criaVetorOperador(A); //passado a aplicaOperador: com as margens do formato
+    real_t *Ay = malloc(n * sizeof(real_t));
+
+    if (theta && s && y && Ay && autovaloresLanczos(m, S->alphas, S->betas, theta, s) == 0) {
+        //metade inferior do espectro de T: os extremos convergem primeiro no Lanczos
+        int nNovos = (m / 2 < S->maxVetores) ? m / 2 : S->maxVetores;
+
+        for (int j = 0; j < nNovos; j++) {
+            if (!(theta[j] > 0.0)) continue;
+
+            //y = V * s_j
+            for (int i = 0; i < n; i++) y[i] = 0.0;
+            for (int l = 0; l < m; l++) {
+                real_t c = s[l * m + j];
+                real_t *v = &S->V[(size_t) l * n];
+                for (int i = 0; i < n; i++) y[i] += c * v[i];
+            }
+
+            aplicaOperador(A, y, Ay);
+            incluiVetor(S, y, Ay, M);
+        }
+    }
+
+    free(theta); free(s); free(Ay);
+    liberaVetorOperador(A, y);
+}
+
+//Registra o vetor de Lanczos v_j = z_j / sqrt(r_j.z_j) da iteração j
+static inline void registraLanczos(subespaco_t *S, int j, const real_t *z, real_t rz)
+{
+    if (j >= S->maxLanczos || !(rz > 0.0)) return;
+
+    real_t escala = 1.0 / sqrt(rz);
+    real_t *v = &S->V[(size_t) j * S->n];
+    for (int i = 0; i < S->n; i++) v[i] = z[i] * escala;
+}
+
+//mu = (AW)^T z; p -= W mu (mantém p A-ortogonal a W); n = S->n, as linhas de z e p
+static void deflaciona(const subespaco_t *S, int n, const real_t *z, real_t *p, real_t *mu)
+{
+    for (int j = 0; j < S->nVetores; j++)
+        mu[j] = produtoEscalar(&S->AW[(size_t) j * n], z, n);
+
+    for (int j = 0; j < S->nVetores; j++) {
+        real_t *w = &S->W[(size_t) j * n];
+        for (int i = 0; i < n; i++) p[i] -= mu[j] * w[i];
+    }
+}
+
+//gradiente Conjugado Pré condicionado deflacionado
+int gradienteConjugadoDeflacionado(const operador_t *A, real_t *b, real_t *x, int maxit, double eps, real_t *M, subespaco_t *S, real_t *normaFinal, rtime_t *tempoIter)
+{
+    const int n = A->n;
+    real_t *r = malloc(n * sizeof(real_t));
+    real_t *z = malloc(n * sizeof(real_t));
+    real_t *p = criaVetorOperador(A); //passado a aplicaOperador: com as margens do formato
+    real_t *Ap = malloc(n * sizeof(real_t));
+    real_t *mu = malloc((S->maxVetores + 1) * sizeof(real_t));
+
+    if (n < 1 || !r || !z || !p || !Ap || !mu) {
+        free(r); free(z); free(Ap); free(mu);
+        if (p) liberaVetorOperador(A, p);
+        return -1;
+    }
+
+    const int nW = S->nVetores;
+    S->nLanczos = 0;
+
+    //resíduo inicial r = b - A*x (x copiado para p, que tem as margens)
+    memcpy(p, x, n * sizeof(real_t));
+    aplicaOperador(A, p, Ap);
+    for (int i = 0; i < n; ++i) r[i] = b[i] - Ap[i];
+
+    //projeção inicial: x += W (W^T r), r -= AW (W^T r)  (W^T A W = I)
+    for (int j = 0; j < nW; j++) {
+        real_t c = produtoEscalar(&S->W[(size_t) j * n], r, n);
+        for (int i = 0; i < n; i++) {
+            x[i] += c * S->W[(size_t) j * n + i];
+            r[i] -= c * S->AW[(size_t) j * n + i];
+        }
+    }
+
+    //Pré-condicionador
+    for (int i = 0; i < n; i++) {
+        z[i] = (M != NULL) ? r[i] / M[i] : r[i];
+        p[i] = z[i];
+    }
+    deflaciona(S, n, z, p, mu);
+
+    real_t rz_old = produtoEscalar(r, z, n);
+    registraLanczos(S, 0, z, rz_old);
+
+    int iter;
+    *tempoIter = timestamp();
+
+    LIKWID_MARKER_START("op1");
+
+    for (iter = 1; iter <= maxit; iter++) {
+
+        aplicaOperador(A, p, Ap);
+
+        real_t pAp = produtoEscalar(p, Ap, n);
+
+        // Verificação de divide por zero
+        if (fabs(pAp) < 1e-15) break;
+
+        real_t alpha = rz_old / pAp;
+        if (iter - 1 < S->maxLanczos) {
+            S->alphas[iter - 1] = alpha;
+            S->nLanczos = iter;
+        }
+
+        // Atualiza X e R
+        real_t norma_r_sq = 0.0;
+        for (int i = 0; i < n; i++) {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * Ap[i];
+            norma_r_sq += r[i] * r[i];
+        }
+
+        real_t norma_r = sqrt(norma_r_sq);
+        *normaFinal = norma_r;
+
+        // critério de parada
+        if (norma_r < eps) break;
+
+        // Aplica Precondicionador
+        for (int i = 0; i < n; i++) z[i] = (M != NULL) ? r[i] / M[i] : r[i];
+
+        real_t rz_new = produtoEscalar(r, z, n);
+        real_t beta = rz_new / rz_old;
+        rz_old = rz_new;
+
+        if (iter - 1 < S->maxLanczos) S->betas[iter - 1] = beta;
+        registraLanczos(S, iter, z, rz_new);
+
+        //p = z + beta*p - W mu
+        for (int i = 0; i < n; i++) p[i] = z[i] + beta * p[i];
+        deflaciona(S, n, z, p, mu);
+    }
+
+    LIKWID_MARKER_STOP("op1");
+
+    if (iter > maxit) iter = maxit;
+    *tempoIter = timestamp() - *tempoIter;
+    if (iter > 0) *tempoIter = *tempoIter / iter;
+
+    free(r); free(z); free(Ap); free(mu);
+    liberaVetorOperador(A, p);
+
+    //fora do tempo por iteração: custo amortizado entre as resoluções seguintes
+    atualizaSubespaco(S, A, M);
+
+    return iter;
+}
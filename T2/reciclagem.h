@@ -0,0 +1,56 @@
+#ifndef __RECICLAGEM_H__
+#define __RECICLAGEM_H__
+
+#include "utils.h"
+#include "operador.h"
+
+// Janela de vetores de Lanczos guardados por resolução, em múltiplos de nvet
+#define FATOR_JANELA_LANCZOS 6
+
+/**
+ * Subespaço de deflação reaproveitado entre resoluções com a mesma ASP
+ * (ou uma ASP que muda pouco de um sistema para o outro).
+ *
+ * Ao fim de cada resolução, os coeficientes alpha/beta do CG formam a matriz
+ * tridiagonal de Lanczos T; os vetores de Ritz dos menores autovalores de T
+ * aproximam os autovetores de M^-1 A que mais custam iterações. Eles são
+ * guardados em W e deflacionados nas resoluções seguintes.
+ *
+ * Memória limitada: (2*maxVetores + maxLanczos) vetores de dimensão n.
+ */
+typedef struct {
+    int n;            // dimensão do SL
+    int maxVetores;   // máximo de vetores de deflação em W
+    int nVetores;     // vetores atualmente em W
+    int maxLanczos;   // janela de vetores de Lanczos guardados por resolução
+    real_t *W;        // W[j*n + i]: vetores de deflação
+    real_t *AW;       // A*W (evita SpMVs extras no loop); W é A-ortonormal: W^T A W = I
+    real_t *V;        // vetores de Lanczos da resolução corrente
+    real_t *alphas;   // alpha de cada iteração da resolução corrente
+    real_t *betas;    // beta de cada iteração da resolução corrente
+    int nLanczos;     // coeficientes/vetores registrados na resolução corrente
+} subespaco_t;
+
+subespaco_t *criaSubespaco(int n, int maxVetores, int maxLanczos);
+void liberaSubespaco(subespaco_t *S);
+
+/**
+ * Gradiente Conjugado pré-condicionado deflacionado (Saad et al.)
+ *
+ * Mesmos parâmetros de gradienteConjugado. Se S tiver vetores, x inicial é
+ * projetado em W e as direções de busca são mantidas A-ortogonais a W.
+ * Ao final, os vetores de Ritz extraídos de alpha/beta atualizam S.
+ */
+int gradienteConjugadoDeflacionado(const operador_t *A, real_t *b, real_t *x, int maxit, double eps, real_t *M, subespaco_t *S, real_t *normaFinal, rtime_t *tempoIter);
+
+/**
+ * Autovalores (crescentes) e autovetores da tridiagonal de Lanczos m x m
+ * definida pelos coeficientes do CG:
+ *   T[j][j]   = 1/alpha_j + beta_{j-1}/alpha_{j-1}
+ *   T[j][j+1] = -sqrt(beta_j)/alpha_j
+ * autovet (m*m, coluna j = autovetor j) pode ser NULL.
+ * Retorna 0 em caso de sucesso, -1 se o QL não convergir.
+ */
+int autovaloresLanczos(int m, const real_t *alphas, const real_t *betas, real_t *autoval, real_t *autovet);
+
+#endif // __RECICLAGEM_H__
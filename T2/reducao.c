@@ -0,0 +1,21 @@
+#include "utils.h"
+#include "topologia.h"
+#include "reducao.h"
+
+//Árvore: a cada nível p[j] += p[j + passo] para j múltiplo de 2 passo. A forma só depende
+//de nBlocos e o erro cresce com log2(nBlocos), não com nBlocos
+real_t somaParciais(real_t *parciais, int nBlocos)
+{
+    if (nBlocos <= 0) return 0.0;
+    for (int passo = 1; passo < nBlocos; passo *= 2)
+        for (int j = 0; j + passo < nBlocos; j += 2 * passo)
+            parciais[j] += parciais[j + passo];
+    return parciais[0];
+}
+
+real_t produtoReprodutivel(const real_t *x, const real_t *y, int n, real_t *parciais)
+{
+    real_t soma;
+    SOMA_REPRODUTIVEL(soma, parciais, n, n >= MIN_LINHAS_PARALELO, s += x[i] * y[i];);
+    return soma;
+}
@@ -0,0 +1,55 @@
+#ifndef __REDUCAO_H__
+#define __REDUCAO_H__
+
+#include "utils.h"
+
+// Linhas de cada bloco das somas reprodutíveis (fixo: não depende do número de threads)
+#define TAM_BLOCO_REDUCAO 4096
+
+/**
+ * Somas reprodutíveis: o mesmo resultado, bit a bit, com 1 a N threads.
+ *
+ * Com reduction(+) do OpenMP cada thread soma a sua faixa de linhas e as
+ * parciais são somadas na ordem em que as threads terminam: o arredondamento
+ * muda com o número de threads (e de uma execução para outra).
+ *
+ * Aqui [0, n) é dividido em blocos fixos de TAM_BLOCO_REDUCAO linhas; cada
+ * bloco é somado por uma thread num laço omp simd (a ordem dentro do bloco é
+ * a do binário) e as somas dos blocos são somadas aos pares, numa árvore que
+ * só depende de n. Qualquer divisão dos blocos entre as threads dá a mesma
+ * soma. Entre CPUs diferentes o resultado só se repete com o mesmo binário
+ * (-march=native muda a largura do simd).
+ */
+
+// Blocos (e somas parciais) de uma soma de n termos
+static inline int blocosReducao(int n)
+{
+    return (n + TAM_BLOCO_REDUCAO - 1) / TAM_BLOCO_REDUCAO;
+}
+
+// Soma aos pares das nBlocos parciais (no lugar: parciais é sobrescrito)
+real_t somaParciais(real_t *parciais, int nBlocos);
+
+/**
+ * soma = soma reprodutível sobre i em [0, n): CORPO é executado para cada
+ * linha i e acumula o termo em 's' (pode também atualizar vetores, como nos
+ * laços fundidos do PCG). parciais: blocosReducao(n) posições.
+ */
+#define SOMA_REPRODUTIVEL(soma, parciais, n, paralelo, CORPO) do { \
+    const int nBlocos_ = blocosReducao(n), paralelo_ = (paralelo); \
+    _Pragma("omp parallel for schedule(static) if(paralelo_)") \
+    for (int blk_ = 0; blk_ < nBlocos_; blk_++) { \
+        const int i0_ = blk_ * TAM_BLOCO_REDUCAO; \
+        const int i1_ = (i0_ + TAM_BLOCO_REDUCAO < (n)) ? i0_ + TAM_BLOCO_REDUCAO : (n); \
+        real_t s = 0.0; \
+        _Pragma("omp simd reduction(+:s)") \
+        for (int i = i0_; i < i1_; i++) { CORPO } \
+        (parciais)[blk_] = s; \
+    } \
+    (soma) = somaParciais((parciais), nBlocos_); \
+} while (0)
+
+// x . y reprodutível (parciais: blocosReducao(n) posições)
+real_t produtoReprodutivel(const real_t *x, const real_t *y, int n, real_t *parciais);
+
+#endif // __REDUCAO_H__
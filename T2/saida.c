@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include "saida.h"
+#include "arena.h"
+
+//Ciclo de um registro: o produtor o abre (TEXTO), publica o vetor (VETOR) e o fecha
+//(FECHADO); a escritora o devolve (LIVRE) depois de escrever o texto final
+enum { REGISTRO_LIVRE, REGISTRO_TEXTO, REGISTRO_VETOR, REGISTRO_FECHADO };
+
+typedef struct {
+    int estado;
+    char antes[TAM_TEXTO_SAIDA], depois[TAM_TEXTO_SAIDA];
+    size_t tamAntes, tamDepois;
+    real_t *x;              // cópia do vetor (nMax posições)
+    int n;
+} registroSaida_t;
+
+struct saida_t {
+    FILE *arquivo;
+    int nMax;
+    arena_t *arena;         // cópias dos vetores e o bloco de texto
+    registroSaida_t reg[REGISTROS_SAIDA];
+    int atual;              // registro do produtor
+    char *bloco;            // texto formatado pela escritora antes de cada fwrite
+
+    pthread_t escritora;
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;   // algum registro mudou de estado
+    int encerra, ativa;
+
+    //estatísticas
+    long registros;
+    double bytes;
+    double tempoEscrita;    // ms da escritora formatando e escrevendo
+    double tempoEspera;     // ms do produtor esperando um registro livre
+};
+
+static void escreveTexto(saida_t *o, const char *texto, size_t tam)
+{
+    if (!tam) return;
+    fwrite(texto, 1, tam, o->arquivo);
+    o->bytes += tam;
+}
+
+//Formata x em blocos de TAM_BLOCO_SAIDA bytes ("%.16g " tem no máximo 24 caracteres)
+static void escreveVetor(saida_t *o, const real_t *x, int n)
+{
+    size_t usado = 0;
+    for (int i = 0; i < n; ++i) {
+        if (usado > TAM_BLOCO_SAIDA - 32) {
+            escreveTexto(o, o->bloco, usado);
+            usado = 0;
+        }
+        usado += snprintf(o->bloco + usado, TAM_BLOCO_SAIDA - usado, "%.16g ", x[i]);
+    }
+    o->bloco[usado++] = '\n';
+    escreveTexto(o, o->bloco, usado);
+}
+
+static void *rotinaEscritora(void *arg)
+{
+    saida_t *o = arg;
+    int r = 0;
+
+    pthread_mutex_lock(&o->trava);
+    for (;;) {
+        registroSaida_t *reg = &o->reg[r];
+        while (reg->estado < REGISTRO_VETOR && !o->encerra) pthread_cond_wait(&o->sinal, &o->trava);
+        if (reg->estado < REGISTRO_VETOR) break;
+        pthread_mutex_unlock(&o->trava);
+
+        //o texto inicial e o vetor já estão completos: formatados enquanto o produtor segue
+        rtime_t t0 = timestamp();
+        escreveTexto(o, reg->antes, reg->tamAntes);
+        if (reg->n >= 0) escreveVetor(o, reg->x, reg->n);
+        t0 = timestamp() - t0;
+
+        pthread_mutex_lock(&o->trava);
+        while (reg->estado != REGISTRO_FECHADO) pthread_cond_wait(&o->sinal, &o->trava);
+        pthread_mutex_unlock(&o->trava);
+
+        rtime_t t1 = timestamp();
+        escreveTexto(o, reg->depois, reg->tamDepois);
+        fflush(o->arquivo);
+        t0 += timestamp() - t1;
+
+        pthread_mutex_lock(&o->trava);
+        o->tempoEscrita += t0;
+        o->registros++;
+        reg->estado = REGISTRO_LIVRE;
+        pthread_cond_broadcast(&o->sinal);
+        r = (r + 1) % REGISTROS_SAIDA;
+    }
+    pthread_mutex_unlock(&o->trava);
+    return NULL;
+}
+
+saida_t *criaSaida(FILE *arquivo, int nMax)
+{
+    saida_t *o = calloc(1, sizeof(saida_t));
+    if (!o) return NULL;
+    o->arquivo = arquivo;
+    o->nMax = nMax;
+    o->arena = criaArena(REGISTROS_SAIDA * tamanhoVetorArena(nMax) + TAM_BLOCO_SAIDA, ARENA_PAGINAS_ENORMES);
+    if (!o->arena) {
+        free(o);
+        return NULL;
+    }
+    for (int r = 0; r < REGISTROS_SAIDA; ++r) o->reg[r].x = arenaVetor(o->arena, nMax);
+    o->bloco = arenaAloca(o->arena, TAM_BLOCO_SAIDA);
+
+    pthread_mutex_init(&o->trava, NULL);
+    pthread_cond_init(&o->sinal, NULL);
+    //sem a thread, fechaRegistroSaida escreve o registro na hora
+    o->ativa = (pthread_create(&o->escritora, NULL, rotinaEscritora, o) == 0);
+    return o;
+}
+
+//Registro do produtor; abre o próximo quando o atual já foi fechado (espera a escritora liberá-lo)
+static registroSaida_t *registroAtual(saida_t *o)
+{
+    registroSaida_t *reg = &o->reg[o->atual];
+    pthread_mutex_lock(&o->trava);
+    if (reg->estado == REGISTRO_FECHADO) {
+        rtime_t t0 = timestamp();
+        while (reg->estado != REGISTRO_LIVRE) pthread_cond_wait(&o->sinal, &o->trava);
+        o->tempoEspera += timestamp() - t0;
+    }
+    if (reg->estado == REGISTRO_LIVRE) {
+        reg->estado = REGISTRO_TEXTO;
+        reg->tamAntes = reg->tamDepois = 0;
+        reg->n = 0;
+    }
+    pthread_mutex_unlock(&o->trava);
+    return reg;
+}
+
+void printfSaida(saida_t *o, const char *formato, ...)
+{
+    registroSaida_t *reg = registroAtual(o);
+    char *texto = (reg->estado == REGISTRO_TEXTO) ? reg->antes : reg->depois;
+    size_t *tam = (reg->estado == REGISTRO_TEXTO) ? &reg->tamAntes : &reg->tamDepois;
+
+    va_list args;
+    va_start(args, formato);
+    int escritos = vsnprintf(texto + *tam, TAM_TEXTO_SAIDA - *tam, formato, args);
+    va_end(args);
+    //texto além de TAM_TEXTO_SAIDA é cortado
+    if (escritos > 0) *tam += ((size_t) escritos < TAM_TEXTO_SAIDA - *tam) ? (size_t) escritos : TAM_TEXTO_SAIDA - 1 - *tam;
+}
+
+void vetorSaida(saida_t *o, const real_t *x, int n)
+{
+    registroSaida_t *reg = registroAtual(o);
+    if (n > o->nMax) n = o->nMax;
+    memcpy(reg->x, x, (size_t) n * sizeof(real_t));
+    reg->n = n;
+
+    pthread_mutex_lock(&o->trava);
+    reg->estado = REGISTRO_VETOR;
+    pthread_cond_broadcast(&o->sinal);
+    pthread_mutex_unlock(&o->trava);
+}
+
+void fechaRegistroSaida(saida_t *o)
+{
+    registroSaida_t *reg = registroAtual(o);
+    if (!o->ativa) {
+        escreveTexto(o, reg->antes, reg->tamAntes);
+        if (reg->estado == REGISTRO_VETOR) escreveVetor(o, reg->x, reg->n);
+        escreveTexto(o, reg->depois, reg->tamDepois);
+        o->registros++;
+        reg->estado = REGISTRO_LIVRE;
+    } else {
+        //sem vetor, o registro é só texto: o vazio entre os dois não escreve nada
+        pthread_mutex_lock(&o->trava);
+        if (reg->estado == REGISTRO_TEXTO) reg->n = -1;
+        reg->estado = REGISTRO_FECHADO;
+        pthread_cond_broadcast(&o->sinal);
+        pthread_mutex_unlock(&o->trava);
+    }
+    o->atual = (o->atual + 1) % REGISTROS_SAIDA;
+}
+
+void encerraSaida(saida_t *o)
+{
+    if (!o->ativa) {
+        fflush(o->arquivo);
+        return;
+    }
+    //um registro aberto é fechado como está
+    if (o->reg[o->atual].estado == REGISTRO_TEXTO || o->reg[o->atual].estado == REGISTRO_VETOR)
+        fechaRegistroSaida(o);
+
+    pthread_mutex_lock(&o->trava);
+    o->encerra = 1;
+    pthread_cond_broadcast(&o->sinal);
+    pthread_mutex_unlock(&o->trava);
+    pthread_join(o->escritora, NULL);
+    o->ativa = 0;
+    fflush(o->arquivo);
+}
+
+void relatorioSaida(const saida_t *o, FILE *saida)
+{
+    fprintf(saida, "# saida: %ld registros (%.1f MiB), %.3f ms de formatação e escrita em segundo plano, "
+            "%.3f ms de espera por um buffer livre\n", o->registros, o->bytes / (1 << 20), o->tempoEscrita,
+            o->tempoEspera);
+}
+
+void liberaSaida(saida_t *o)
+{
+    if (!o) return;
+    encerraSaida(o);
+    pthread_mutex_destroy(&o->trava);
+    pthread_cond_destroy(&o->sinal);
+    liberaArena(o->arena);
+    free(o);
+}
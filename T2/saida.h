@@ -0,0 +1,47 @@
+#ifndef __SAIDA_H__
+#define __SAIDA_H__
+
+#include <stdio.h>
+#include "utils.h"
+
+#define REGISTROS_SAIDA 2       // registros em andamento (buffer duplo)
+#define TAM_BLOCO_SAIDA 65536   // bytes de texto formatados entre dois fwrite
+#define TAM_TEXTO_SAIDA 1024    // texto antes e depois do vetor em cada registro
+
+/**
+ * Saída assíncrona: uma thread escritora formata e escreve os resultados
+ * enquanto o programa segue (liberação dos buffers, próximo SL).
+ *
+ * Cada registro é um texto, um vetor e outro texto (no cgSolver: n, x e as
+ * normas e tempos). vetorSaida copia o vetor para um dos REGISTROS_SAIDA
+ * buffers da escritora, que começa a formatá-lo na hora, em blocos de
+ * TAM_BLOCO_SAIDA bytes; o texto depois do vetor pode chegar mais tarde
+ * (as normas e tempos fecham o registro). Com os dois buffers, um registro é
+ * preenchido enquanto o anterior é escrito; só com os dois ocupados quem
+ * escreve espera. A ordem e o conteúdo da saída são os da escrita direta.
+ *
+ * Um produtor por vez (a thread que escreve os resultados).
+ */
+typedef struct saida_t saida_t;
+
+// Saída para 'arquivo' com vetores de até nMax valores. NULL em erro.
+saida_t *criaSaida(FILE *arquivo, int nMax);
+
+// Texto do registro atual (antes do vetor ou, depois de vetorSaida, depois dele)
+void printfSaida(saida_t *o, const char *formato, ...) __attribute__((format(printf, 2, 3)));
+
+// Copia x (n valores, "%.16g " cada, e fim de linha) para o registro atual
+void vetorSaida(saida_t *o, const real_t *x, int n);
+
+// O registro atual está completo: a escritora o termina e o próximo começa
+void fechaRegistroSaida(saida_t *o);
+
+// Espera a escritora esvaziar os registros e a encerra (fflush do arquivo)
+void encerraSaida(saida_t *o);
+
+// Registros e bytes escritos, tempo da escritora e espera por um buffer livre
+void relatorioSaida(const saida_t *o, FILE *saida);
+
+void liberaSaida(saida_t *o);
+
+#endif // __SAIDA_H__
@@ -0,0 +1,345 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "utils.h"
+#include "sislin.h"
+#include "arena.h"
+#include "topologia.h"
+#include "nucleos.h"
+#include "sintonia.h"
+
+static const char *NOMES_VARIANTE[] = { "diagonais", "linhas", "blocos" };
+
+// Blocos de linhas testados na variante SPMV_BLOCOS
+static const int BLOCOS_CANDIDATOS[] = { 2048, 8192, 32768 };
+#define N_BLOCOS_CANDIDATOS (int) (sizeof(BLOCOS_CANDIDATOS) / sizeof(BLOCOS_CANDIDATOS[0]))
+
+// Tempo mínimo de medição de cada candidata (ms) e linhas mínimas por amostra
+#define TEMPO_MEDICAO 10.0
+#define LINHAS_POR_AMOSTRA 100000
+
+// ========== Variantes do SpMV ==========
+
+//Linhas [i0, i1) de y = A x, diagonais no laço externo
+static inline void spmvDiagonaisFaixa(const real_t *A, const real_t *x, real_t *y, int n, int i0, int i1)
+{
+    for (int i = i0; i < i1; ++i) y[i] = 0.0;
+
+    for (int diag_idx = 0; diag_idx < N_DIAG; diag_idx++) {
+        int offset = diag_idx - OFFSET_CENTER;
+        int inicio = (offset < 0) ? -offset : 0;
+        int fim    = (offset > 0) ? n - offset : n;
+        if (inicio < i0) inicio = i0;
+        if (fim > i1) fim = i1;
+
+        const real_t *diagonal = &A[diag_idx * n];
+        for (int i = inicio; i < fim; i++) y[i] += diagonal[i] * x[i + offset];
+    }
+}
+
+//Linha i perto das bordas: só as diagonais que existem nela
+static inline real_t linhaBorda(const real_t *A, const real_t *x, int n, int i)
+{
+    real_t soma = 0.0;
+    for (int diag_idx = 0; diag_idx < N_DIAG; diag_idx++) {
+        int j = i + diag_idx - OFFSET_CENTER;
+        if (j >= 0 && j < n) soma += A[diag_idx * n + i] * x[j];
+    }
+    return soma;
+}
+
+//Linhas [i0, i1) de y = A x, linhas no laço externo. As somas seguem a ordem
+//das diagonais, então o resultado é o mesmo de spmvDiagonaisFaixa
+static inline void spmvLinhasFaixa(const real_t *A, const real_t *x, real_t *y, int n, int i0, int i1)
+{
+    //linhas internas: todas as N_DIAG diagonais existem
+    int meio0 = (i0 > OFFSET_CENTER) ? i0 : OFFSET_CENTER;
+    int meio1 = (i1 < n - OFFSET_CENTER) ? i1 : n - OFFSET_CENTER;
+    if (meio0 > i1) meio0 = i1;
+    if (meio1 < meio0) meio1 = meio0;
+
+    for (int i = i0; i < meio0; i++) y[i] = linhaBorda(A, x, n, i);
+
+    for (int i = meio0; i < meio1; i++) {
+        real_t soma = 0.0;
+        for (int diag_idx = 0; diag_idx < N_DIAG; diag_idx++)
+            soma += A[diag_idx * n + i] * x[i + diag_idx - OFFSET_CENTER];
+        y[i] = soma;
+    }
+
+    for (int i = meio1; i < i1; i++) y[i] = linhaBorda(A, x, n, i);
+}
+
+void spmvSintonizado(const escolhaSpmv_t *escolha, const real_t *A, const real_t *x, real_t *y, int n)
+{
+    const int nt = escolha->nThreads;
+
+    #pragma omp parallel num_threads(nt) if(nt > 1)
+    {
+        int i0, i1;
+        faixaThread(n, &i0, &i1);
+
+        switch (escolha->variante) {
+            case SPMV_LINHAS:
+                spmvLinhasFaixa(A, x, y, n, i0, i1);
+                break;
+            case SPMV_BLOCOS:
+                for (int b0 = i0; b0 < i1; b0 += escolha->bloco)
+                    spmvDiagonaisFaixa(A, x, y, n, b0, (b0 + escolha->bloco < i1) ? b0 + escolha->bloco : i1);
+                break;
+            default:
+                spmvDiagonaisFaixa(A, x, y, n, i0, i1);
+        }
+    }
+}
+
+const char *descreveEscolha(const escolhaSpmv_t *escolha, char *texto, size_t tam)
+{
+    if (escolha->variante == SPMV_BLOCOS)
+        snprintf(texto, tam, "%s de %d linhas, %d thread%s", NOMES_VARIANTE[escolha->variante],
+                 escolha->bloco, escolha->nThreads, escolha->nThreads > 1 ? "s" : "");
+    else
+        snprintf(texto, tam, "%s, %d thread%s", NOMES_VARIANTE[escolha->variante],
+                 escolha->nThreads, escolha->nThreads > 1 ? "s" : "");
+    return texto;
+}
+
+// ========== Operador "dia" sintonizado ==========
+
+typedef struct {
+    real_t *A;
+    escolhaSpmv_t escolha;
+} diaSintonizado_t;
+
+static void aplicaDIASintonizado(const operador_t *op, const real_t *x, real_t *y)
+{
+    const diaSintonizado_t *d = op->dados;
+    spmvSintonizado(&d->escolha, d->A, x, y, op->n);
+}
+
+static void residuoDIASintonizado(const operador_t *op, const real_t *b, const real_t *x, real_t *r)
+{
+    const diaSintonizado_t *d = op->dados;
+    residuoDIA_d(d->A, b, x, r, op->n);
+}
+
+static void liberaDIASintonizado(operador_t *op)
+{
+    free(op->dados);
+}
+
+operador_t *criaOperadorDIASintonizado(real_t *A, int n, const escolhaSpmv_t *escolha)
+{
+    operador_t *op = calloc(1, sizeof(operador_t));
+    diaSintonizado_t *d = malloc(sizeof(diaSintonizado_t));
+    if (!op || !d) {
+        free(op); free(d);
+        return NULL;
+    }
+
+    d->A = A;
+    d->escolha = *escolha;
+
+    op->formato = "dia";
+    op->n = n;
+    op->dados = d;
+    op->aplica = aplicaDIASintonizado;
+    op->residuo = residuoDIASintonizado;
+    op->libera = liberaDIASintonizado;
+    return op;
+}
+
+// ========== Arquivo de sabedoria ==========
+
+//Modelo da CPU ("model name" de /proc/cpuinfo), sem '|' (separador das chaves)
+static void leModeloCPU(char *modelo, size_t tam)
+{
+    snprintf(modelo, tam, "desconhecido");
+
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (!f) return;
+
+    char linha[512];
+    while (fgets(linha, sizeof(linha), f)) {
+        if (strncmp(linha, "model name", 10) != 0) continue;
+        char *valor = strchr(linha, ':');
+        if (!valor) break;
+        valor++;
+        while (*valor == ' ' || *valor == '\t') valor++;
+        valor[strcspn(valor, "\n")] = '\0';
+        snprintf(modelo, tam, "%s", valor);
+        for (char *c = modelo; *c; c++) if (*c == '|') *c = '/';
+        break;
+    }
+    fclose(f);
+}
+
+//floor(log2 n): a mesma escolha vale para n entre 2^faixa e 2^(faixa+1)
+static int faixaN(int n)
+{
+    int faixa = 0;
+    while (n >>= 1) faixa++;
+    return faixa;
+}
+
+sabedoria_t *carregaSabedoria(const char *arquivo)
+{
+    sabedoria_t *sab = calloc(1, sizeof(sabedoria_t));
+    if (!sab) return NULL;
+
+    leModeloCPU(sab->cpuLocal, sizeof(sab->cpuLocal));
+    if (!arquivo) return sab;
+
+    sab->arquivo = strdup(arquivo);
+    if (!sab->arquivo) {
+        free(sab);
+        return NULL;
+    }
+    FILE *f = fopen(arquivo, "r");
+    if (!f) return sab; // primeira execução: sabedoria vazia
+
+    char linha[512];
+    while (fgets(linha, sizeof(linha), f) && sab->nEntradas < SABEDORIA_MAX_ENTRADAS) {
+        if (linha[0] == '#' || linha[0] == '\n') continue;
+
+        entradaSabedoria_t *e = &sab->entradas[sab->nEntradas];
+        char variante[16];
+        if (sscanf(linha, "%127[^|]|%15[^|]|%d|%d %15s %d %d %lf", e->cpu, e->formato, &e->k, &e->faixa,
+                   variante, &e->escolha.nThreads, &e->escolha.bloco, &e->escolha.tempo) != 8)
+            continue;
+
+        int v;
+        for (v = 0; v < 3 && strcmp(variante, NOMES_VARIANTE[v]); v++);
+        if (v == 3 || e->escolha.nThreads < 1) continue;
+        e->escolha.variante = v;
+        sab->nEntradas++;
+    }
+    fclose(f);
+    return sab;
+}
+
+int salvaSabedoria(sabedoria_t *sab)
+{
+    if (!sab || !sab->arquivo || !sab->alterada) return 0;
+
+    char tmp[4096];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", sab->arquivo);
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        printf("Erro: não foi possível gravar a sabedoria em %s\n", tmp);
+        return -1;
+    }
+
+    fprintf(f, "# sabedoria do SpMV: cpu|formato|k|floor(log2 n) variante threads bloco ns/linha\n");
+    for (int i = 0; i < sab->nEntradas; i++) {
+        const entradaSabedoria_t *e = &sab->entradas[i];
+        fprintf(f, "%s|%s|%d|%d %s %d %d %.4f\n", e->cpu, e->formato, e->k, e->faixa,
+                NOMES_VARIANTE[e->escolha.variante], e->escolha.nThreads, e->escolha.bloco, e->escolha.tempo);
+    }
+
+    int ok = (fclose(f) == 0);
+    if (ok) ok = (rename(tmp, sab->arquivo) == 0);
+    if (!ok) {
+        printf("Erro: não foi possível gravar a sabedoria em %s\n", sab->arquivo);
+        return -1;
+    }
+    sab->alterada = 0;
+    return 0;
+}
+
+void liberaSabedoria(sabedoria_t *sab)
+{
+    if (!sab) return;
+    free(sab->arquivo);
+    free(sab);
+}
+
+// ========== Medição ==========
+
+//Melhor tempo (ns por linha) de uma candidata: amostras de 'lote' produtos
+//(n pequeno: vários produtos por amostra) até TEMPO_MEDICAO ms e ao menos 3 amostras
+static double medeCandidata(const escolhaSpmv_t *c, const real_t *A, const real_t *x, real_t *y, int n)
+{
+    const int lote = (n < LINHAS_POR_AMOSTRA) ? LINHAS_POR_AMOSTRA / n : 1;
+
+    spmvSintonizado(c, A, x, y, n); // aquecimento (páginas, threads)
+
+    double melhor = INFINITY;
+    rtime_t inicio = timestamp();
+    for (int amostras = 0; amostras < 3 || timestamp() - inicio < TEMPO_MEDICAO; amostras++) {
+        rtime_t t0 = timestamp();
+        for (int l = 0; l < lote; l++) spmvSintonizado(c, A, x, y, n);
+        double t = (timestamp() - t0) / lote;
+        if (t < melhor) melhor = t;
+    }
+    return melhor * 1e6 / n;
+}
+
+int sintonizaSpmv(sabedoria_t *sab, int n, int k, const char *formato, escolhaSpmv_t *escolha, int *medida)
+{
+    *medida = 0;
+
+    //só o formato de diagonais com k = N_DIAG tem variantes compiladas
+    if (strcmp(formato, "dia") != 0 || k != N_DIAG) return -1;
+
+#ifdef _OPENMP
+    const int maxThreads = omp_get_max_threads();
+#else
+    const int maxThreads = 1;
+#endif
+
+    const int faixa = faixaN(n);
+    for (int i = 0; i < sab->nEntradas; i++) {
+        const entradaSabedoria_t *e = &sab->entradas[i];
+        if (e->k == k && e->faixa == faixa && !strcmp(e->formato, formato) && !strcmp(e->cpu, sab->cpuLocal)) {
+            *escolha = e->escolha;
+            //sabedoria gerada com mais threads do que as disponíveis agora
+            if (escolha->nThreads > maxThreads) escolha->nThreads = maxThreads;
+            return 0;
+        }
+    }
+
+    //matriz sintética de dimensão n (o tempo não depende dos valores)
+    arena_t *arena = criaArena(tamanhoVetorArena((size_t) n * k) + 2 * tamanhoVetorArena(n),
+                               ARENA_PAGINAS_ENORMES | ARENA_PRIMEIRO_TOQUE);
+    if (!arena) return -1;
+    real_t *A = arenaDiagonais(arena, n, k);
+    real_t *x = arenaVetor(arena, n);
+    real_t *y = arenaVetor(arena, n);
+    for (size_t i = 0; i < (size_t) n * k; i++) A[i] = 1.0 / (1.0 + i % 7);
+    for (int i = 0; i < n; i++) x[i] = 1.0;
+
+    escolhaSpmv_t melhor = { SPMV_DIAGONAIS, 1, 0, INFINITY };
+    for (int nt = 1; ; nt = (2 * nt < maxThreads) ? 2 * nt : maxThreads) {
+        escolhaSpmv_t c = { SPMV_DIAGONAIS, nt, 0, 0.0 };
+        for (int v = SPMV_DIAGONAIS; v <= SPMV_BLOCOS; v++) {
+            c.variante = v;
+            int nBlocos = (v == SPMV_BLOCOS) ? N_BLOCOS_CANDIDATOS : 1;
+            for (int b = 0; b < nBlocos; b++) {
+                c.bloco = (v == SPMV_BLOCOS) ? BLOCOS_CANDIDATOS[b] : 0;
+                //bloco maior que a faixa da thread é a variante 'diagonais'
+                if (v == SPMV_BLOCOS && c.bloco >= n / nt) continue;
+
+                c.tempo = medeCandidata(&c, A, x, y, n);
+                if (c.tempo < melhor.tempo) melhor = c;
+            }
+        }
+        if (nt == maxThreads) break;
+    }
+    liberaArena(arena);
+
+    *escolha = melhor;
+    *medida = 1;
+
+    if (sab->nEntradas < SABEDORIA_MAX_ENTRADAS) {
+        entradaSabedoria_t *e = &sab->entradas[sab->nEntradas++];
+        memcpy(e->cpu, sab->cpuLocal, sizeof(e->cpu));
+        snprintf(e->formato, sizeof(e->formato), "%s", formato);
+        e->k = k;
+        e->faixa = faixa;
+        e->escolha = melhor;
+        sab->alterada = 1;
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+#ifndef __SINTONIA_H__
+#define __SINTONIA_H__
+
+#include "utils.h"
+#include "operador.h"
+
+// Máximo de entradas num arquivo de sabedoria
+#define SABEDORIA_MAX_ENTRADAS 256
+
+// Variantes do SpMV no formato de diagonais
+typedef enum {
+    SPMV_DIAGONAIS, // diagonais no laço externo, faixa inteira da thread (multDiagonais)
+    SPMV_LINHAS,    // linhas no laço externo, as K diagonais desenroladas (uma escrita de y por linha)
+    SPMV_BLOCOS     // diagonais no laço externo em blocos de 'bloco' linhas (y do bloco fica na cache)
+} varianteSpmv_t;
+
+// Configuração escolhida para o SpMV (tempo: ns por linha na medição)
+typedef struct {
+    varianteSpmv_t variante;
+    int nThreads;
+    int bloco;
+    double tempo;
+} escolhaSpmv_t;
+
+/**
+ * Sabedoria (como a do FFTW): a melhor configuração do SpMV por
+ * (modelo da CPU, formato, k, faixa de n = floor(log2 n)), guardada num
+ * arquivo texto, uma linha por entrada:
+ *   <cpu>|<formato>|<k>|<faixa> <variante> <threads> <bloco> <ns/linha>
+ * Carregar é só ler esse arquivo; a medição acontece uma vez por chave.
+ */
+typedef struct {
+    char cpu[128];
+    char formato[16];
+    int k, faixa;
+    escolhaSpmv_t escolha;
+} entradaSabedoria_t;
+
+typedef struct {
+    char cpuLocal[128];     // modelo da CPU desta máquina (/proc/cpuinfo)
+    char *arquivo;          // NULL: só em memória
+    int nEntradas;
+    int alterada;           // há entradas novas a salvar
+    entradaSabedoria_t entradas[SABEDORIA_MAX_ENTRADAS];
+} sabedoria_t;
+
+// Lê o arquivo (inexistente = sabedoria vazia). Retorna NULL só em falta de memória.
+sabedoria_t *carregaSabedoria(const char *arquivo);
+
+// Regrava o arquivo se houver entradas novas (arquivo temporário + rename). Retorna 0 ou -1.
+int salvaSabedoria(sabedoria_t *sab);
+void liberaSabedoria(sabedoria_t *sab);
+
+/**
+ * Configuração do SpMV para (n, k, formato) nesta CPU: da sabedoria se a
+ * chave existir; senão mede cada candidata (variantes x threads x blocos)
+ * com uma matriz sintética de dimensão n e guarda a mais rápida.
+ * *medida recebe 1 se houve medição. Retorna 0 ou -1 (formato/k sem núcleo).
+ */
+int sintonizaSpmv(sabedoria_t *sab, int n, int k, const char *formato, escolhaSpmv_t *escolha, int *medida);
+
+// y = A x com a configuração escolhida (A no formato de diagonais, N_DIAG diagonais)
+void spmvSintonizado(const escolhaSpmv_t *escolha, const real_t *A, const real_t *x, real_t *y, int n);
+
+// Operador "dia" cujo produto usa spmvSintonizado (sem cópia de A)
+operador_t *criaOperadorDIASintonizado(real_t *A, int n, const escolhaSpmv_t *escolha);
+
+// Texto curto da configuração ("linhas, 4 threads")
+const char *descreveEscolha(const escolhaSpmv_t *escolha, char *texto, size_t tam);
+
+#endif // __SINTONIA_H__
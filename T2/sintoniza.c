@@ -0,0 +1,69 @@
+#include "sislin.h"
+#include "sintonia.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Gera a sabedoria do SpMV para uma lista de dimensões (uma medição por faixa de n),
+// para distribuir às máquinas com a mesma CPU antes das execuções do cgSolver
+static void uso(const char *prog) {
+    printf("uso: %s [-w arquivo] [-k k] [-f formato] n [n ...]\n", prog);
+    printf("  -w arq   arquivo de sabedoria (padrão: sabedoria.txt); entradas existentes são mantidas\n");
+    printf("  -k k     número de diagonais (padrão: %d)\n", N_DIAG);
+    printf("  -f fmt   formato de A (padrão: dia)\n");
+}
+
+int main(int argc, char **argv) {
+    char *arquivo = "sabedoria.txt";
+    char *formato = "dia";
+    int k = N_DIAG;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "w:k:f:")) != -1) {
+        switch (opt) {
+            case 'w': arquivo = optarg; break;
+            case 'k': k = atoi(optarg); break;
+            case 'f': formato = optarg; break;
+            default: uso(argv[0]); return 1;
+        }
+    }
+    if (optind >= argc) {
+        uso(argv[0]);
+        return 1;
+    }
+
+    sabedoria_t *sab = carregaSabedoria(arquivo);
+    if (!sab) {
+        printf("Erro de alocação de memória\n");
+        return 1;
+    }
+    printf("# cpu: %s (%d entradas em %s)\n", sab->cpuLocal, sab->nEntradas, arquivo);
+
+    for (int a = optind; a < argc; a++) {
+        int n = atoi(argv[a]);
+        if (n <= 10) {
+            printf("Erro: dimensão deve ser > 10 (%s)\n", argv[a]);
+            liberaSabedoria(sab);
+            return 1;
+        }
+
+        escolhaSpmv_t escolha;
+        int medida;
+        rtime_t t0 = timestamp();
+        if (sintonizaSpmv(sab, n, k, formato, &escolha, &medida)) {
+            printf("Erro: sem núcleos sintonizáveis para formato %s com k = %d\n", formato, k);
+            liberaSabedoria(sab);
+            return 1;
+        }
+
+        char texto[64];
+        printf("n = %d: %s, %.3f ns/linha (%s, %.1f ms)\n", n, descreveEscolha(&escolha, texto, sizeof(texto)),
+               escolha.tempo, medida ? "medida" : "já na sabedoria", timestamp() - t0);
+    }
+
+    int erro = salvaSabedoria(sab);
+    liberaSabedoria(sab);
+    return erro ? 1 : 0;
+}
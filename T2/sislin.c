@@ -46,6 +46,39 @@ void criaKDiagonal(int n, int k, real_t *A, real_t *B) {
     }
 }
 
+//Gera apenas o bloco de linhas [inicio, inicio + nLocal) do SL k-diagonal,
+//no layout local A[diag_idx * nLocal + (i - inicio)].
+//Consome a sequência de random() na mesma ordem de criaKDiagonal, então o
+//bloco é idêntico ao trecho correspondente do sistema serial (custo O(k*n) em
+//chamadas a random(), mas memória O(k*nLocal))
+void criaKDiagonalBloco(int n, int k, int inicio, int nLocal, real_t *A, real_t *B) {
+    int d = (k - 1) / 2;
+    int fimBloco = inicio + nLocal;
+
+    for (int diag_idx = 0; diag_idx < k; ++diag_idx) {
+        int offset = diag_idx - d;
+        int i_start = (offset < 0) ? -offset : 0;
+        int i_end   = (offset > 0) ? n - offset : n;
+
+        //fora da matriz a diagonal é zero
+        for (int i = 0; i < nLocal; ++i) A[diag_idx * nLocal + i] = 0.0;
+
+        for (int i = i_start; i < i_end; ++i) {
+            if (i >= inicio && i < fimBloco)
+                A[diag_idx * nLocal + (i - inicio)] = generateRandomA(i, i + offset, k);
+            else
+                random(); //avança a sequência como no gerador serial
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        if (i >= inicio && i < fimBloco)
+            B[i - inicio] = generateRandomB(k);
+        else
+            random();
+    }
+}
+
 //Função Simetrica Positiva 
 void genSimetricaPositiva(real_t *A, real_t *b, int n, int k, real_t *ASP, real_t *bsp, real_t *tempo)
 {
@@ -53,16 +86,22 @@ void genSimetricaPositiva(real_t *A, real_t *b, int n, int k, real_t *ASP, real_
     //printf("genSimetricPositiva");
     
     //Recupera constantes do formato
-    int d_A = (k - 1) / 2;
     int k_ASP = N_DIAG;
     int offset_center = OFFSET_CENTER; 
     
     
-    //zera ASP
-    for(int i=0; i < n * k_ASP; i++) ASP[i] = 0.0;
-
     int d_ASP = (k_ASP - 1) / 2; //3
 
+    //zera só as posições de cada diagonal que caem fora da matriz (as demais são
+    //escritas abaixo): evita uma passada inteira de zeragem sobre ASP
+    for (int diag_idx = 0; diag_idx < k_ASP; ++diag_idx) {
+        int offset = diag_idx - offset_center;
+        int i_start = (offset < 0) ? -offset : 0;
+        int i_end   = (offset > 0) ? n - offset : n;
+        for (int i = 0; i < i_start; ++i) ASP[diag_idx * n + i] = 0.0;
+        for (int i = i_end; i < n; ++i) ASP[diag_idx * n + i] = 0.0;
+    }
+
     //Preenche mantendo estrutura
     for (int i = 0; i < n; ++i) {
         int j_start = (i - d_ASP < 0) ? 0 : i - d_ASP;
@@ -85,6 +124,21 @@ void genSimetricaPositiva(real_t *A, real_t *b, int n, int k, real_t *ASP, real_
     *tempo = timestamp() - *tempo;
 }
 
+//Versão por bloco de genSimetricaPositiva: preenche as N_DIAG diagonais das
+//linhas [inicio, inicio + nLocal) no layout local ASP[diag_idx * nLocal + i].
+//Posições fora da matriz global ficam zeradas, assim os kernels distribuídos
+//não precisam testar as bordas.
+void genSimetricaPositivaBloco(int n, int inicio, int nLocal, real_t *ASP)
+{
+    for (int diag_idx = 0; diag_idx < N_DIAG; ++diag_idx) {
+        int offset = diag_idx - OFFSET_CENTER;
+        for (int i = 0; i < nLocal; ++i) {
+            int j = inicio + i + offset;
+            ASP[diag_idx * nLocal + i] = (j >= 0 && j < n) ? 1.0 : 0.0; //mesmo valor de teste do serial
+        }
+    }
+}
+
 //gera vetores de Decomposião DLU
 void geraDLU (real_t *A, int n, int k, real_t *D, real_t *L, real_t *U, rtime_t *tempo, double eps)
 {
@@ -123,6 +177,35 @@ void geraPreCond(real_t *D, real_t *L, real_t *U, real_t w, int n, int k, real_t
     *tempo = timestamp() - *tempo;
 }
 
+//Escala simétrica D^-1/2 A D^-1/2 (k diagonais, no lugar) e b <- D^-1/2 b.
+//raizD recebe D^1/2 (x = D^-1/2 y volta ao sistema original). Retorna -1 se algum M[i] <= 0
+int escalaSimetrica(real_t *A, real_t *b, int n, int k, const real_t *M, real_t *raizD, rtime_t *tempo)
+{
+    rtime_t t0 = timestamp();
+    int d = (k - 1) / 2;
+
+    int invalidos = 0;
+    #pragma omp parallel for schedule(static) reduction(+:invalidos)
+    for (int i = 0; i < n; ++i) {
+        if (!(M[i] > 0.0)) invalidos++;
+        raizD[i] = sqrt(M[i]);
+    }
+    if (invalidos) return -1;
+
+    //A_ij / (sqrt(D_i) sqrt(D_j)), linhas divididas entre as threads como no SpMV
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; ++i) {
+        for (int diag_idx = 0; diag_idx < k; ++diag_idx) {
+            int j = i + diag_idx - d;
+            if (j >= 0 && j < n) A[diag_idx * n + i] /= raizD[i] * raizD[j];
+        }
+        b[i] /= raizD[i];
+    }
+
+    *tempo += timestamp() - t0;
+    return 0;
+}
+
 //Calcula a Norm do Resíduo Euclidiano
 real_t calcResiduoSL (real_t *A, real_t *b, real_t *X, int n, int k, rtime_t *tempo)
 {
@@ -22,15 +22,16 @@
 #define N_DIAG 7        // Total de diagonais
 #define OFFSET_CENTER 3 // Onde fica a diagonal principal (índice 3)
 
-typedef double real_t;
-typedef double rtime_t;
-
 // Funções do Sislin
 void criaKDiagonal(int n, int k, real_t *A, real_t *b);
+void criaKDiagonalBloco(int n, int k, int inicio, int nLocal, real_t *A, real_t *b);
+void genSimetricaPositivaBloco(int n, int inicio, int nLocal, real_t *ASP);
 void genSimetricaPositiva(real_t *A, real_t *b, int n, int k, real_t *ASP, real_t *bsp, rtime_t *tempo);
 void geraDLU(real_t *A, int n, int k, real_t *D, real_t *L, real_t *U, rtime_t *tempo, double eps);
 void geraPreCond(real_t *D, real_t *L, real_t *U, real_t w, int n, int k, real_t *M, rtime_t *tempo, double eps);
 
+int escalaSimetrica(real_t *A, real_t *b, int n, int k, const real_t *M, real_t *raizD, rtime_t *tempo);
+
 // OP2: Cálculo do Resíduo
 real_t calcResiduoSL(real_t *A, real_t *b, real_t *X, int n, int k, rtime_t *tempo);
 
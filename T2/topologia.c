@@ -0,0 +1,349 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "utils.h"
+#include "topologia.h"
+
+#define DIR_CPU "/sys/devices/system/cpu"
+#define DIR_NO  "/sys/devices/system/node"
+
+// Páginas consultadas por chamada de move_pages
+#define LOTE_PAGINAS 512
+
+// Bytes lidos por thread na medição de banda (repetições sobre as suas linhas)
+#define BYTES_MEDICAO (256UL << 20)
+
+// Destino da soma da medição de banda (impede que o compilador elimine a varredura)
+static volatile real_t sumidouro;
+
+//Lê a primeira linha de um arquivo do sysfs; retorna 0 em caso de sucesso
+static int leLinha(const char *caminho, char *linha, size_t tam)
+{
+    FILE *f = fopen(caminho, "r");
+    if (!f) return -1;
+    int ok = fgets(linha, tam, f) != NULL;
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+static int leInteiro(const char *caminho, int padrao)
+{
+    char linha[64];
+    return leLinha(caminho, linha, sizeof(linha)) ? padrao : atoi(linha);
+}
+
+//Lê uma lista de CPUs no formato do kernel ("0-3,8,10-11"); retorna o tamanho ou -1
+static int leListaCPUs(const char *texto, int *lista, int max)
+{
+    int tam = 0;
+    const char *p = texto;
+    while (*p && *p != '\n') {
+        char *fim;
+        long ini = strtol(p, &fim, 10);
+        if (fim == p || ini < 0) return -1;
+        long ult = ini;
+        if (*fim == '-') {
+            p = fim + 1;
+            ult = strtol(p, &fim, 10);
+            if (fim == p || ult < ini) return -1;
+        }
+        for (long c = ini; c <= ult; c++) {
+            if (tam >= max || c >= TOPO_MAX_CPUS) return -1;
+            lista[tam++] = (int) c;
+        }
+        p = fim;
+        if (*p == ',') p++;
+        else if (*p && *p != '\n') return -1;
+    }
+    return tam;
+}
+
+int leTopologia(topologia_t *topo)
+{
+    char linha[4096], caminho[512];
+    memset(topo, 0, sizeof(*topo));
+    for (int c = 0; c < TOPO_MAX_CPUS; c++) topo->no[c] = -1; // -1 = offline
+
+    if (leLinha(DIR_CPU "/online", linha, sizeof(linha)) == 0)
+        topo->nCPUs = leListaCPUs(linha, topo->cpus, TOPO_MAX_CPUS);
+    if (topo->nCPUs <= 0) {
+        //sem sysfs: CPUs 0..nproc-1
+        long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+        topo->nCPUs = (nproc > 0 && nproc <= TOPO_MAX_CPUS) ? (int) nproc : 1;
+        for (int i = 0; i < topo->nCPUs; i++) topo->cpus[i] = i;
+    }
+
+    for (int i = 0; i < topo->nCPUs; i++) {
+        int c = topo->cpus[i];
+        topo->no[c] = 0;
+        snprintf(caminho, sizeof(caminho), DIR_CPU "/cpu%d/topology/physical_package_id", c);
+        topo->pacote[c] = leInteiro(caminho, 0);
+        snprintf(caminho, sizeof(caminho), DIR_CPU "/cpu%d/topology/core_id", c);
+        topo->nucleo[c] = leInteiro(caminho, c);
+
+        //irmãs de SMT: CPUs anteriores no mesmo núcleo do mesmo soquete
+        topo->irma[c] = 0;
+        for (int j = 0; j < i; j++) {
+            int o = topo->cpus[j];
+            if (topo->pacote[o] == topo->pacote[c] && topo->nucleo[o] == topo->nucleo[c]) topo->irma[c]++;
+        }
+    }
+
+    //nós NUMA: /sys/devices/system/node/nodeN/cpulist
+    topo->nNos = 1;
+    DIR *dir = opendir(DIR_NO);
+    if (!dir) return 0;
+
+    struct dirent *ent;
+    int lista[TOPO_MAX_CPUS];
+    while ((ent = readdir(dir)) != NULL) {
+        int no;
+        if (sscanf(ent->d_name, "node%d", &no) != 1 || no < 0 || no >= TOPO_MAX_NOS) continue;
+
+        snprintf(caminho, sizeof(caminho), DIR_NO "/%s/cpulist", ent->d_name);
+        if (leLinha(caminho, linha, sizeof(linha))) continue;
+        int tam = leListaCPUs(linha, lista, TOPO_MAX_CPUS);
+        for (int i = 0; i < tam; i++) {
+            if (topo->no[lista[i]] < 0) continue; // CPU offline
+            topo->no[lista[i]] = no;
+            if (no + 1 > topo->nNos) topo->nNos = no + 1;
+        }
+    }
+    closedir(dir);
+    return 0;
+}
+
+//Caches da CPU 0: cache/indexN/{level,type,size} ("48K", "2048K", "256M")
+size_t tamanhoCache(int nivel)
+{
+    char caminho[128], linha[64];
+    for (int idx = 0; idx < 16; idx++) {
+        snprintf(caminho, sizeof(caminho), DIR_CPU "/cpu0/cache/index%d/level", idx);
+        int lv = leInteiro(caminho, -1);
+        if (lv < 0) break;
+        if (lv != nivel) continue;
+
+        snprintf(caminho, sizeof(caminho), DIR_CPU "/cpu0/cache/index%d/type", idx);
+        if (leLinha(caminho, linha, sizeof(linha)) || !strncmp(linha, "Instruction", 11)) continue;
+
+        snprintf(caminho, sizeof(caminho), DIR_CPU "/cpu0/cache/index%d/size", idx);
+        if (leLinha(caminho, linha, sizeof(linha))) return 0;
+        char *fim;
+        size_t tam = strtoul(linha, &fim, 10);
+        if (*fim == 'K') tam <<= 10;
+        else if (*fim == 'M') tam <<= 20;
+        else if (*fim == 'G') tam <<= 30;
+        return tam;
+    }
+    return 0;
+}
+
+void imprimeTopologia(const topologia_t *topo, FILE *saida)
+{
+    fprintf(saida, "# topologia: %d CPUs, %d nó(s) NUMA\n", topo->nCPUs, topo->nNos);
+    for (int no = 0; no < topo->nNos; no++) {
+        fprintf(saida, "#   nó %d:", no);
+        for (int i = 0; i < topo->nCPUs; i++)
+            if (topo->no[topo->cpus[i]] == no) fprintf(saida, " %d", topo->cpus[i]);
+        fprintf(saida, "\n");
+    }
+}
+
+//Ordem compacta: nó, depois irmã de SMT (núcleos físicos primeiro), soquete, núcleo
+static int antesCompacta(const topologia_t *topo, int a, int b)
+{
+    if (topo->no[a] != topo->no[b]) return topo->no[a] < topo->no[b];
+    if (topo->irma[a] != topo->irma[b]) return topo->irma[a] < topo->irma[b];
+    if (topo->pacote[a] != topo->pacote[b]) return topo->pacote[a] < topo->pacote[b];
+    if (topo->nucleo[a] != topo->nucleo[b]) return topo->nucleo[a] < topo->nucleo[b];
+    return a < b;
+}
+
+int ordemAfinidade(const topologia_t *topo, const char *politica, int *ordem)
+{
+    int compacta[TOPO_MAX_CPUS];
+    int n = topo->nCPUs;
+
+    //ordenação por inserção: n é no máximo TOPO_MAX_CPUS e isso roda uma vez
+    for (int i = 0; i < n; i++) {
+        int c = topo->cpus[i], j = i;
+        while (j > 0 && antesCompacta(topo, c, compacta[j - 1])) {
+            compacta[j] = compacta[j - 1];
+            j--;
+        }
+        compacta[j] = c;
+    }
+
+    if (strcmp(politica, "compact") == 0) {
+        memcpy(ordem, compacta, n * sizeof(int));
+        return n;
+    }
+
+    if (strcmp(politica, "scatter") == 0) {
+        //rodadas: a r-ésima CPU (na ordem compacta) de cada nó
+        int tam = 0;
+        for (int r = 0; tam < n; r++) {
+            for (int no = 0; no < topo->nNos; no++) {
+                int visto = 0;
+                for (int i = 0; i < n; i++) {
+                    if (topo->no[compacta[i]] != no) continue;
+                    if (visto++ == r) {
+                        ordem[tam++] = compacta[i];
+                        break;
+                    }
+                }
+            }
+        }
+        return n;
+    }
+
+    //lista explícita: só CPUs online
+    int tam = leListaCPUs(politica, ordem, TOPO_MAX_CPUS);
+    if (tam <= 0) return -1;
+    for (int i = 0; i < tam; i++) {
+        if (topo->no[ordem[i]] < 0) {
+            printf("Erro: CPU %d não está online\n", ordem[i]);
+            return -1;
+        }
+    }
+    return tam;
+}
+
+int fixaThreads(const topologia_t *topo, const char *politica, int *cpuDaThread)
+{
+    int ordem[TOPO_MAX_CPUS];
+    int nOrdem = ordemAfinidade(topo, politica, ordem);
+    if (nOrdem <= 0) return -1;
+
+#ifdef _OPENMP
+    int explicita = strcmp(politica, "compact") && strcmp(politica, "scatter");
+    if (explicita && !getenv("OMP_NUM_THREADS")) omp_set_num_threads(nOrdem);
+    if (omp_get_max_threads() > TOPO_MAX_CPUS) {
+        printf("Erro: mais de %d threads\n", TOPO_MAX_CPUS);
+        return -1;
+    }
+#endif
+
+    int nThreads = 1, falhas = 0;
+    //o pool de threads do libgomp é reaproveitado: a afinidade vale para as regiões seguintes
+    #pragma omp parallel reduction(+:falhas)
+    {
+#ifdef _OPENMP
+        int t = omp_get_thread_num();
+        #pragma omp single
+        nThreads = omp_get_num_threads();
+#else
+        int t = 0;
+#endif
+        int cpu = ordem[t % nOrdem];
+        cpu_set_t conjunto;
+        CPU_ZERO(&conjunto);
+        CPU_SET(cpu, &conjunto);
+        if (sched_setaffinity(0, sizeof(conjunto), &conjunto)) falhas++;
+        cpuDaThread[t] = cpu;
+    }
+
+    if (falhas) {
+        printf("Erro: sched_setaffinity falhou em %d thread(s)\n", falhas);
+        return -1;
+    }
+    return nThreads;
+}
+
+//Conta as páginas de [ini, fim) que estão no nó 'no'; *paginas recebe o total consultado
+static long paginasLocais(const real_t *ini, const real_t *fim, int no, long *paginas)
+{
+    long tamPagina = sysconf(_SC_PAGESIZE);
+    void *lote[LOTE_PAGINAS];
+    int estado[LOTE_PAGINAS];
+    long locais = 0;
+
+    uintptr_t p = (uintptr_t) ini & ~(uintptr_t) (tamPagina - 1);
+    while (p < (uintptr_t) fim) {
+        int m = 0;
+        for (; m < LOTE_PAGINAS && p < (uintptr_t) fim; m++, p += tamPagina) lote[m] = (void *) p;
+
+        //nodes == NULL: move_pages só informa o nó de cada página
+        if (syscall(SYS_move_pages, 0, (unsigned long) m, lote, NULL, estado, 0) != 0) return -1;
+        for (int i = 0; i < m; i++) locais += (estado[i] == no);
+        *paginas += m;
+    }
+    return locais;
+}
+
+void relatorioNos(const topologia_t *topo, const int *cpuDaThread, const real_t *A, int n, int nDiag, FILE *saida)
+{
+    long paginas[TOPO_MAX_NOS] = { 0 }, locais[TOPO_MAX_NOS] = { 0 };
+    double bytes[TOPO_MAX_NOS] = { 0 }, tempo[TOPO_MAX_NOS] = { 0 };
+    int threads[TOPO_MAX_NOS] = { 0 }, semLocalidade = 0;
+    real_t soma = 0.0;
+
+    #pragma omp parallel reduction(+:soma, semLocalidade)
+    {
+#ifdef _OPENMP
+        int t = omp_get_thread_num();
+#else
+        int t = 0;
+#endif
+        int i0, i1;
+        faixaThread(n, &i0, &i1);
+        int no = topo->no[cpuDaThread[t]];
+        if (no < 0 || no >= TOPO_MAX_NOS) no = 0;
+
+        //localidade: as linhas de cada diagonal que esta thread processa
+        long pags = 0, loc = 0;
+        for (int d = 0; d < nDiag && i1 > i0 && !semLocalidade; d++) {
+            long l = paginasLocais(&A[(size_t) d * n + i0], &A[(size_t) d * n + i1], no, &pags);
+            if (l < 0) semLocalidade = 1;
+            else loc += l;
+        }
+
+        //banda: varre as próprias linhas (somente leitura), todas as threads juntas
+        size_t bytesFaixa = (size_t) (i1 - i0) * nDiag * sizeof(real_t);
+        int reps = bytesFaixa ? (int) (BYTES_MEDICAO / bytesFaixa) + 1 : 0;
+        #pragma omp barrier
+        rtime_t t0 = timestamp();
+        for (int r = 0; r < reps; r++) {
+            for (int d = 0; d < nDiag; d++) {
+                const real_t *diag = &A[(size_t) d * n];
+                real_t s = 0.0;
+                #pragma omp simd reduction(+:s)
+                for (int i = i0; i < i1; i++) s += diag[i];
+                soma += s;
+            }
+        }
+        t0 = timestamp() - t0;
+
+        #pragma omp critical
+        {
+            threads[no]++;
+            paginas[no] += pags;
+            locais[no] += loc;
+            bytes[no] += (double) reps * bytesFaixa;
+            if (t0 > tempo[no]) tempo[no] = t0;
+        }
+    }
+
+    sumidouro = soma;
+
+    fprintf(saida, "# nó  threads  páginas locais  banda de leitura (GB/s)\n");
+    double bytesTotal = 0.0, tempoTotal = 0.0;
+    for (int no = 0; no < TOPO_MAX_NOS; no++) {
+        if (!threads[no]) continue;
+        double banda = tempo[no] > 0.0 ? bytes[no] / tempo[no] / 1e6 : 0.0; // tempo em ms
+        if (semLocalidade || !paginas[no])
+            fprintf(saida, "# %3d  %7d  %14s  %10.2f\n", no, threads[no], "indisponível", banda);
+        else
+            fprintf(saida, "# %3d  %7d  %13.1f%%  %10.2f\n", no, threads[no], 100.0 * locais[no] / paginas[no], banda);
+        bytesTotal += bytes[no];
+        if (tempo[no] > tempoTotal) tempoTotal = tempo[no];
+    }
+    if (tempoTotal > 0.0)
+        fprintf(saida, "# total              %10.2f\n", bytesTotal / tempoTotal / 1e6);
+}
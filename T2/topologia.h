@@ -0,0 +1,101 @@
+#ifndef __TOPOLOGIA_H__
+#define __TOPOLOGIA_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include "utils.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define TOPO_MAX_CPUS 1024
+#define TOPO_MAX_NOS  64
+
+/**
+ * Topologia da máquina lida do sysfs (/sys/devices/system/{cpu,node}).
+ *
+ * Os vetores indexados por CPU usam o id do kernel (o mesmo de sched_setaffinity).
+ * Sem /sys/devices/system/node, todas as CPUs ficam no nó 0.
+ */
+typedef struct {
+    int nCPUs;                  // CPUs online
+    int nNos;                   // nós NUMA com CPUs
+    int cpus[TOPO_MAX_CPUS];    // ids das CPUs online, em ordem crescente
+    int no[TOPO_MAX_CPUS];      // nó NUMA de cada CPU
+    int pacote[TOPO_MAX_CPUS];  // physical_package_id (soquete)
+    int nucleo[TOPO_MAX_CPUS];  // core_id dentro do soquete
+    int irma[TOPO_MAX_CPUS];    // posição entre as irmãs de SMT do núcleo (0 = primeira)
+} topologia_t;
+
+int leTopologia(topologia_t *topo);
+void imprimeTopologia(const topologia_t *topo, FILE *saida);
+
+// Bytes da cache de dados (ou unificada) de nível 'nivel' vista pela CPU 0; 0 se não houver
+size_t tamanhoCache(int nivel);
+
+/**
+ * Ordem das CPUs para a política de afinidade:
+ *   "compact"  enche um nó (núcleos físicos antes das irmãs de SMT) antes do próximo
+ *   "scatter"  alterna entre os nós: threads vizinhas ficam em nós diferentes
+ *   lista      ids explícitos, p.ex. "0,2,8-11"
+ * Retorna o número de CPUs em 'ordem' ou -1 (política inválida).
+ */
+int ordemAfinidade(const topologia_t *topo, const char *politica, int *ordem);
+
+/**
+ * Fixa cada thread OpenMP t em ordem[t % nOrdem] (sched_setaffinity). Com lista
+ * explícita e OMP_NUM_THREADS ausente, o número de threads é o tamanho da lista.
+ * cpuDaThread recebe a CPU de cada thread. Retorna o número de threads ou -1.
+ */
+int fixaThreads(const topologia_t *topo, const char *politica, int *cpuDaThread);
+
+//Abaixo disso o custo de abrir a região paralela supera o ganho
+#define MIN_LINHAS_PARALELO 16384
+
+/**
+ * Linhas [i0, i1) da thread corrente na divisão de schedule(static) do libgomp
+ * (as primeiras n % nthreads threads recebem uma linha a mais). Primeiro toque
+ * (arena) e loops do solver usam a mesma divisão: cada thread lê as páginas que tocou.
+ */
+static inline void faixaThread(int n, int *i0, int *i1)
+{
+#ifdef _OPENMP
+    int nt = omp_get_num_threads(), t = omp_get_thread_num();
+#else
+    int nt = 1, t = 0;
+#endif
+    int q = n / nt, resto = n % nt;
+    if (t < resto) {
+        q++;
+        resto = 0;
+    }
+    *i0 = q * t + resto;
+    *i1 = *i0 + q;
+}
+
+// Faixa [i0, i1) da thread corrente (a divisão de faixaThread) para qualquer tipo de índice
+static inline void faixaThreadLonga(int64_t n, int64_t *i0, int64_t *i1)
+{
+#ifdef _OPENMP
+    int64_t nt = omp_get_num_threads(), t = omp_get_thread_num();
+#else
+    int64_t nt = 1, t = 0;
+#endif
+    int64_t q = n / nt, resto = n % nt;
+    if (t < resto) {
+        q++;
+        resto = 0;
+    }
+    *i0 = q * t + resto;
+    *i1 = *i0 + q;
+}
+
+/**
+ * Relatório por nó NUMA das diagonais de A (nDiag diagonais de tamanho n):
+ * fração das páginas das linhas de cada thread que está no nó da thread
+ * (move_pages) e banda de leitura medida com cada thread varrendo as suas linhas.
+ */
+void relatorioNos(const topologia_t *topo, const int *cpuDaThread, const real_t *A, int n, int nDiag, FILE *saida);
+
+#endif // __TOPOLOGIA_H__
@@ -1,5 +1,6 @@
 #include "sislin.h" //funções para sistemas lineares
-#include "pcgc.h" //funções específicas do método PCG
+#include "pcgc.h" //PCG da libpcg (T2)
+#include "operador.h" //A densa vista pelo PCG
 #include "utils.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -136,7 +137,7 @@ int main() {
     }
 
     #ifdef DEBUG
-    printf("Pré-condicionador gerado em %.6es.\n", tPrecond);ac
+    printf("Pré-condicionador gerado em %.6es.\n", tPrecond);
 
     printf("M->");
     for (int i = 0; i < n; i++) 
@@ -156,11 +157,23 @@ int main() {
     //A: matriz
     //b: lado direito
     //x: solução (saída)
-    // n: dimensão,
     //maxit: max. iterações
     //epsilon: tolerância
     //M: pré-condicionador
-    iter = gradienteConjugado(ASP, bsp, x, n, maxit, epsilon, M, &normaFinal, &tempoIter);
+    //ASP densa n x n: operador denso da libpcg (GEMV que pula os blocos nulos)
+    operador_t *op = criaOperadorDensa(ASP, n);
+    if (!op) {
+        printf("Erro de alocação do operador\n");
+        free(A); free(b); free(x); free(ASP); free(bsp); free(D); free(L); free(U); free(M);
+        LIKWID_MARKER_CLOSE;
+        return 1;
+    }
+    //quebra em |p^T A p| < DBL_EPSILON, o limiar do PCG denso deste solver (o da libpcg é 1e-15)
+    controleConvergencia_t controle = CONTROLE_PADRAO;
+    controle.limiarQuebra = __DBL_EPSILON__;
+    motivoParada_t motivo;
+    iter = gradienteConjugadoControle(op, bsp, x, maxit, epsilon, M, &controle, &motivo, &normaFinal, &tempoIter);
+    liberaOperador(op);
     
     //calcula tempo total da execução do pcg
     #ifdef DEBUG
@@ -205,6 +218,8 @@ int main() {
     free(L);
     free(U);
     if (M) free(M);
+    free(ASP);
+    free(bsp);
 
     LIKWID_MARKER_CLOSE;
 
@@ -1,3 +1,4 @@
+import csv
 import os
 import re
 import matplotlib.pyplot as plt
@@ -6,6 +7,8 @@ import matplotlib.pyplot as plt
 # CONFIGURAÇÕES
 # ==============================================================================
 pastas_raiz = ['resultadosT1', 'resultadosT2']
+# CSV do 'make escala' (T2/escala.py): escalabilidade em threads, n e k
+arq_escala = os.path.join('resultadosEscala', 'escala.csv')
 
 # Configuração visual dos gráficos
 config_graficos = {
@@ -191,4 +194,65 @@ for key, pos in posicoes.items():
 plt.tight_layout()
 plt.savefig('graficos_finais_v3.png')
 print("Gráficos gerados em 'graficos_finais_v3.png'")
+
+# ==============================================================================
+# ESCALABILIDADE (threads, n e k)
+# ==============================================================================
+def ler_escala(caminho):
+    """Séries (varredura, rótulo) -> lista de linhas do CSV, ordenadas por threads."""
+    series = {}
+    with open(caminho, newline='') as f:
+        for linha in csv.DictReader(f):
+            for campo in ['threads', 'n', 'k']:
+                linha[campo] = int(linha[campo])
+            for campo in ['iteracao_ms', 'speedup', 'eficiencia', 'banda_GBs']:
+                linha[campo] = float(linha[campo]) if linha[campo] else None
+            if linha['varredura'] == 'forte':
+                rotulo = f"n={linha['n']}"
+            elif linha['varredura'] == 'fraca':
+                rotulo = f"fraca, {linha['n'] // linha['threads']}/thread"
+            else:
+                rotulo = f"k={linha['k']} ({linha['solver']}, n={linha['n']})"
+            series.setdefault((linha['varredura'], rotulo), []).append(linha)
+    for lista in series.values():
+        lista.sort(key=lambda l: l['threads'])
+    return series
+
+
+def plota_series(ax, series, varreduras, campo):
+    for (varredura, rotulo), lista in series.items():
+        pontos = [(l['threads'], l[campo]) for l in lista if l[campo] is not None]
+        if varredura in varreduras and pontos:
+            X, Y = zip(*pontos)
+            ax.plot(X, Y, marker='o', linestyle='--' if varredura == 'fraca' else '-', label=rotulo)
+
+
+if os.path.exists(arq_escala):
+    series = ler_escala(arq_escala)
+    threads = sorted({l['threads'] for lista in series.values() for l in lista})
+
+    fig_esc, eixos = plt.subplots(2, 2, figsize=(14, 10))
+    paineis = [
+        (eixos[0, 0], ['forte'], 'speedup', 'Speedup', 'Escalabilidade Forte (T2)'),
+        (eixos[0, 1], ['forte', 'fraca'], 'eficiencia', 'Eficiência Paralela', 'Eficiência (forte e fraca)'),
+        (eixos[1, 0], ['forte', 'fraca'], 'banda_GBs', 'GB/s', 'Banda Atingida (tráfego mínimo)'),
+        (eixos[1, 1], ['k'], 'iteracao_ms', 'Tempo por Iteração (ms)', 'Número de Diagonais k (T1)'),
+    ]
+    for ax, varreduras, campo, ylabel, titulo in paineis:
+        plota_series(ax, series, varreduras, campo)
+        if campo == 'speedup' and threads:
+            ax.plot(threads, threads, color='gray', linestyle=':', label='ideal')
+        if campo == 'eficiencia':
+            ax.axhline(1.0, color='gray', linestyle=':')
+        ax.set_title(titulo, fontsize=12, fontweight='bold')
+        ax.set_ylabel(ylabel)
+        ax.set_xlabel('Threads')
+        ax.set_xscale('log', base=2)
+        ax.grid(True, which="both", ls="--", alpha=0.4)
+        if ax.get_legend_handles_labels()[0]: ax.legend()
+
+    fig_esc.tight_layout()
+    fig_esc.savefig('graficos_escala.png')
+    print("Gráficos de escalabilidade gerados em 'graficos_escala.png'")
+
 plt.show()
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "utils.h"
 #include "sislin.h"
+#include "densa.h"
 
 //funções Auxiliares de geração de coeficiente aleatórios
 
@@ -80,33 +81,23 @@ void genSimetricaPositiva(real_t *A, real_t *b, int n, int k, real_t *ASP, real_
 {
  *tempo = timestamp(); //inicia medição de tempo 
 
-    // Calcula A' = A~T * A
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            real_t soma = 0.0;
-            //cálculo do elemento (i, j) de AT A: (AT)_i * A_j
-            // A coluna 'i' de AT é a linha 'i' de A. A coluna 'j' de A é A_j.
-            // O código implementa o produto escalar da coluna 'i' de A pela coluna 'j' de A:
-            // (AT A)i,j = Σ_k A[k, i] * A[k, j]
-            for (int k2 = 0; k2 < n; ++k2) {
-                soma += A[k2 * n + i] * A[k2 * n + j];
-            }
-            // Acesso direto, sem o ponteiro extra
-            ASP[i * n + j] = soma;
-        }
+    // Blocos não nulos de A: para a k-diagonal, só os perto da diagonal
+    mapaBlocos_t *mapa = criaMapaBlocos(A, n);
+    if (!mapa) {
+        printf("Erro de alocação do mapa de blocos.\n");
+        exit(1);
     }
 
+    // Calcula A' = A~T * A
+    // (AT A)i,j = Σ_k A[k, i] * A[k, j]: SYRK em blocos, só o triângulo superior
+    // (espelhado), pulando blocos nulos e lendo as linhas de A de forma contígua
+    syrkDensa(A, n, mapa, ASP);
+
     // Calcula b' = AT * b
-    for (int i = 0; i < n; ++i) {
-        real_t soma = 0.0;
-        // Cálculo do elemento 'i' de AT b: (AT)_i * b
-        // Produto escalar da coluna 'i' de A pelo vetor b: Σ_k A[k, i] * b[k]
-        for (int k2 = 0; k2 < n; ++k2) {
-            soma += A[k2 * n + i] * b[k2];
-        }
-        // Acesso direto
-        bsp[i] = soma;
-    }
+    // Σ_k A[k, i] * b[k], acumulado linha a linha de A
+    gemvTDensa(A, b, n, mapa, bsp);
+
+    liberaMapaBlocos(mapa);
 
     *tempo = timestamp() - *tempo; //finaliza medição de tempo 
 }
@@ -210,13 +201,10 @@ real_t calcResiduoSL (real_t *A, real_t *b, real_t *X,
         return -1;
     }
 
-    // Calcula r = b - A*x
+    // Calcula r = b - A*x (GEMV em faixas de linhas, uma por thread)
+    gemvDensa(A, X, n, NULL, r);
     for (int i = 0; i < n; ++i) {
-        real_t Ax_i = 0.0;
-        for (int j = 0; j < n; ++j) {
-            Ax_i += A[i * n + j] * X[j];
-        }
-        r[i] = b[i] - Ax_i;
+        r[i] = b[i] - r[i];
     }
 
     // Calcula norma euclidiana ||r||
@@ -1,28 +0,0 @@
-#include <stdio.h>
-#include <string.h>
-#include <math.h>
-
-#include "utils.h"
-
-/*  Retorna tempo em milisegundos desde EPOCH*/
-
-rtime_t timestamp (void)
-{
-  struct timespec tp;
-  clock_gettime(4, &tp);
-  return ( (rtime_t) tp.tv_sec*1.0e3 + (rtime_t) tp.tv_nsec*1.0e-6 );
-}
-
-/* gera string '<baseName>_n'*/
-string_t markerName(string_t baseName, int n)
-{
-    string_t mark = (string_t) malloc( (strlen(baseName)+1) + numDigits(n) + 1 );
-
-  sprintf(mark, "%s_%u", baseName,n);
-
-  // printf("*** %s\n", mark);
-
-  return mark;
-
-}
-